@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include "OrderBook.h"
+
+// -----------------------------------------------------------------------------
+// Datos sintéticos para los benchmarks
+// -----------------------------------------------------------------------------
+// Libro tipo BTCUSDT: precio con 2 decimales (tick 0.01), cantidad con 8.
+// Los niveles se ubican alrededor de kBenchMid, bids abajo y asks arriba.
+// Todo es determinístico (semilla fija) para poder comparar corridas.
+// -----------------------------------------------------------------------------
+
+constexpr Price kBenchMid = 10'000'000; // 100000.00
+
+inline SymbolScale benchScale() {
+    SymbolScale scale;
+    scale.priceDecimals = 2;
+    scale.qtyDecimals = 8;
+    scale.tickSize = 1;
+    return scale;
+}
+
+// depth niveles por lado, contiguos desde el mid
+inline void fillBook(OrderBook& book, int depth) {
+    for (int i = 0; i < depth; ++i) {
+        book.applyBidLevel(kBenchMid - 1 - i, 100'000'000 + i);
+        book.applyAskLevel(kBenchMid + 1 + i, 100'000'000 + i);
+    }
+}
+
+// count updates con levelsPerUpdate niveles por lado, dentro de la
+// profundidad del libro; ~1 de cada 5 niveles borra (qty = 0).
+// Las secuencias son contiguas: update i cubre [firstId + 2i, firstId + 2i + 1].
+inline std::vector<DepthUpdate> makeUpdates(size_t count, int levelsPerUpdate, int depth,
+    uint64_t firstId, uint32_t seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> offset(0, depth > 0 ? depth - 1 : 0);
+    std::uniform_int_distribution<int> qty(0, 4);
+
+    std::vector<DepthUpdate> out(count);
+    for (size_t i = 0; i < count; ++i) {
+        DepthUpdate& up = out[i];
+        up.firstUpdateId = firstId + 2 * i;
+        up.lastUpdateId = up.firstUpdateId + 1;
+        for (int l = 0; l < levelsPerUpdate; ++l) {
+            up.bids.emplace_back(kBenchMid - 1 - offset(rng), qty(rng) * 25'000'000);
+            up.asks.emplace_back(kBenchMid + 1 + offset(rng), qty(rng) * 25'000'000);
+        }
+    }
+    return out;
+}
+
+// Frame depthUpdate como lo manda Binance por el WebSocket
+inline std::string depthFrameJson(const DepthUpdate& up) {
+    auto levels = [](const std::vector<std::pair<Price, Qty>>& side) {
+        std::string s = "[";
+        for (size_t i = 0; i < side.size(); ++i) {
+            if (i > 0) s += ",";
+            s += "[\"" + std::to_string(side[i].first / 100) + "." +
+                std::to_string(100 + side[i].first % 100).substr(1) + "\",\"" +
+                std::to_string(side[i].second / 100'000'000) + "." +
+                std::to_string(100'000'000 + side[i].second % 100'000'000).substr(1) + "\"]";
+        }
+        return s + "]";
+    };
+
+    return "{\"e\":\"depthUpdate\",\"E\":1700000000000,\"s\":\"BTCUSDT\",\"U\":" +
+        std::to_string(up.firstUpdateId) + ",\"u\":" + std::to_string(up.lastUpdateId) +
+        ",\"b\":" + levels(up.bids) + ",\"a\":" + levels(up.asks) + "}";
+}
+
+inline std::string tradeFrameJson() {
+    return "{\"e\":\"trade\",\"E\":1700000000000,\"s\":\"BTCUSDT\",\"t\":3000000000,"
+        "\"p\":\"100000.01\",\"q\":\"0.01234000\",\"T\":1700000000000,\"m\":true,\"M\":true}";
+}
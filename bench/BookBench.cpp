@@ -0,0 +1,368 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <memory>
+
+#include "BenchData.h"
+#include "BookAnalytics.h"
+#include "BookSyncWorker.h"
+#include "OrderBook.h"
+#include "SnapshotSource.h"
+#include "SyntheticBook.h"
+
+// Acceso a la parte privada del worker (processBatch y estado de enganche)
+struct BookSyncWorkerBench {
+    static void processBatch(BookSyncWorker& worker, std::deque<DepthUpdate>& batch) {
+        worker.processBatch(batch);
+    }
+    static void setSynchronized(BookSyncWorker& worker, uint64_t lastAppliedUpdateId) {
+        worker._lastAppliedUpdateId = lastAppliedUpdateId;
+        worker._isSynchronized = true;
+    }
+};
+
+namespace {
+
+BookEngine engineArg(int64_t v) {
+    return v == 0 ? BookEngine::Map : BookEngine::Ladder;
+}
+
+// Snapshot "REST" en memoria: recarga el libro con depth niveles por lado
+class BenchSnapshotSource : public SnapshotSource {
+public:
+    explicit BenchSnapshotSource(int depth) : _depth(depth) {}
+
+    uint64_t nextLastUpdateId = 0;
+
+    bool loadInitialBookSnapshot(const std::string&,
+        std::shared_ptr<OrderBook> orderBook,
+        int,
+        uint64_t& outLastUpdateId) override
+    {
+        orderBook->clearAll();
+        fillBook(*orderBook, _depth);
+        outLastUpdateId = nextLastUpdateId;
+        return true;
+    }
+
+private:
+    int _depth;
+};
+
+// Renumera el batch para que arranque en firstId (continuidad estricta)
+void renumber(std::deque<DepthUpdate>& batch, uint64_t firstId) {
+    for (auto& up : batch) {
+        up.firstUpdateId = firstId;
+        up.lastUpdateId = firstId + 1;
+        firstId += 2;
+    }
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// OrderBook::applyDepthDelta
+// Args: motor (0 = map, 1 = ladder), niveles por lado, niveles por update
+// -----------------------------------------------------------------------------
+static void BM_ApplyDepthDelta(benchmark::State& state) {
+    const BookEngine engine = engineArg(state.range(0));
+    const int depth = static_cast<int>(state.range(1));
+    const int levelsPerUpdate = static_cast<int>(state.range(2));
+
+    OrderBook book("btcusdt", benchScale(), engine);
+    fillBook(book, depth);
+    const auto updates = makeUpdates(1024, levelsPerUpdate, depth, 1);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        book.applyDepthDelta(updates[i++ & 1023]);
+    }
+
+    state.SetItemsProcessed(state.iterations() * levelsPerUpdate * 2);
+    state.SetLabel(bookEngineName(engine));
+}
+BENCHMARK(BM_ApplyDepthDelta)->ArgsProduct({ { 0, 1 }, { 100, 1000, 5000 }, { 1, 10, 100 } });
+
+// -----------------------------------------------------------------------------
+// OrderBook::snapshot(topN)
+// Args: motor, topN (libro de 1000 niveles por lado)
+// -----------------------------------------------------------------------------
+static void BM_Snapshot(benchmark::State& state) {
+    const BookEngine engine = engineArg(state.range(0));
+    const int topN = static_cast<int>(state.range(1));
+
+    OrderBook book("btcusdt", benchScale(), engine);
+    fillBook(book, 1000);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.snapshot(topN));
+    }
+
+    state.SetLabel(bookEngineName(engine));
+}
+BENCHMARK(BM_Snapshot)->ArgsProduct({ { 0, 1 }, { 5, 20, 100 } });
+
+// -----------------------------------------------------------------------------
+// OrderBook::snapshotInto(topN) con el cache de top-N (setTopN) y un
+// BookSnapshot reutilizado: lo que hace el Publisher en cada fila
+// Args: motor, topN (libro de 1000 niveles por lado)
+// -----------------------------------------------------------------------------
+static void BM_SnapshotInto(benchmark::State& state) {
+    const BookEngine engine = engineArg(state.range(0));
+    const int topN = static_cast<int>(state.range(1));
+
+    OrderBook book("btcusdt", benchScale(), engine);
+    book.setTopN(topN);
+    fillBook(book, 1000);
+
+    BookSnapshot snap;
+    for (auto _ : state) {
+        book.snapshotInto(topN, snap);
+        benchmark::DoNotOptimize(snap.topBids.data());
+    }
+
+    state.SetLabel(bookEngineName(engine));
+}
+BENCHMARK(BM_SnapshotInto)->ArgsProduct({ { 0, 1 }, { 5, 20, 100 } });
+
+// -----------------------------------------------------------------------------
+// SyntheticBook::refresh después de cambiar un nivel de una leg (ETH/USDT a
+// través de ETH/BTC y BTC/USDT, 20 niveles). Incremental retoma el recorrido
+// desde el nivel cambiado; desde cero es el mismo libro ya armado con
+// invalidate(): relee las dos legs y rehace escaleras, recorrido y niveles
+// completos, como haría quien lo derive de snapshots en cada tick.
+// Args: modo (0 = incremental, 1 = desde cero), nivel de la leg que cambia
+// -----------------------------------------------------------------------------
+static void BM_SyntheticRefresh(benchmark::State& state) {
+    const bool fromScratch = state.range(0) != 0;
+    const int changedLevel = static_cast<int>(state.range(1));
+    const int levels = 20;
+
+    const CrossSpec spec = parseCrossSpec("eth/usdt:eth/btc:btc/usdt");
+    auto ethbtc = std::make_shared<OrderBook>("ethbtc", benchScale());
+    auto btcusdt = std::make_shared<OrderBook>("btcusdt", benchScale());
+    for (auto* book : { ethbtc.get(), btcusdt.get() }) {
+        book->setTopN(levels);
+        fillBook(*book, 1000);
+    }
+
+    SyntheticBook synthetic(spec, ethbtc, btcusdt, benchScale(), levels);
+    synthetic.refresh();
+
+    // El mismo nivel alterna entre dos cantidades
+    DepthUpdate update{};
+    update.bids.push_back({ kBenchMid - 1 - changedLevel, 0 });
+    int64_t i = 0;
+    for (auto _ : state) {
+        update.bids[0].second = 50'000'000 + (i++ & 1);
+        btcusdt->applyDepthDelta(update);
+
+        if (fromScratch) {
+            synthetic.invalidate();
+        }
+        benchmark::DoNotOptimize(synthetic.refresh());
+    }
+
+    state.SetLabel(fromScratch ? "desde cero" : "incremental");
+}
+BENCHMARK(BM_SyntheticRefresh)->ArgsProduct({ { 0, 1 }, { 0, 10, 19 } });
+
+// -----------------------------------------------------------------------------
+// BookAnalytics::compute sobre el snapshot de una fila: bandas de 5, 10 y
+// 25 bps, microprice, imbalance ponderado y pendientes. Lo que --analytics
+// suma a cada fila publicada (además del snapshot más profundo).
+// Args: niveles analizados por lado
+// -----------------------------------------------------------------------------
+static void BM_DepthAnalytics(benchmark::State& state) {
+    AnalyticsConfig config;
+    config.bandsBps = { 5, 10, 25 };
+    config.levels = static_cast<int>(state.range(0));
+
+    OrderBook book("btcusdt", benchScale());
+    book.setTopN(config.levels);
+    fillBook(book, 1000);
+
+    BookSnapshot snap;
+    book.snapshotInto(config.levels, snap);
+
+    BookAnalytics analytics(config);
+    DepthMetrics metrics;
+    for (auto _ : state) {
+        analytics.compute(snap.topBids, snap.topAsks, snap.scale, metrics);
+        benchmark::DoNotOptimize(metrics.bidNotional.data());
+    }
+}
+BENCHMARK(BM_DepthAnalytics)->Arg(5)->Arg(20)->Arg(100);
+
+// -----------------------------------------------------------------------------
+// Costo de comprar a mercado la mitad de la profundidad (~1 BTC por nivel)
+// con setSweepDepth(depth).
+// Args: modo, niveles por lado
+//   0 = OrderBook::sweep sobre un libro quieto
+//   1 = un delta de 10 niveles por lado (~1 de cada 5 borra, ver makeUpdates)
+//       y un sweep, alternados: el costo de tener los acumulados al día
+//   2 = copiar el lado con snapshotInto y recorrerlo (sin la API, con un
+//       cache de top-N de depth niveles para que la copia sea un memcpy)
+// -----------------------------------------------------------------------------
+static void BM_Sweep(benchmark::State& state) {
+    const int mode = static_cast<int>(state.range(0));
+    const int depth = static_cast<int>(state.range(1));
+    const Qty target = static_cast<Qty>(depth / 2) * 100'000'000;
+
+    OrderBook book("btcusdt", benchScale());
+    book.setSweepDepth(depth);
+    book.setTopN(mode == 2 ? depth : 0);
+    fillBook(book, depth);
+
+    const auto updates = makeUpdates(1024, 10, depth, 1);
+    BookSnapshot snap;
+    size_t i = 0;
+    for (auto _ : state) {
+        if (mode == 2) {
+            book.snapshotInto(depth, snap);
+            Qty left = target;
+            double notional = 0.0;
+            for (const Level& level : snap.topAsks) {
+                const Qty take = std::min(left, level.qty);
+                notional += static_cast<double>(level.price) * static_cast<double>(take);
+                left -= take;
+                if (left == 0) break;
+            }
+            benchmark::DoNotOptimize(notional);
+            continue;
+        }
+        if (mode == 1) {
+            book.applyDepthDelta(updates[i++ & 1023]);
+        }
+        benchmark::DoNotOptimize(book.sweep(SweepSide::Buy, target));
+    }
+
+    state.SetLabel(mode == 0 ? "sweep" : mode == 1 ? "delta + sweep" : "copia + recorrido");
+}
+BENCHMARK(BM_Sweep)->ArgsProduct({ { 0, 1, 2 }, { 100, 1000 } });
+
+// -----------------------------------------------------------------------------
+// Lo que setSweepDepth le agrega a cada delta (mismos updates que
+// BM_ApplyDepthDelta, 10 niveles por lado)
+// Args: profundidad de barrido (0 = sin barridos), niveles por lado
+// -----------------------------------------------------------------------------
+static void BM_SweepDepthUpdate(benchmark::State& state) {
+    const int sweepDepth = static_cast<int>(state.range(0));
+    const int depth = static_cast<int>(state.range(1));
+
+    OrderBook book("btcusdt", benchScale());
+    book.setSweepDepth(sweepDepth);
+    fillBook(book, depth);
+    const auto updates = makeUpdates(1024, 10, depth, 1);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        book.applyDepthDelta(updates[i++ & 1023]);
+    }
+    state.SetItemsProcessed(state.iterations() * 20);
+}
+BENCHMARK(BM_SweepDepthUpdate)->Args({ 0, 1000 })->Args({ 1000, 1000 })->Args({ 0, 5000 })->Args({ 5000, 5000 });
+
+// -----------------------------------------------------------------------------
+// OrderBook::sweepBatch con 64 tamaños (de 1 a 64 veces depth/64 niveles)
+// Args: niveles por lado
+// -----------------------------------------------------------------------------
+static void BM_SweepBatch(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+
+    OrderBook book("btcusdt", benchScale());
+    book.setSweepDepth(depth);
+    fillBook(book, depth);
+
+    std::vector<Qty> sizes;
+    for (int k = 1; k <= 64; ++k) {
+        sizes.push_back(static_cast<Qty>(k) * depth / 64 * 100'000'000);
+    }
+    std::vector<SweepResult> results(sizes.size());
+    for (auto _ : state) {
+        book.sweepBatch(SweepSide::Sell, sizes.data(), sizes.size(), results.data());
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sizes.size()));
+}
+BENCHMARK(BM_SweepBatch)->Arg(100)->Arg(1000);
+
+// -----------------------------------------------------------------------------
+// BookSyncWorker::processBatch, camino sincronizado (fase B)
+// Args: motor, updates por batch (10 niveles por lado cada uno)
+// -----------------------------------------------------------------------------
+static void BM_ProcessBatchContiguous(benchmark::State& state) {
+    const BookEngine engine = engineArg(state.range(0));
+    const size_t batchSize = static_cast<size_t>(state.range(1));
+
+    BenchSnapshotSource source(1000);
+    auto book = std::make_shared<OrderBook>("btcusdt", benchScale(), engine);
+    fillBook(*book, 1000);
+    BookSyncWorker worker("btcusdt", book, &source);
+
+    const auto updates = makeUpdates(batchSize, 10, 1000, 1);
+    uint64_t nextId = 1;
+    BookSyncWorkerBench::setSynchronized(worker, nextId - 1);
+
+    std::deque<DepthUpdate> batch;
+    for (auto _ : state) {
+        state.PauseTiming();
+        batch.assign(updates.begin(), updates.end());
+        renumber(batch, nextId);
+        nextId += 2 * batchSize;
+        state.ResumeTiming();
+
+        BookSyncWorkerBench::processBatch(worker, batch);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batchSize));
+    state.SetLabel(bookEngineName(engine));
+}
+BENCHMARK(BM_ProcessBatchContiguous)->ArgsProduct({ { 0, 1 }, { 1, 16, 256 } });
+
+// -----------------------------------------------------------------------------
+// BookSyncWorker::processBatch, gap -> resync -> reenganche
+// Cada iteración: el batch llega con un salto de secuencia, el worker pide
+// snapshot (libro de depth niveles), y en la segunda pasada descarta lo viejo,
+// engancha con el bloque puente y aplica el resto.
+// Args: motor, niveles por lado del snapshot
+// -----------------------------------------------------------------------------
+static void BM_ProcessBatchGapResync(benchmark::State& state) {
+    const BookEngine engine = engineArg(state.range(0));
+    const int depth = static_cast<int>(state.range(1));
+    const size_t batchSize = 32;
+
+    BenchSnapshotSource source(depth);
+    auto book = std::make_shared<OrderBook>("btcusdt", benchScale(), engine);
+    fillBook(*book, depth);
+    BookSyncWorker worker("btcusdt", book, &source);
+
+    const auto updates = makeUpdates(batchSize, 10, depth, 1);
+    uint64_t lastApplied = 1;
+    BookSyncWorkerBench::setSynchronized(worker, lastApplied);
+
+    // Los logs de GAP van a stderr en cada iteración: se silencian para no medir I/O
+    std::cerr.setstate(std::ios::failbit);
+
+    std::deque<DepthUpdate> batch;
+    for (auto _ : state) {
+        state.PauseTiming();
+        batch.assign(updates.begin(), updates.end());
+        const uint64_t firstId = lastApplied + 100; // gap
+        renumber(batch, firstId);
+        // El snapshot cae a mitad del batch: la mitad anterior se descarta
+        source.nextLastUpdateId = firstId + batchSize;
+        lastApplied = batch.back().lastUpdateId;
+        state.ResumeTiming();
+
+        BookSyncWorkerBench::processBatch(worker, batch); // gap -> resnapshot
+        BookSyncWorkerBench::processBatch(worker, batch); // fase A -> sincronizado
+    }
+
+    std::cerr.clear();
+
+    state.SetLabel(bookEngineName(engine));
+}
+BENCHMARK(BM_ProcessBatchGapResync)->ArgsProduct({ { 0, 1 }, { 100, 1000 } });
@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "BenchData.h"
+#include "MarketDataParser.h"
+#include "TradeStats.h"
+#include "Publisher.h"
+#include "Utils.h"
+
+// -----------------------------------------------------------------------------
+// parseDepthUpdate (parser dedicado)
+// Args: niveles por lado del frame
+// -----------------------------------------------------------------------------
+static void BM_ParseDepthUpdate(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    const std::string frame = depthFrameJson(makeUpdates(1, levels, 1000, 1).front());
+    const SymbolScale scale = benchScale();
+
+    DepthUpdate out;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parseDepthUpdate(frame.data(), frame.size(), scale, out));
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_ParseDepthUpdate)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+// -----------------------------------------------------------------------------
+// parseTrade
+// -----------------------------------------------------------------------------
+static void BM_ParseTrade(benchmark::State& state) {
+    const std::string frame = tradeFrameJson();
+    const SymbolScale scale = benchScale();
+
+    TradeEvent out;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parseTrade(frame.data(), frame.size(), scale, out));
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_ParseTrade);
+
+// -----------------------------------------------------------------------------
+// parseCombinedEnvelope (ruteo del multiplexor)
+// Args: niveles por lado del depth frame envuelto
+// -----------------------------------------------------------------------------
+static void BM_ParseCombinedEnvelope(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    const std::string frame = "{\"stream\":\"btcusdt@depth@100ms\",\"data\":" +
+        depthFrameJson(makeUpdates(1, levels, 1000, 1).front()) + "}";
+
+    CombinedEnvelope out;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parseCombinedEnvelope(frame.data(), frame.size(), out));
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_ParseCombinedEnvelope)->Arg(10)->Arg(100);
+
+// -----------------------------------------------------------------------------
+// TradeStats::onTrade / snapshot con la ventana cargada
+// Args: trades ya presentes en la ventana
+// -----------------------------------------------------------------------------
+
+// Carga count trades repartidos en los últimos 250 s (todos dentro de la
+// ventana de 5 minutos). Devuelve "ahora" en ms de exchange time.
+static uint64_t fillWindow(TradeStats& stats, int64_t count) {
+    const uint64_t nowMs = static_cast<uint64_t>(nowUnixSeconds() * 1000.0);
+    const uint64_t firstMs = nowMs - 250'000;
+    for (int64_t i = 0; i < count; ++i) {
+        const uint64_t ts = firstMs + static_cast<uint64_t>(i) * 250'000 / static_cast<uint64_t>(count);
+        stats.onTrade(kBenchMid + (i % 100), 1'000'000, "buy", ts);
+    }
+    return nowMs;
+}
+
+static void BM_TradeStatsOnTrade(benchmark::State& state) {
+    TradeStats stats(benchScale());
+    const uint64_t nowMs = fillWindow(stats, state.range(0));
+
+    const std::string side = "sell";
+    int64_t i = 0;
+    for (auto _ : state) {
+        stats.onTrade(kBenchMid + (i++ % 100), 1'000'000, side, nowMs);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TradeStatsOnTrade)->Arg(1'000)->Arg(100'000)->Arg(1'000'000);
+
+static void BM_TradeStatsSnapshot(benchmark::State& state) {
+    TradeStats stats(benchScale());
+    const uint64_t nowMs = fillWindow(stats, state.range(0));
+
+    const double now = static_cast<double>(nowMs) / 1000.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(stats.snapshot(now));
+    }
+}
+BENCHMARK(BM_TradeStatsSnapshot)->Arg(1'000)->Arg(100'000)->Arg(1'000'000);
+
+// -----------------------------------------------------------------------------
+// Publisher::publishOnce: snapshot + formateo de una línea CSV por símbolo
+// Args: topN (libro de 1000 niveles, salida descartada)
+// -----------------------------------------------------------------------------
+static void BM_PublisherLine(benchmark::State& state) {
+    const int topN = static_cast<int>(state.range(0));
+
+    auto book = std::make_shared<OrderBook>("btcusdt", benchScale());
+    fillBook(*book, 1000);
+    auto stats = std::make_shared<TradeStats>(benchScale());
+    stats->onTrade(kBenchMid, 1'234'000, "buy");
+
+#ifdef _WIN32
+    const std::string sink = "NUL";
+#else
+    const std::string sink = "/dev/null";
+#endif
+
+    Publisher publisher({ { "btcusdt", book } }, { { "btcusdt", stats } }, topN, sink);
+    publisher.start(/*periodic*/ false);
+
+    double ts = 1'700'000'000.0;
+    for (auto _ : state) {
+        publisher.publishOnce(ts);
+        ts += 1.0;
+    }
+
+    publisher.stop();
+}
+BENCHMARK(BM_PublisherLine)->Arg(5)->Arg(20);
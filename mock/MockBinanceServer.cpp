@@ -0,0 +1,360 @@
+// -----------------------------------------------------------------------------
+// MockBinanceServer
+// -----------------------------------------------------------------------------
+// Reemplazo local de Binance Spot para pruebas end-to-end sin red:
+//   - REST:      GET /api/v3/depth?symbol=BTCUSDT&limit=N
+//   - WebSocket: /ws/<symbol>@depth[@100ms], /ws/<symbol>@trade
+//                /stream?streams=a/b/c  (combined, {"stream":..,"data":..})
+//
+// Uso:
+//   MockBinanceServer --symbols=btcusdt,ethusdt --rate=100 --gap-every=500
+//   BinanceOrderBook --symbols=btcusdt,ethusdt
+//       --ws-url=ws://127.0.0.1:19443 --rest-url=http://127.0.0.1:18080
+//
+// Parámetros (todos opcionales):
+//   --host=127.0.0.1  --ws-port=19443  --rest-port=18080
+//   --symbols=btcusdt          símbolos a simular
+//   --rate=10                  depthUpdates por segundo y símbolo
+//   --trade-rate=20            trades por segundo y símbolo
+//   --levels=1000              niveles por lado del libro
+//   --update-levels=10         niveles por lado en cada depthUpdate
+//   --gap-every=0              1 de cada N updates no se envía (0 = nunca)
+//   --drop-every=0             cada N segundos corta todas las conexiones WS
+//   --snapshot-delay-ms=0      demora de cada respuesta REST
+//   --seed=1                   semilla (misma semilla = misma secuencia)
+//
+// El campo "E" (event time, ms epoch) es el momento de envío, para medir
+// latencia wire-to-publish del lado del cliente.
+// -----------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <ixwebsocket/IXHttpServer.h>
+#include <ixwebsocket/IXWebSocketServer.h>
+
+#include "MockMarket.h"
+#include "Utils.h"
+
+namespace {
+
+std::atomic<bool> g_running(true);
+
+void signalHandler(int) {
+    g_running = false;
+}
+
+struct MockArgs {
+    std::string host = "127.0.0.1";
+    int wsPort = 19443;
+    int restPort = 18080;
+    std::vector<std::string> symbols{ "btcusdt" };
+    double rate = 10.0;
+    double tradeRate = 20.0;
+    int dropEverySec = 0;
+    int snapshotDelayMs = 0;
+    uint32_t seed = 1;
+    MockMarketConfig market;
+};
+
+MockArgs parseMockArgs(int argc, char** argv) {
+    MockArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+
+        if (std::strncmp(a, "--host=", 7) == 0) args.host = a + 7;
+        else if (std::strncmp(a, "--ws-port=", 10) == 0) args.wsPort = std::stoi(a + 10);
+        else if (std::strncmp(a, "--rest-port=", 12) == 0) args.restPort = std::stoi(a + 12);
+        else if (std::strncmp(a, "--symbols=", 10) == 0) args.symbols = splitCsv(a + 10);
+        else if (std::strncmp(a, "--rate=", 7) == 0) args.rate = std::stod(a + 7);
+        else if (std::strncmp(a, "--trade-rate=", 13) == 0) args.tradeRate = std::stod(a + 13);
+        else if (std::strncmp(a, "--levels=", 9) == 0) args.market.levels = std::stoi(a + 9);
+        else if (std::strncmp(a, "--update-levels=", 16) == 0) args.market.updateLevels = std::stoi(a + 16);
+        else if (std::strncmp(a, "--gap-every=", 12) == 0) args.market.gapEvery = std::stoi(a + 12);
+        else if (std::strncmp(a, "--drop-every=", 13) == 0) args.dropEverySec = std::stoi(a + 13);
+        else if (std::strncmp(a, "--snapshot-delay-ms=", 20) == 0) args.snapshotDelayMs = std::stoi(a + 20);
+        else if (std::strncmp(a, "--seed=", 7) == 0) args.seed = static_cast<uint32_t>(std::stoul(a + 7));
+        else throw std::runtime_error(std::string("Argumento desconocido: ") + a);
+    }
+
+    if (args.symbols.empty()) throw std::runtime_error("--symbols no puede ser vacio");
+    if (args.rate < 0.0 || args.tradeRate < 0.0) throw std::runtime_error("--rate / --trade-rate deben ser >= 0");
+    if (args.market.levels <= 0) throw std::runtime_error("--levels debe ser > 0");
+    if (args.market.updateLevels < 0) throw std::runtime_error("--update-levels debe ser >= 0");
+
+    for (auto& s : args.symbols) {
+        for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return args;
+}
+
+uint64_t nowMs() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+// Valor de un parámetro de query ("symbol=BTCUSDT&limit=5" -> "BTCUSDT")
+std::string queryParam(const std::string& query, const std::string& key) {
+    size_t pos = 0;
+    while (pos < query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        size_t eq = query.find('=', pos);
+        if (eq != std::string::npos && eq < end && query.compare(pos, eq - pos, key) == 0) {
+            return query.substr(eq + 1, end - eq - 1);
+        }
+        pos = end + 1;
+    }
+    return {};
+}
+
+// Qué streams pidió cada conexión (según la URI del handshake)
+struct Subscription {
+    bool combined = false; // /stream?streams=... -> envolver
+    // símbolo -> nombre del stream tal cual lo pidió (va en el campo "stream")
+    std::unordered_map<std::string, std::string> depthBySymbol;
+    std::unordered_map<std::string, std::string> tradeBySymbol;
+};
+
+Subscription parseSubscription(const std::string& uri) {
+    Subscription sub;
+    std::vector<std::string> streams;
+
+    if (uri.rfind("/ws/", 0) == 0) {
+        streams.push_back(uri.substr(4));
+    }
+    else if (uri.rfind("/stream", 0) == 0) {
+        sub.combined = true;
+        size_t q = uri.find('?');
+        std::string list = q == std::string::npos ? std::string() : queryParam(uri.substr(q + 1), "streams");
+        size_t pos = 0;
+        while (pos <= list.size()) {
+            size_t end = list.find('/', pos);
+            if (end == std::string::npos) end = list.size();
+            if (end > pos) streams.push_back(list.substr(pos, end - pos));
+            pos = end + 1;
+        }
+    }
+
+    for (auto& name : streams) {
+        size_t at = name.find('@');
+        if (at == std::string::npos) continue;
+        std::string symbol = name.substr(0, at);
+        std::string kind = name.substr(at + 1);
+        if (kind.rfind("depth", 0) == 0) sub.depthBySymbol[symbol] = name;
+        else if (kind == "trade") sub.tradeBySymbol[symbol] = name;
+    }
+    return sub;
+}
+
+class MockServer {
+public:
+    explicit MockServer(const MockArgs& args)
+        : _args(args)
+        , _wsServer(args.wsPort, args.host)
+        , _httpServer(args.restPort, args.host)
+    {
+        uint32_t seed = args.seed;
+        for (auto& symbol : args.symbols) {
+            _markets[symbol] = std::make_unique<MockMarket>(symbol, args.market, seed++);
+        }
+    }
+
+    void start() {
+        _wsServer.setOnClientMessageCallback(
+            [this](std::shared_ptr<ix::ConnectionState>, ix::WebSocket& ws, const ix::WebSocketMessagePtr& msg) {
+                onClientMessage(ws, msg);
+            });
+
+        _httpServer.setOnConnectionCallback(
+            [this](ix::HttpRequestPtr request, std::shared_ptr<ix::ConnectionState>) {
+                return onHttpRequest(request);
+            });
+
+        auto wsListen = _wsServer.listen();
+        if (!wsListen.first) throw std::runtime_error("WS listen: " + wsListen.second);
+        auto httpListen = _httpServer.listen();
+        if (!httpListen.first) throw std::runtime_error("HTTP listen: " + httpListen.second);
+
+        _wsServer.start();
+        _httpServer.start();
+
+        std::cerr << "[MockServer] WS   ws://" << _args.host << ":" << _args.wsPort << "\n"
+            << "[MockServer] REST http://" << _args.host << ":" << _args.restPort << "\n";
+    }
+
+    // Genera y envía los eventos hasta que g_running pase a false
+    void run() {
+        using Clock = std::chrono::steady_clock;
+
+        const auto depthEvery = _args.rate > 0.0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _args.rate))
+            : Clock::duration::max();
+        const auto tradeEvery = _args.tradeRate > 0.0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _args.tradeRate))
+            : Clock::duration::max();
+
+        auto start = Clock::now();
+        auto nextDepth = start;
+        auto nextTrade = start;
+        auto nextDrop = start + std::chrono::seconds(_args.dropEverySec);
+
+        std::string payload;
+        while (g_running) {
+            auto now = Clock::now();
+
+            while (_args.rate > 0.0 && now >= nextDepth) {
+                for (auto& kv : _markets) {
+                    if (kv.second->nextDepthUpdate(nowMs(), payload)) {
+                        broadcast(kv.first, /*depth*/ true, payload);
+                    }
+                }
+                nextDepth += depthEvery;
+            }
+
+            while (_args.tradeRate > 0.0 && now >= nextTrade) {
+                for (auto& kv : _markets) {
+                    kv.second->nextTrade(nowMs(), payload);
+                    broadcast(kv.first, /*depth*/ false, payload);
+                }
+                nextTrade += tradeEvery;
+            }
+
+            // Reconexiones: cortamos a todos; ixwebsocket reconecta solo
+            if (_args.dropEverySec > 0 && now >= nextDrop) {
+                auto clients = _wsServer.getClients();
+                std::cerr << "[MockServer] Cortando " << clients.size() << " conexiones\n";
+                for (auto& ws : clients) {
+                    ws->close();
+                }
+                nextDrop += std::chrono::seconds(_args.dropEverySec);
+            }
+
+            auto wakeAt = std::min(nextDepth, nextTrade);
+            if (_args.dropEverySec > 0) wakeAt = std::min(wakeAt, nextDrop);
+            std::this_thread::sleep_until(std::min(wakeAt, Clock::now() + std::chrono::milliseconds(100)));
+        }
+    }
+
+    void stop() {
+        _wsServer.stop();
+        _httpServer.stop();
+    }
+
+private:
+    void onClientMessage(ix::WebSocket& ws, const ix::WebSocketMessagePtr& msg) {
+        if (msg->type == ix::WebSocketMessageType::Open) {
+            std::lock_guard<std::mutex> lock(_subsMtx);
+            _subs[&ws] = parseSubscription(msg->openInfo.uri);
+            std::cerr << "[MockServer] Conexion " << msg->openInfo.uri << "\n";
+        }
+        else if (msg->type == ix::WebSocketMessageType::Close) {
+            std::lock_guard<std::mutex> lock(_subsMtx);
+            _subs.erase(&ws);
+        }
+    }
+
+    void broadcast(const std::string& symbol, bool depth, const std::string& payload) {
+        auto clients = _wsServer.getClients();
+
+        std::lock_guard<std::mutex> lock(_subsMtx);
+        for (auto& ws : clients) {
+            auto subIt = _subs.find(ws.get());
+            if (subIt == _subs.end()) continue;
+
+            const Subscription& sub = subIt->second;
+            const auto& bySymbol = depth ? sub.depthBySymbol : sub.tradeBySymbol;
+            auto streamIt = bySymbol.find(symbol);
+            if (streamIt == bySymbol.end()) continue;
+
+            if (sub.combined) {
+                ws->sendText("{\"stream\":\"" + streamIt->second + "\",\"data\":" + payload + "}");
+            }
+            else {
+                ws->sendText(payload);
+            }
+        }
+    }
+
+    ix::HttpResponsePtr onHttpRequest(const ix::HttpRequestPtr& request) {
+        ix::WebSocketHttpHeaders headers;
+        headers["Content-Type"] = "application/json";
+
+        const std::string& uri = request->uri;
+        size_t q = uri.find('?');
+        std::string path = uri.substr(0, q);
+        std::string query = q == std::string::npos ? std::string() : uri.substr(q + 1);
+
+        if (path != "/api/v3/depth") {
+            return std::make_shared<ix::HttpResponse>(404, "Not Found",
+                ix::HttpErrorCode::Ok, headers, "{\"code\":-1,\"msg\":\"Not found\"}");
+        }
+
+        std::string symbol = queryParam(query, "symbol");
+        for (auto& c : symbol) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        auto it = _markets.find(symbol);
+        if (it == _markets.end()) {
+            return std::make_shared<ix::HttpResponse>(400, "Bad Request",
+                ix::HttpErrorCode::Ok, headers, "{\"code\":-1121,\"msg\":\"Invalid symbol.\"}");
+        }
+
+        std::string limitStr = queryParam(query, "limit");
+        int limit = limitStr.empty() ? 100 : std::atoi(limitStr.c_str());
+        if (limit <= 0 || limit > 5000) limit = 5000;
+
+        // Snapshot lento: el cliente sigue recibiendo updates mientras espera
+        if (_args.snapshotDelayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(_args.snapshotDelayMs));
+        }
+
+        return std::make_shared<ix::HttpResponse>(200, "OK",
+            ix::HttpErrorCode::Ok, headers, it->second->snapshotJson(limit));
+    }
+
+    MockArgs _args;
+    ix::WebSocketServer _wsServer;
+    ix::HttpServer _httpServer;
+
+    // Fijo después del constructor: se lee sin lock desde varios hilos
+    std::unordered_map<std::string, std::unique_ptr<MockMarket>> _markets;
+
+    std::mutex _subsMtx;
+    std::unordered_map<const ix::WebSocket*, Subscription> _subs;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        MockArgs args = parseMockArgs(argc, argv);
+
+        MockServer server(args);
+        server.start();
+
+        std::signal(SIGINT, signalHandler);
+        std::signal(SIGTERM, signalHandler);
+
+        server.run();
+        server.stop();
+
+        std::cerr << "[MockServer] Apagado limpio.\n";
+        return 0;
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "FATAL: " << ex.what() << "\n";
+        return 1;
+    }
+}
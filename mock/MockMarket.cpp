@@ -0,0 +1,138 @@
+#include "MockMarket.h"
+
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kInitialMid = 10'000'000; // 100000.00
+constexpr int64_t kLotsPerUnit = 100'000'000;
+
+} // namespace
+
+MockMarket::MockMarket(std::string symbolLower, const MockMarketConfig& config, uint32_t seed)
+    : _symbolLower(std::move(symbolLower))
+    , _config(config)
+    , _rng(seed)
+    , _mid(kInitialMid)
+{
+    for (char c : _symbolLower) {
+        _symbolUpper.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    }
+
+    for (int i = 1; i <= _config.levels; ++i) {
+        _bids[_mid - i] = static_cast<int64_t>(1 + _rng() % 100) * 1'000'000;
+        _asks[_mid + i] = static_cast<int64_t>(1 + _rng() % 100) * 1'000'000;
+    }
+}
+
+bool MockMarket::nextDepthUpdate(uint64_t eventTimeMs, std::string& out) {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    std::vector<std::pair<int64_t, int64_t>> bidChanges;
+    std::vector<std::pair<int64_t, int64_t>> askChanges;
+
+    // Random walk del mid; lo que queda cruzado se borra (qty 0)
+    if (_rng() % 4 == 0) {
+        _mid += (_rng() & 1) ? 1 : -1;
+    }
+    while (!_bids.empty() && _bids.begin()->first >= _mid) {
+        bidChanges.emplace_back(_bids.begin()->first, 0);
+        _bids.erase(_bids.begin());
+    }
+    while (!_asks.empty() && _asks.begin()->first <= _mid) {
+        askChanges.emplace_back(_asks.begin()->first, 0);
+        _asks.erase(_asks.begin());
+    }
+
+    // Cambios aleatorios dentro de la profundidad; ~1 de cada 5 borra el nivel
+    const int levels = _config.levels > 0 ? _config.levels : 1;
+    for (int i = 0; i < _config.updateLevels; ++i) {
+        const int64_t bidPx = _mid - 1 - static_cast<int64_t>(_rng() % levels);
+        const int64_t bidQty = (_rng() % 5 == 0) ? 0 : static_cast<int64_t>(1 + _rng() % 100) * 1'000'000;
+        if (bidQty == 0) _bids.erase(bidPx); else _bids[bidPx] = bidQty;
+        bidChanges.emplace_back(bidPx, bidQty);
+
+        const int64_t askPx = _mid + 1 + static_cast<int64_t>(_rng() % levels);
+        const int64_t askQty = (_rng() % 5 == 0) ? 0 : static_cast<int64_t>(1 + _rng() % 100) * 1'000'000;
+        if (askQty == 0) _asks.erase(askPx); else _asks[askPx] = askQty;
+        askChanges.emplace_back(askPx, askQty);
+    }
+
+    // Cada update cubre 1 a 3 ids, como en Binance
+    const uint64_t firstId = _lastUpdateId + 1;
+    _lastUpdateId += 1 + _rng() % 3;
+
+    ++_updates;
+    if (_config.gapEvery > 0 && _updates % static_cast<uint64_t>(_config.gapEvery) == 0) {
+        return false; // gap inyectado
+    }
+
+    char head[160];
+    std::snprintf(head, sizeof(head),
+        "{\"e\":\"depthUpdate\",\"E\":%" PRIu64 ",\"s\":\"%s\",\"U\":%" PRIu64 ",\"u\":%" PRIu64 ",\"b\":[",
+        eventTimeMs, _symbolUpper.c_str(), firstId, _lastUpdateId);
+
+    out.assign(head);
+    for (size_t i = 0; i < bidChanges.size(); ++i) {
+        if (i > 0) out += ',';
+        appendLevel(out, bidChanges[i].first, bidChanges[i].second);
+    }
+    out += "],\"a\":[";
+    for (size_t i = 0; i < askChanges.size(); ++i) {
+        if (i > 0) out += ',';
+        appendLevel(out, askChanges[i].first, askChanges[i].second);
+    }
+    out += "]}";
+    return true;
+}
+
+void MockMarket::nextTrade(uint64_t eventTimeMs, std::string& out) {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    // m = true: el comprador es maker -> agresor vendedor, pega contra el bid
+    const bool isBuyerMaker = (_rng() & 1) != 0;
+    int64_t px = isBuyerMaker ? _mid - 1 : _mid + 1;
+    if (isBuyerMaker && !_bids.empty()) px = _bids.begin()->first;
+    if (!isBuyerMaker && !_asks.empty()) px = _asks.begin()->first;
+    const int64_t qty = static_cast<int64_t>(1 + _rng() % 1000) * 10'000;
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"e\":\"trade\",\"E\":%" PRIu64 ",\"s\":\"%s\",\"t\":%" PRIu64
+        ",\"p\":\"%" PRId64 ".%02" PRId64 "\",\"q\":\"%" PRId64 ".%08" PRId64 "\""
+        ",\"T\":%" PRIu64 ",\"m\":%s,\"M\":true}",
+        eventTimeMs, _symbolUpper.c_str(), ++_tradeId,
+        px / 100, px % 100, qty / kLotsPerUnit, qty % kLotsPerUnit,
+        eventTimeMs, isBuyerMaker ? "true" : "false");
+    out.assign(buf);
+}
+
+std::string MockMarket::snapshotJson(int limit) const {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    std::string out = "{\"lastUpdateId\":" + std::to_string(_lastUpdateId) + ",\"bids\":[";
+    int n = 0;
+    for (auto it = _bids.begin(); it != _bids.end() && n < limit; ++it, ++n) {
+        if (n > 0) out += ',';
+        appendLevel(out, it->first, it->second);
+    }
+    out += "],\"asks\":[";
+    n = 0;
+    for (auto it = _asks.begin(); it != _asks.end() && n < limit; ++it, ++n) {
+        if (n > 0) out += ',';
+        appendLevel(out, it->first, it->second);
+    }
+    out += "]}";
+    return out;
+}
+
+void MockMarket::appendLevel(std::string& out, int64_t priceTicks, int64_t qtyLots) const {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "[\"%" PRId64 ".%02" PRId64 "\",\"%" PRId64 ".%08" PRId64 "\"]",
+        priceTicks / 100, priceTicks % 100, qtyLots / kLotsPerUnit, qtyLots % kLotsPerUnit);
+    out += buf;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// MockMarket
+// -----------------------------------------------------------------------------
+// Libro sintético de un símbolo para el MockBinanceServer. Genera los mismos
+// payloads que Binance Spot:
+//   - depthUpdate: {"e":"depthUpdate","E":..,"s":"BTCUSDT","U":..,"u":..,"b":[..],"a":[..]}
+//   - trade:       {"e":"trade","E":..,"s":"BTCUSDT","t":..,"p":"..","q":"..","T":..,"m":..,"M":true}
+//   - snapshot:    {"lastUpdateId":..,"bids":[..],"asks":[..]}  (GET /api/v3/depth)
+//
+// Precio con 2 decimales (tick 0.01) y cantidades con 8, alrededor de un mid
+// que hace un random walk. Todo sale de un generador con semilla fija, así que
+// la misma configuración produce la misma secuencia.
+//
+// Gaps: con gapEvery = N, uno de cada N updates se aplica al libro pero no se
+// envía; el cliente ve el salto de secuencia y tiene que resincronizar.
+//
+// Thread-safe: el hilo generador y el servidor HTTP (snapshots) lo comparten.
+// -----------------------------------------------------------------------------
+struct MockMarketConfig {
+    int levels = 1000;       // niveles por lado del libro
+    int updateLevels = 10;   // niveles por lado en cada depthUpdate
+    int gapEvery = 0;        // 0 = sin gaps
+};
+
+class MockMarket {
+public:
+    MockMarket(std::string symbolLower, const MockMarketConfig& config, uint32_t seed);
+
+    const std::string& symbol() const { return _symbolLower; }
+
+    // Próximo depthUpdate. Retorna false si el update se "pierde" (gap
+    // inyectado): el libro avanza igual pero no hay nada que enviar.
+    bool nextDepthUpdate(uint64_t eventTimeMs, std::string& out);
+
+    // Próximo trade, cerca del mejor precio del lado agresor
+    void nextTrade(uint64_t eventTimeMs, std::string& out);
+
+    // Snapshot REST con hasta limit niveles por lado
+    std::string snapshotJson(int limit) const;
+
+private:
+    void appendLevel(std::string& out, int64_t priceTicks, int64_t qtyLots) const;
+
+    std::string _symbolLower;
+    std::string _symbolUpper;
+    MockMarketConfig _config;
+
+    mutable std::mutex _mtx;
+    std::mt19937_64 _rng;
+
+    int64_t _mid;                                       // en ticks de 0.01
+    std::map<int64_t, int64_t, std::greater<int64_t>> _bids; // ticks -> lotes
+    std::map<int64_t, int64_t> _asks;
+
+    uint64_t _lastUpdateId = 1'000'000;
+    uint64_t _updates = 0;
+    uint64_t _tradeId = 0;
+};
@@ -3,9 +3,30 @@
 #include <stdexcept>
 #include <cstring>
 #include <cctype>
+#include <algorithm>
+
+// "500ms", "10s", "5m", "1h" (sin sufijo = segundos) -> milisegundos
+static int64_t parseDurationMs(const std::string& text) {
+    size_t pos = 0;
+    const long long value = std::stoll(text, &pos);
+    const std::string unit = text.substr(pos);
+
+    int64_t factor = 0;
+    if (unit == "ms") factor = 1;
+    else if (unit == "s" || unit.empty()) factor = 1'000;
+    else if (unit == "m") factor = 60'000;
+    else if (unit == "h") factor = 3'600'000;
+    else throw std::runtime_error("Duracion invalida: " + text + " (usar ms, s, m o h)");
+
+    if (value <= 0) {
+        throw std::runtime_error("Duracion debe ser > 0: " + text);
+    }
+    return static_cast<int64_t>(value) * factor;
+}
 
 ProgramArgs parseArgs(int argc, char** argv) {
     ProgramArgs args;
+    bool heartbeatSet = false;
 
     for (int i = 1; i < argc; ++i) {
         const char* a = argv[i];
@@ -17,20 +38,265 @@ ProgramArgs parseArgs(int argc, char** argv) {
         else if (std::strncmp(a, "--topN=", 7) == 0) {
             args.topN = std::stoi(a + 7);
         }
+        else if (std::strncmp(a, "--depth=", 8) == 0) {
+            args.depth = std::stoi(a + 8);
+        }
         else if (std::strncmp(a, "--log=", 6) == 0) {
             args.logPath = a + 6;
         }
+        else if (std::strncmp(a, "--format=", 9) == 0) {
+            args.outputFormat = parseOutputFormat(a + 9);
+        }
+        else if (std::strncmp(a, "--log-overflow=", 15) == 0) {
+            args.logWriter.overflow = parseLogOverflow(a + 15);
+        }
+        else if (std::strncmp(a, "--log-fsync=", 12) == 0) {
+            // none | batch | intervalo (ej: 500ms, 1s)
+            const std::string policy = a + 12;
+            if (policy == "none") {
+                args.logWriter.fsync = LogFsync::None;
+            }
+            else if (policy == "batch") {
+                args.logWriter.fsync = LogFsync::Batch;
+            }
+            else {
+                args.logWriter.fsync = LogFsync::Interval;
+                args.logWriter.fsyncIntervalMs = parseDurationMs(policy);
+            }
+        }
+        else if (std::strncmp(a, "--log-buffer-mb=", 16) == 0) {
+            args.logWriter.bufferBytes = static_cast<size_t>(std::stoull(a + 16)) << 20;
+        }
+        else if (std::strncmp(a, "--log-rotate-mb=", 16) == 0) {
+            args.logWriter.rotateBytes = static_cast<uint64_t>(std::stoull(a + 16)) << 20;
+        }
+        else if (std::strncmp(a, "--log-rotate-every=", 19) == 0) {
+            args.logWriter.rotateMs = parseDurationMs(a + 19);
+        }
+        else if (std::strncmp(a, "--publish=", 10) == 0) {
+            args.publish.mode = parsePublishMode(a + 10);
+        }
+        else if (std::strncmp(a, "--publish-interval=", 19) == 0) {
+            args.publish.minIntervalMs = parseDurationMs(a + 19);
+        }
+        else if (std::strncmp(a, "--heartbeat=", 12) == 0) {
+            // "0" = sin heartbeat (solo tiene sentido con --publish=changes)
+            const std::string period = a + 12;
+            args.publish.heartbeatMs = period == "0" ? 0 : parseDurationMs(period);
+            heartbeatSet = true;
+        }
+        else if (std::strcmp(a, "--latency") == 0) {
+            args.latency = true;
+        }
+        else if (std::strncmp(a, "--latency=", 10) == 0) {
+            // intervalo de volcado; "0" = solo con SIGUSR1 y al salir
+            const std::string period = a + 10;
+            args.latency = true;
+            args.latencyReportMs = period == "0" ? 0 : parseDurationMs(period);
+        }
+        else if (std::strcmp(a, "--analytics") == 0) {
+            args.analytics.bandsBps = { 5, 10, 25 };
+        }
+        else if (std::strncmp(a, "--analytics=", 12) == 0) {
+            // bandas en bps alrededor del mid ("5,10,25" o "5bps,10bps")
+            args.analytics.bandsBps.clear();
+            for (const auto& band : splitCsv(a + 12)) {
+                size_t pos = 0;
+                const int bps = std::stoi(band, &pos);
+                const std::string unit = band.substr(pos);
+                if (!unit.empty() && unit != "bps" && unit != "bp") {
+                    throw std::runtime_error("Banda invalida en --analytics: " + band + " (usar bps)");
+                }
+                args.analytics.bandsBps.push_back(bps);
+            }
+            if (args.analytics.bandsBps.empty() || args.analytics.bandsBps.size() > kMaxAnalyticsBands) {
+                throw std::runtime_error("--analytics requiere entre 1 y 8 bandas");
+            }
+        }
+        else if (std::strncmp(a, "--analytics-levels=", 19) == 0) {
+            args.analytics.levels = std::stoi(a + 19);
+        }
+        else if (std::strncmp(a, "--sweep-depth=", 14) == 0) {
+            args.sweepDepth = std::stoi(a + 14);
+        }
+        else if (std::strncmp(a, "--scales=", 9) == 0) {
+            args.scalesPath = a + 9;
+        }
+        else if (std::strncmp(a, "--book=", 7) == 0) {
+            args.bookEngine = parseBookEngine(a + 7);
+        }
+        else if (std::strncmp(a, "--idle=", 7) == 0) {
+            args.idleStrategy = parseIdleStrategy(a + 7);
+        }
+        else if (std::strncmp(a, "--shards=", 9) == 0) {
+            args.syncPool.shards = static_cast<size_t>(std::stoul(a + 9));
+        }
+        else if (std::strcmp(a, "--shard-pin") == 0) {
+            args.syncPool.pin = true;
+        }
+        else if (std::strncmp(a, "--rebalance-every=", 18) == 0) {
+            // "0" = sin rebalanceo
+            const std::string period = a + 18;
+            args.syncPool.rebalanceMs = period == "0" ? 0 : parseDurationMs(period);
+        }
+        else if (std::strncmp(a, "--startup-parallel=", 19) == 0) {
+            args.startupParallel = static_cast<size_t>(std::stoul(a + 19));
+        }
+        else if (std::strncmp(a, "--mux=", 6) == 0) {
+            args.streamsPerSocket = std::stoi(a + 6);
+        }
+        else if (std::strncmp(a, "--record=", 9) == 0) {
+            args.recordPath = a + 9;
+        }
+        else if (std::strncmp(a, "--replay=", 9) == 0) {
+            args.replayPath = a + 9;
+        }
+        else if (std::strncmp(a, "--replay-speed=", 15) == 0) {
+            args.replaySpeed = std::stod(a + 15);
+        }
+        else if (std::strncmp(a, "--ws-url=", 9) == 0) {
+            args.wsBaseUrl = a + 9;
+        }
+        else if (std::strncmp(a, "--rest-url=", 11) == 0) {
+            args.restBaseUrl = a + 11;
+        }
+        else if (std::strncmp(a, "--shm=", 6) == 0) {
+            args.shmName = a + 6;
+            if (!args.shmName.empty() && args.shmName.front() != '/') {
+                args.shmName.insert(args.shmName.begin(), '/'); // shm_open pide "/nombre"
+            }
+        }
+        else if (std::strncmp(a, "--checkpoint=", 13) == 0) {
+            args.checkpointDir = a + 13;
+            while (args.checkpointDir.size() > 1 && args.checkpointDir.back() == '/') args.checkpointDir.pop_back();
+        }
+        else if (std::strncmp(a, "--checkpoint-every=", 19) == 0) {
+            args.checkpointIntervalMs = parseDurationMs(a + 19);
+        }
+        else if (std::strncmp(a, "--cross=", 8) == 0) {
+            for (const auto& spec : splitCsv(a + 8)) {
+                args.crossBooks.push_back(parseCrossSpec(spec));
+            }
+        }
+        else if (std::strncmp(a, "--horizons=", 11) == 0) {
+            args.tradeWindows.horizonsMs.clear();
+            for (const auto& h : splitCsv(a + 11)) {
+                args.tradeWindows.horizonsMs.push_back(parseDurationMs(h));
+            }
+        }
+        else if (std::strcmp(a, "--horizon-stats") == 0) {
+            args.horizonStats = true;
+        }
+        else if (std::strncmp(a, "--bucket-ms=", 12) == 0) {
+            args.tradeWindows.bucketMs = std::stoll(a + 12);
+        }
+        else if (std::strncmp(a, "--vwap-window=", 14) == 0) {
+            args.tradeWindows.vwapWindowMs = parseDurationMs(a + 14);
+        }
         else {
             throw std::runtime_error(std::string("Argumento desconocido: ") + a);
         }
     }
 
+    // Las URLs se concatenan con "/ws/...", "/api/..."
+    while (!args.wsBaseUrl.empty() && args.wsBaseUrl.back() == '/') args.wsBaseUrl.pop_back();
+    while (!args.restBaseUrl.empty() && args.restBaseUrl.back() == '/') args.restBaseUrl.pop_back();
+    if (args.wsBaseUrl.empty() || args.restBaseUrl.empty()) {
+        throw std::runtime_error("--ws-url / --rest-url no pueden ser vacias");
+    }
+
     if (args.symbols.empty()) {
         throw std::runtime_error("Falta --symbols=btcusdt,ethusdt,...");
     }
     if (args.topN <= 0) {
         throw std::runtime_error("--topN debe ser > 0");
     }
+    const bool analytics = !args.analytics.bandsBps.empty();
+    if (args.analytics.levels < 1 || args.analytics.levels > 5000) {
+        throw std::runtime_error("--analytics-levels debe estar entre 1 y 5000");
+    }
+    for (const int bps : args.analytics.bandsBps) {
+        if (bps <= 0 || bps >= 10'000) {
+            throw std::runtime_error("Las bandas de --analytics deben estar entre 1 y 9999 bps");
+        }
+    }
+    if (args.sweepDepth < 0 || args.sweepDepth > 5000) {
+        throw std::runtime_error("--sweep-depth debe estar entre 0 y 5000");
+    }
+    if (args.depth == 0) {
+        args.depth = std::max({ 10, args.topN, args.sweepDepth });
+        if (analytics) args.depth = std::max(args.depth, args.analytics.levels);
+    }
+    // Binance no devuelve más de 5000 niveles por lado
+    if (args.depth < 1 || args.depth > 5000) {
+        throw std::runtime_error("--depth debe estar entre 1 y 5000");
+    }
+    if (analytics && args.analytics.levels > args.depth) {
+        throw std::runtime_error("--analytics-levels no puede superar --depth");
+    }
+    if (args.sweepDepth > args.depth) {
+        throw std::runtime_error("--sweep-depth no puede superar --depth");
+    }
+    if (args.syncPool.shards > 1024) {
+        throw std::runtime_error("--shards debe estar entre 0 (auto) y 1024");
+    }
+    args.syncPool.idle = args.idleStrategy;
+    if (args.startupParallel < 1 || args.startupParallel > 256) {
+        throw std::runtime_error("--startup-parallel debe estar entre 1 y 256");
+    }
+    if (args.streamsPerSocket < 0 || args.streamsPerSocket > 1024) {
+        throw std::runtime_error("--mux debe estar entre 0 y 1024");
+    }
+    if (!args.recordPath.empty() && !args.replayPath.empty()) {
+        throw std::runtime_error("--record y --replay no se pueden combinar");
+    }
+    if (!args.checkpointDir.empty() && !args.replayPath.empty()) {
+        throw std::runtime_error("--checkpoint y --replay no se pueden combinar");
+    }
+    if (args.replaySpeed < 0.0) {
+        throw std::runtime_error("--replay-speed debe ser >= 0");
+    }
+    if (args.outputFormat == OutputFormat::Binary && args.logPath.empty()) {
+        throw std::runtime_error("--format=binary requiere --log=archivo");
+    }
+    if (args.logWriter.bufferBytes < 2 * args.logWriter.slotBytes) {
+        throw std::runtime_error("--log-buffer-mb debe ser >= 1");
+    }
+    if ((args.logWriter.rotateBytes > 0 || args.logWriter.rotateMs > 0) && args.logPath.empty()) {
+        throw std::runtime_error("--log-rotate-mb / --log-rotate-every requieren --log=archivo");
+    }
+
+    // Con --publish=changes los símbolos quietos no se repiten salvo que se
+    // pida un heartbeat explícito
+    if (args.publish.mode == PublishMode::Changes && !heartbeatSet) {
+        args.publish.heartbeatMs = 0;
+    }
+    if (args.publish.mode == PublishMode::Heartbeat && args.publish.heartbeatMs <= 0) {
+        throw std::runtime_error("--publish=heartbeat requiere --heartbeat > 0");
+    }
+
+
+    // Ventanas de trades: horizontes múltiplos del bucket; el de vwapWindow
+    // siempre está entre los calculados
+    TradeWindowConfig& windows = args.tradeWindows;
+    if (windows.bucketMs <= 0 || 1'000 % windows.bucketMs != 0) {
+        throw std::runtime_error("--bucket-ms debe dividir a 1000 (ej: 100, 250, 1000)");
+    }
+    if (windows.horizonsMs.empty()) {
+        throw std::runtime_error("--horizons no puede ser vacio");
+    }
+    if (std::find(windows.horizonsMs.begin(), windows.horizonsMs.end(), windows.vwapWindowMs) == windows.horizonsMs.end()) {
+        windows.horizonsMs.push_back(windows.vwapWindowMs);
+    }
+    for (const int64_t h : windows.horizonsMs) {
+        if (h % windows.bucketMs != 0) {
+            throw std::runtime_error("Cada horizonte debe ser multiplo de --bucket-ms");
+        }
+        // la rueda reserva un bucket por slot del horizonte más largo
+        if (h / windows.bucketMs > 1'000'000) {
+            throw std::runtime_error("Horizonte demasiado largo para --bucket-ms (max 1e6 buckets)");
+        }
+    }
 
     return args;
 }
\ No newline at end of file
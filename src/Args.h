@@ -2,10 +2,46 @@
 #include <string>
 #include <vector>
 
+#include "BookSide.h"
+#include "IdleStrategy.h"
+#include "BinanceEndpoints.h"
+#include "TradeWindow.h"
+#include "SnapshotRecord.h"
+#include "LogWriter.h"
+#include "Publisher.h"
+#include "BookSyncPool.h"
+#include "SyntheticBook.h"
+#include "BookAnalytics.h"
+
 struct ProgramArgs {
     std::vector<std::string> symbols;
     int topN = 5;
+    int depth = 0; // --depth=N: niveles por lado de cada snapshot REST y tope del libro (0 = max(10, topN))
     std::string logPath;
+    OutputFormat outputFormat = OutputFormat::Csv; // --format=csv|binary (binary requiere --log)
+    LogWriterConfig logWriter; // --log-overflow, --log-fsync, --log-buffer-mb, --log-rotate-mb, --log-rotate-every
+    PublishConfig publish; // --publish=heartbeat|changes --publish-interval=10ms --heartbeat=1s
+    std::string scalesPath; // JSON con tickSize/stepSize por símbolo (vacío = 8 decimales)
+    BookEngine bookEngine = BookEngine::Map; // --book=map|ladder
+    IdleStrategy idleStrategy = IdleStrategy::Block; // --idle=busy|yield|block
+    BookSyncPoolConfig syncPool; // --shards=N --shard-pin --rebalance-every=10s
+    size_t startupParallel = 8; // --startup-parallel=N: símbolos que arrancan a la vez (y sesiones REST keep-alive)
+    int streamsPerSocket = 0; // --mux=N: combined streams, N por conexión (0 = una conexión por stream)
+    std::string recordPath; // --record=path: journal binario con los frames crudos (vacío = no grabar)
+    std::string replayPath; // --replay=path: reproduce un journal en lugar de conectarse a Binance
+    double replaySpeed = 0.0; // --replay-speed=X: 0 = lo más rápido posible, 1 = ritmo grabado
+    std::string wsBaseUrl = kBinanceWsBaseUrl; // --ws-url=ws://127.0.0.1:19443 (ej: MockBinanceServer)
+    std::string restBaseUrl = kBinanceRestBaseUrl; // --rest-url=http://127.0.0.1:18080
+    std::string shmName; // --shm=/binance_ob: publica los libros en memoria compartida (vacío = no)
+    std::string checkpointDir; // --checkpoint=dir: checkpoints de los libros para reiniciar sin snapshot (vacío = no)
+    int64_t checkpointIntervalMs = 10'000; // --checkpoint-every=10s
+    bool latency = false; // --latency[=<intervalo>]: histogramas de latencia por etapa y símbolo
+    int64_t latencyReportMs = 10'000; // cada cuánto se vuelcan a stderr (0 = solo con SIGUSR1 y al salir)
+    AnalyticsConfig analytics; // --analytics[=5,10,25] --analytics-levels=20: métricas de profundidad por fila
+    int sweepDepth = 0; // --sweep-depth=N: niveles por lado para OrderBook::sweep (0 = sin barridos)
+    std::vector<CrossSpec> crossBooks; // --cross=eth/usdt:eth/btc:btc/usdt[,...]: libros implícitos a publicar
+    TradeWindowConfig tradeWindows; // --horizons=1s,10s,1m,5m,1h --bucket-ms=1000 --vwap-window=5m
+    bool horizonStats = false; // --horizon-stats: métricas de trades por horizonte en cada fila
 };
 
 
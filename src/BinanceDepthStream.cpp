@@ -1,12 +1,77 @@
 #include "BinanceDepthStream.h"
+#include "MarketDataParser.h"
+#include "LatencyStats.h"
 
 #include <iostream>
 #include <cctype>
 #include <nlohmann/json.hpp>
 
-BinanceDepthStream::BinanceDepthStream(const std::string& symbolLower)
+namespace {
+
+// Fallback genrico con nlohmann::json para frames que el parser dedicado no
+// reconoce. Retorna false si el mensaje no es un depth update (sin U/u).
+bool parseDepthUpdateJson(const char* data, size_t len, const SymbolScale& scale, DepthUpdate& out) {
+    using nlohmann::json;
+
+    json jsonMsg = json::parse(data, data + len);
+
+    // Binance depth updates incluyen U (firstUpdateId), u (lastUpdateId)
+    if (!jsonMsg.contains("U") || !jsonMsg.contains("u"))
+        return false;
+
+    out.firstUpdateId = jsonMsg["U"].get<uint64_t>();
+    out.lastUpdateId = jsonMsg["u"].get<uint64_t>();
+    out.eventTimeMs = jsonMsg.contains("E") ? jsonMsg["E"].get<uint64_t>() : 0;
+    out.bids.clear(); // conserva la capacidad del slot
+    out.asks.clear();
+
+    // Procesar bids (compras)
+    if (jsonMsg.contains("b")) {
+        for (auto& level : jsonMsg["b"]) {
+            if (level.size() < 2) continue;
+
+            Price price = parseFixed(level[0].get<std::string>(), scale.priceDecimals);
+            Qty quantity = parseFixed(level[1].get<std::string>(), scale.qtyDecimals);
+            out.bids.emplace_back(price, quantity);
+        }
+    }
+
+    // Procesar asks (ventas)
+    if (jsonMsg.contains("a")) {
+        for (auto& level : jsonMsg["a"]) {
+            if (level.size() < 2) continue;
+
+            Price price = parseFixed(level[0].get<std::string>(), scale.priceDecimals);
+            Qty quantity = parseFixed(level[1].get<std::string>(), scale.qtyDecimals);
+            out.asks.emplace_back(price, quantity);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+BinanceDepthStream::BinanceDepthStream(const std::string& symbolLower,
+    SymbolScale scale,
+    IdleStrategy idle,
+    size_t queueCapacity,
+    const std::string& wsBaseUrl)
     : _symbolLower(symbolLower)
+    , _wsBaseUrl(wsBaseUrl)
+    , _scale(scale)
+    , _queue(queueCapacity)
+    , _recycled(kRecycledBuffers)
+    , _waiter(idle)
 {
+    // Buffers iniciales: los primeros frames ya no reservan memoria
+    for (size_t i = 0; i + 1 < _recycled.capacity(); ++i) {
+        LevelBuffers* buffers = _recycled.beginPush();
+        buffers->bids.reserve(kPreallocLevels);
+        buffers->asks.reserve(kPreallocLevels);
+        _recycled.commitPush();
+    }
+
     // Precalculamos el smbolo en maysculas para logging u otras llamadas REST.
     _symbolUpper.reserve(_symbolLower.size());
     for (char c : _symbolLower) {
@@ -20,9 +85,14 @@ void BinanceDepthStream::start() {
         return;
     }
 
+    // Con multiplexor los frames llegan por su conexin compartida (ver attach)
+    if (_mux) {
+        return;
+    }
+
     // Construimos la URL del stream de profundidad (actualizaciones cada 500ms)
     // Ejemplo: wss://stream.binance.com:9443/ws/btcusdt@depth@500ms
-    std::string wsUrl = "wss://stream.binance.com:9443/ws/" +
+    std::string wsUrl = _wsBaseUrl + "/ws/" +
         _symbolLower +
         "@depth@100ms";
 
@@ -44,8 +114,6 @@ void BinanceDepthStream::start() {
     _ws.setOnMessageCallback(
         [this](const ix::WebSocketMessagePtr& msg)
         {
-            using nlohmann::json;
-
             switch (msg->type) {
             case ix::WebSocketMessageType::Open:
                 std::cerr << "[DepthStream] Conectado a " << _symbolLower << "\n";
@@ -67,68 +135,131 @@ void BinanceDepthStream::start() {
                 return;
             }
 
-            try {
-                json jsonMsg = json::parse(msg->str);
-
-                // Binance depth updates incluyen U (firstUpdateId), u (lastUpdateId)
-                if (!jsonMsg.contains("U") || !jsonMsg.contains("u"))
-                    return;
-
-                DepthUpdate depthUpdate;
-                depthUpdate.firstUpdateId = jsonMsg["U"].get<uint64_t>();
-                depthUpdate.lastUpdateId = jsonMsg["u"].get<uint64_t>();
-
-                // Procesar bids (compras)
-                if (jsonMsg.contains("b")) {
-                    for (auto& level : jsonMsg["b"]) {
-                        if (level.size() < 2) continue;
-
-                        double price = std::stod(level[0].get<std::string>());
-                        double quantity = std::stod(level[1].get<std::string>());
-                        depthUpdate.bids.emplace_back(price, quantity);
-                    }
-                }
-
-                // Procesar asks (ventas)
-                if (jsonMsg.contains("a")) {
-                    for (auto& level : jsonMsg["a"]) {
-                        if (level.size() < 2) continue;
-
-                        double price = std::stod(level[0].get<std::string>());
-                        double quantity = std::stod(level[1].get<std::string>());
-                        depthUpdate.asks.emplace_back(price, quantity);
-                    }
-                }
-
-                // Encolar update para que el worker lo procese
-                {
-                    std::lock_guard<std::mutex> lock(_mtxQueue);
-                    _queue.push_back(std::move(depthUpdate));
-                }
-            }
-            catch (const std::exception& ex) {
-                std::cerr << "[DepthStream] Error al parsear update de "
-                    << _symbolLower << ": " << ex.what() << "\n";
-            }
+            onFrame(msg->str.data(), msg->str.size());
         }
     );
 
     _ws.start();
 }
 
+void BinanceDepthStream::attach(BinanceStreamMux& mux) {
+    _mux = &mux;
+    mux.subscribe(_symbolLower + "@depth@100ms",
+        [this](const char* data, size_t len) { onFrame(data, len); });
+}
+
+void BinanceDepthStream::recordTo(JournalWriter* journal) {
+    _journal = journal;
+    if (_journal) {
+        _journalStreamId = _journal->streamId(_symbolLower + "@depth");
+    }
+}
+
+void BinanceDepthStream::onFrame(const char* data, size_t len, bool live) {
+    const int64_t recvNs = _latency ? latencyNowNs() : 0;
+
+    // Se graba el frame tal cual lleg, aunque despus se descarte
+    if (_journal) {
+        _journal->append(JournalRecordType::DepthFrame, _journalStreamId, data, len);
+    }
+
+    try {
+        // Escribimos directo sobre un slot libre de la cola (sin copias)
+        DepthUpdate* slot = _queue.beginPush();
+        if (!slot) {
+            uint64_t dropped = ++_dropped;
+            if (dropped == 1 || dropped % 1000 == 0) {
+                std::cerr << "[DepthStream] Cola llena para " << _symbolLower
+                    << ", updates descartados: " << dropped << "\n";
+            }
+            return;
+        }
+
+        // Buffers devueltos por el consumidor: el slot se queda con los
+        // calientes y les deja los suyos
+        if (LevelBuffers* warm = _recycled.front()) {
+            slot->bids.swap(warm->bids);
+            slot->asks.swap(warm->asks);
+            _recycled.pop();
+        }
+
+        // Camino rpido: parser dedicado de depthUpdate (sin DOM ni strings).
+        // Si el frame tiene otra forma, caemos al parseo con nlohmann.
+        if (!parseDepthUpdate(data, len, _scale, *slot) &&
+            !parseDepthUpdateJson(data, len, _scale, *slot))
+        {
+            return; // no es un depth update (ej: respuesta de suscripcin)
+        }
+
+        int64_t parsedNs = 0;
+        if (_latency) {
+            stampUpdate(*slot, recvNs, live);
+            parsedNs = slot->parsedNs;
+        }
+
+        // Publicar el slot y avisar al worker
+        _queue.commitPush();
+        notifyConsumer();
+
+        // El slot ya es del worker: solo se usan copias locales
+        if (_latency) {
+            _latency->record(LatencyStage::ParsedToEnqueued, latencyNowNs() - parsedNs);
+            _latency->record(LatencyStage::QueueDepth, static_cast<int64_t>(_queue.size()));
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "[DepthStream] Error al parsear update de "
+            << _symbolLower << ": " << ex.what() << "\n";
+    }
+}
+
+void BinanceDepthStream::popUpdate() {
+    DepthUpdate* update = _queue.front();
+    if (!update) {
+        return;
+    }
+
+    // Devolver los buffers al productor si tienen capacidad (los vacos, por
+    // ej. movidos al backlog, no sirven) y hay lugar en la cola de retorno
+    if (update->bids.capacity() + update->asks.capacity() > 0) {
+        if (LevelBuffers* spare = _recycled.beginPush()) {
+            spare->bids.swap(update->bids);
+            spare->asks.swap(update->asks);
+            _recycled.commitPush();
+        }
+    }
+    _queue.pop();
+}
+
+void BinanceDepthStream::stampUpdate(DepthUpdate& update, int64_t recvNs, bool live) {
+    update.recvNs = recvNs;
+    update.parsedNs = latencyNowNs();
+    // Despus de commitPush el slot ya no es nuestro: la marca de encolado
+    // que ve el worker es la ltima que podemos escribir
+    update.enqueuedNs = update.parsedNs;
+
+    _latency->record(LatencyStage::RecvToParsed, update.parsedNs - recvNs);
+    // En replay E es del pasado: comparar con el reloj actual no mide nada
+    if (live && update.eventTimeMs > 0) {
+        _latency->record(LatencyStage::ExchangeToRecv,
+            wallNowMs() - static_cast<int64_t>(update.eventTimeMs));
+    }
+}
+
 void BinanceDepthStream::stop() {
     if (!_running.exchange(false)) {
         // Ya estaba detenido
         return;
     }
 
-    _ws.stop();
+    if (!_mux) {
+        _ws.stop();
+    }
     std::cerr << "[DepthStream] Detenido " << _symbolLower << "\n";
 }
 
-std::deque<DepthUpdate> BinanceDepthStream::drainUpdates() {
-    std::lock_guard<std::mutex> lock(_mtxQueue);
-    std::deque<DepthUpdate> drained;
-    drained.swap(_queue);
-    return drained;
+void BinanceDepthStream::waitForUpdates(const std::atomic<bool>& running,
+    std::chrono::milliseconds timeout)
+{
+    _waiter.idle([&] { return !running || !_queue.empty(); }, timeout);
 }
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
 #include <string>
-#include <deque>
-#include <mutex>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <cstdint>
 
 #include <ixwebsocket/IXWebSocket.h>
 #include "OrderBook.h"  // Incluye definicin de DepthUpdate
+#include "SpscRing.h"
+#include "IdleStrategy.h"
+#include "BinanceStreamMux.h"
+#include "Journal.h"
+#include "BinanceEndpoints.h"
+
+struct SymbolLatency;
 
 // -----------------------------------------------------------------------------
 // BinanceDepthStream
@@ -16,16 +23,25 @@
 //
 // - Escucha mensajes tipo <symbol>@depth@500ms.
 // - Cada mensaje contiene los cambios en los niveles de precios ("bids" y "asks").
-// - Los mensajes se transforman en estructuras DepthUpdate y se encolan de forma
-//   segura para ser consumidas por el BookSyncWorker.
+// - Los mensajes se parsean directamente sobre un slot de una cola SPSC
+//   preasignada (SpscRing) para ser consumidos por el BookSyncWorker.
+// - Los vectores de niveles circulan: al liberar un slot, el consumidor
+//   devuelve sus buffers (ya crecidos) por una segunda cola SPSC en sentido
+//   contrario y el productor los toma para el prximo frame. As los pocos
+//   updates en vuelo reutilizan siempre los mismos buffers calientes en vez
+//   de ir calentando uno por uno los miles de slots de la cola: en rgimen
+//   el camino de depth no reserva memoria.
 //
 // Ejemplo:
 //   BinanceDepthStream stream("btcusdt");
 //   stream.start();
-//   auto updates = stream.drainUpdates();  // devuelve las actualizaciones acumuladas
+//   while (DepthUpdate* up = stream.frontUpdate()) { aplicar(*up); stream.popUpdate(); }
 //
 // Thread-safety:
-//   - La cola interna est protegida por un std::mutex.
+//   - Un nico productor (hilo de ixwebsocket) y un nico consumidor
+//     (hilo del BookSyncWorker); la cola no usa locks.
+//   - Si la cola se llena, el update se descarta y se cuenta: el worker ver
+//     el salto de secuencia y resincronizar.
 //   - La bandera _running se maneja con std::atomic.
 // -----------------------------------------------------------------------------
 class BinanceDepthStream {
@@ -34,18 +50,63 @@ public:
     // Constructor
     // -------------------------------------------------------------------------
     // symbolLower debe ser el smbolo en minsculas, ej: "btcusdt".
-    explicit BinanceDepthStream(const std::string& symbolLower);
+    // scale define cmo se convierten precios/cantidades a punto fijo.
+    // idle es la estrategia de espera del consumidor (ver waitForUpdates).
+    // queueCapacity es la cantidad de slots de la cola (potencia de 2).
+    // wsBaseUrl permite apuntar a otro servidor (ej: mock local).
+    static constexpr size_t kDefaultQueueCapacity = 4096;
+
+    // Buffers de niveles en la cola de retorno y capacidad inicial de cada
+    // uno (niveles por lado): cubren el frame tpico de @depth@100ms
+    static constexpr size_t kRecycledBuffers = 64;
+    static constexpr size_t kPreallocLevels = 64;
+
+    explicit BinanceDepthStream(const std::string& symbolLower,
+        SymbolScale scale = {},
+        IdleStrategy idle = IdleStrategy::Block,
+        size_t queueCapacity = kDefaultQueueCapacity,
+        const std::string& wsBaseUrl = kBinanceWsBaseUrl);
 
     // -------------------------------------------------------------------------
     // start
     // -------------------------------------------------------------------------
     // Inicia la conexin WebSocket con Binance:
-    //   wss://stream.binance.com:9443/ws/<symbol>@depth@500ms
+    //   <wsBaseUrl>/ws/<symbol>@depth@100ms
     //
     // Si ya est ejecutndose (_running == true), no hace nada.
     // -------------------------------------------------------------------------
     void start();
 
+    // -------------------------------------------------------------------------
+    // attach
+    // -------------------------------------------------------------------------
+    // Modo multiplexado: en lugar de abrir su propio WebSocket, se suscribe a
+    // <symbol>@depth@100ms en el BinanceStreamMux compartido. Debe llamarse
+    // antes de mux.start(); despus start() no abre ninguna conexin.
+    // -------------------------------------------------------------------------
+    void attach(BinanceStreamMux& mux);
+
+    // -------------------------------------------------------------------------
+    // recordTo / injectFrame
+    // -------------------------------------------------------------------------
+    // recordTo: graba cada frame crudo recibido en el journal (antes de
+    // parsearlo). Llamar antes de start().
+    // injectFrame: entrega un frame como si hubiera llegado por el WebSocket;
+    // lo usa el replay de journals (el hilo que inyecta pasa a ser el productor).
+    // -------------------------------------------------------------------------
+    void recordTo(JournalWriter* journal);
+    void injectFrame(const char* data, size_t len) { onFrame(data, len, /*live*/ false); }
+
+    // -------------------------------------------------------------------------
+    // measureTo
+    // -------------------------------------------------------------------------
+    // Marca cada update con los tiempos de recepcin, parseo y encolado y
+    // registra esas etapas (y la profundidad de la cola) en los histogramas
+    // del smbolo. nullptr = sin medir (ni una lectura de reloj). Llamar
+    // antes de start().
+    // -------------------------------------------------------------------------
+    void measureTo(SymbolLatency* latency) { _latency = latency; }
+
     // -------------------------------------------------------------------------
     // stop
     // -------------------------------------------------------------------------
@@ -55,30 +116,96 @@ public:
     void stop();
 
     // -------------------------------------------------------------------------
-    // drainUpdates
+    // frontUpdate / popUpdate (solo desde el hilo consumidor)
     // -------------------------------------------------------------------------
-    // Devuelve todas las actualizaciones acumuladas (DepthUpdate) y vaca la cola.
-    //
-    // Se utiliza desde BookSyncWorker para procesar los mensajes recibidos.
+    // frontUpdate devuelve el prximo update pendiente sin copiarlo, o nullptr
+    // si no hay. popUpdate lo libera para que el productor reutilice el slot
+    // y le devuelve sus buffers de niveles (cola de retorno).
+    // -------------------------------------------------------------------------
+    DepthUpdate* frontUpdate() { return _queue.front(); }
+    void popUpdate();
+
+    // -------------------------------------------------------------------------
+    // waitForUpdates
+    // -------------------------------------------------------------------------
+    // Espera (segn la IdleStrategy) hasta que haya updates, running pase a
+    // false o venza timeout. Reemplaza al sleep fijo del worker.
     // -------------------------------------------------------------------------
-    std::deque<DepthUpdate> drainUpdates();
+    void waitForUpdates(const std::atomic<bool>& running, std::chrono::milliseconds timeout);
+
+    // Despierta al consumidor si est dormido en waitForUpdates (para stop()).
+    void wakeConsumer() { _waiter.wakeAll(); }
+
+    // Hay updates en la cola (desde cualquier hilo, valor aproximado)
+    bool hasUpdates() const { return !_queue.empty(); }
+
+    // Consumidor compartido (shard de BookSyncPool): en lugar del waiter
+    // propio, cada update avisa a este. nullptr = volver al propio. Se puede
+    // cambiar con el stream andando (rebalanceo entre shards).
+    void notifyTo(IdleWaiter* waiter) { _notifyTarget.store(waiter, std::memory_order_release); }
+
+    // Avisa al consumidor actual (propio o shard) sin encolar nada; ej: lleg
+    // el snapshot de un resync asncrono.
+    void notifyConsumer() {
+        IdleWaiter* target = _notifyTarget.load(std::memory_order_acquire);
+        (target ? target : &_waiter)->notify();
+    }
+
+    // Updates descartados por cola llena desde el arranque
+    uint64_t droppedUpdates() const { return _dropped.load(std::memory_order_relaxed); }
 
 private:
+    // Parsea un frame de depth (payload crudo) y lo publica en la cola.
+    // Se llama desde el hilo de la conexin (propia o del multiplexor).
+    // live = false: frame de un journal (no se mide contra el campo E).
+    void onFrame(const char* data, size_t len, bool live = true);
+
+    // Marcas de latencia del update recin parseado (solo con _latency)
+    void stampUpdate(DepthUpdate& update, int64_t recvNs, bool live);
+
     // Smbolo en minsculas (ej: "btcusdt")
     std::string _symbolLower;
 
     // Versin en maysculas (ej: "BTCUSDT"), til para logs o REST
     std::string _symbolUpper;
 
-    // Conexin WebSocket activa hacia Binance
+    // URL base del WebSocket (sin "/" final)
+    std::string _wsBaseUrl;
+
+    // Escala de precio/cantidad usada al parsear los niveles
+    SymbolScale _scale;
+
+    // Conexin WebSocket activa hacia Binance (sin uso si _mux != nullptr)
     ix::WebSocket _ws;
 
+    // Multiplexor compartido (modo combined streams), o nullptr
+    BinanceStreamMux* _mux = nullptr;
+
+    // Journal de captura (nullptr = no se graba) y id del stream en l
+    JournalWriter* _journal = nullptr;
+    uint16_t _journalStreamId = 0;
+
     // Estado de ejecucin del stream
     std::atomic<bool> _running{ false };
 
-    // Mutex que protege el acceso concurrente a la cola de updates
-    std::mutex _mtxQueue;
+    // Cola SPSC de actualizaciones pendientes de procesar (slots preasignados)
+    SpscRing<DepthUpdate> _queue;
+
+    // Cola de retorno (consumidor -> productor) con buffers de niveles que ya
+    // tienen capacidad. Se intercambian con los del slot, nunca se copian.
+    struct LevelBuffers {
+        std::vector<std::pair<Price, Qty>> bids;
+        std::vector<std::pair<Price, Qty>> asks;
+    };
+    SpscRing<LevelBuffers> _recycled;
+
+    // Espera/aviso entre el hilo de ixwebsocket y el worker
+    IdleWaiter _waiter;
+    std::atomic<IdleWaiter*> _notifyTarget{ nullptr }; // nullptr = _waiter
+
+    // Updates descartados porque la cola estaba llena
+    std::atomic<uint64_t> _dropped{ 0 };
 
-    // Cola de actualizaciones pendientes de procesar
-    std::deque<DepthUpdate> _queue;
+    // Histogramas del smbolo (nullptr = sin medir)
+    SymbolLatency* _latency = nullptr;
 };
\ No newline at end of file
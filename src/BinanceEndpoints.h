@@ -0,0 +1,12 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// URLs base de Binance Spot
+// -----------------------------------------------------------------------------
+// Se pueden reemplazar con --ws-url / --rest-url (ej: el MockBinanceServer
+// local: ws://127.0.0.1:19443 y http://127.0.0.1:18080). Sin "/" final.
+//   WebSocket: <ws>/ws/<stream>  y  <ws>/stream?streams=a/b/c
+//   REST:      <rest>/api/v3/depth?symbol=BTCUSDT&limit=N
+// -----------------------------------------------------------------------------
+inline constexpr const char* kBinanceWsBaseUrl = "wss://stream.binance.com:9443";
+inline constexpr const char* kBinanceRestBaseUrl = "https://api.binance.com";
@@ -1,11 +1,61 @@
 ﻿#include "BinanceRestClient.h"
 #include "OrderBook.h"
+#include "Journal.h"
+#include "MarketDataParser.h"
 
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 #include <iostream>
+#include <utility>
+#include <algorithm>
 
-BinanceRestClient::BinanceRestClient() = default;
+namespace {
+
+// Tope por request: una sesión colgada no debe retener el pool (ni stop())
+constexpr int32_t kRequestTimeoutMs = 10'000;
+
+} // namespace
+
+BinanceRestClient::BinanceRestClient(std::string restBaseUrl, size_t maxSessions)
+    : _restBaseUrl(std::move(restBaseUrl))
+    , _maxSessions(std::max<size_t>(1, maxSessions))
+{
+}
+
+BinanceRestClient::~BinanceRestClient() = default;
+
+std::unique_ptr<cpr::Session> BinanceRestClient::acquireSession() {
+    std::unique_lock<std::mutex> lock(_sessionsMtx);
+    _sessionsCv.wait(lock, [this] {
+        return !_idleSessions.empty() || _createdSessions < _maxSessions;
+    });
+
+    if (!_idleSessions.empty()) {
+        std::unique_ptr<cpr::Session> session = std::move(_idleSessions.back());
+        _idleSessions.pop_back();
+        return session;
+    }
+
+    ++_createdSessions;
+    lock.unlock();
+
+    auto session = std::make_unique<cpr::Session>();
+    session->SetTimeout(cpr::Timeout{ kRequestTimeoutMs });
+#ifndef _WIN32
+    // En Linux dentro del contenedor, decile explícitamente dónde están los certificados raíz
+    // (en Windows, Schannel ya conoce los CAs del sistema)
+    session->SetSslOptions(cpr::Ssl(cpr::ssl::CaInfo{ "/etc/ssl/certs/ca-certificates.crt" }));
+#endif
+    return session;
+}
+
+void BinanceRestClient::releaseSession(std::unique_ptr<cpr::Session> session) {
+    {
+        std::lock_guard<std::mutex> lock(_sessionsMtx);
+        _idleSessions.push_back(std::move(session));
+    }
+    _sessionsCv.notify_one();
+}
 
 // -----------------------------------------------------------------------------
 // loadInitialBookSnapshot
@@ -25,7 +75,8 @@ BinanceRestClient::BinanceRestClient() = default;
 //
 // Comportamiento:
 //  1. Convierte el símbolo a mayúsculas (Binance usa uppercase en REST).
-//  2. Solicita el snapshot REST a /api/v3/depth.
+//  2. Solicita el snapshot REST a /api/v3/depth con una sesión del pool
+//     (y lo graba si hay journal).
 //  3. Parsea la respuesta JSON y valida estructura.
 //  4. Aplica niveles "bids" y "asks" al libro.
 //  5. Retorna el lastUpdateId recibido para sincronización posterior.
@@ -42,27 +93,15 @@ bool BinanceRestClient::loadInitialBookSnapshot(const std::string& symbolLowerCa
     }
 
     std::string requestUrl =
-        "https://api.binance.com/api/v3/depth?symbol=" +
+        _restBaseUrl + "/api/v3/depth?symbol=" +
         symbolUpperCase +
         "&limit=" +
         std::to_string(limit);
 
-    cpr::Response response;
-
-    #ifdef _WIN32
-        // En Windows, Schannel ya conoce los CAs del sistema
-        response = cpr::Get(
-            cpr::Url{ requestUrl }
-        );
-    #else
-        // En Linux dentro del contenedor, decile explícitamente dónde están los certificados raíz
-        response = cpr::Get(
-            cpr::Url{ requestUrl },
-            cpr::Ssl(
-                cpr::ssl::CaInfo{ "/etc/ssl/certs/ca-certificates.crt" }
-            )
-        );
-    #endif
+    std::unique_ptr<cpr::Session> session = acquireSession();
+    session->SetUrl(cpr::Url{ requestUrl });
+    cpr::Response response = session->Get();
+    releaseSession(std::move(session));
 
     if (response.status_code != 200) {
         std::cerr
@@ -74,10 +113,62 @@ bool BinanceRestClient::loadInitialBookSnapshot(const std::string& symbolLowerCa
     }
 
 
+    if (_journal) {
+        _journal->append(JournalRecordType::SnapshotBody,
+            _journal->streamId(symbolLowerCase + "@snapshot"),
+            response.text.data(), response.text.size());
+    }
+
+    return applySnapshotBody(response.text, symbolUpperCase, *orderBook, outLastUpdateId);
+}
+
+// -----------------------------------------------------------------------------
+// applySnapshotBody
+// -----------------------------------------------------------------------------
+// Parsea {"lastUpdateId":..,"bids":[[px,qty],..],"asks":[..]} y reemplaza el
+// contenido del libro. Los precios/cantidades pasan a punto fijo con la
+// escala del propio libro.
+//
+// Camino rápido: parseDepthSnapshot recorre el body en streaming (sin DOM)
+// y el libro se carga en una sola sección crítica. Si el body no tiene la
+// forma esperada se cae al parseo genérico con nlohmann::json.
+//
+bool BinanceRestClient::applySnapshotBody(const std::string& body,
+    const std::string& symbolForLogs,
+    OrderBook& orderBook,
+    uint64_t& outLastUpdateId)
+{
+    const SymbolScale& scale = orderBook.scale();
+
+    // Buffers por hilo: en el arranque cada hilo carga varios símbolos
+    thread_local DepthSnapshot snapshot;
+
+    if (!parseDepthSnapshot(body.data(), body.size(), scale, snapshot) &&
+        !parseSnapshotJson(body, symbolForLogs, scale, snapshot))
+    {
+        return false;
+    }
+
+    orderBook.loadSnapshot(snapshot);
+    outLastUpdateId = snapshot.lastUpdateId;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// parseSnapshotJson
+// -----------------------------------------------------------------------------
+// Parseo genérico (DOM de nlohmann::json) para bodies que el parser en
+// streaming no reconoce.
+//
+bool BinanceRestClient::parseSnapshotJson(const std::string& body,
+    const std::string& symbolForLogs,
+    const SymbolScale& scale,
+    DepthSnapshot& out)
+{
     // Parsear respuesta JSON
     nlohmann::json jsonResponse;
     try {
-        jsonResponse = nlohmann::json::parse(response.text);
+        jsonResponse = nlohmann::json::parse(body);
     }
     catch (const std::exception& ex) {
         std::cerr << "[BinanceRestClient] ERROR al parsear JSON: " << ex.what() << "\n";
@@ -87,14 +178,15 @@ bool BinanceRestClient::loadInitialBookSnapshot(const std::string& symbolLowerCa
     // Validar presencia de campo lastUpdateId
     if (!jsonResponse.contains("lastUpdateId")) {
         std::cerr << "[BinanceRestClient] ERROR: respuesta sin 'lastUpdateId' para "
-            << symbolUpperCase << "\n";
+            << symbolForLogs << "\n";
         return false;
     }
 
-    outLastUpdateId = jsonResponse["lastUpdateId"].get<uint64_t>();
-    orderBook->clearAll();
+    out.lastUpdateId = jsonResponse["lastUpdateId"].get<uint64_t>();
+    out.bids.clear();
+    out.asks.clear();
 
-    // Cargar niveles iniciales al OrderBook
+    // Cargar niveles
     try {
         // ------------------------------
         // Bids (compras)
@@ -102,10 +194,10 @@ bool BinanceRestClient::loadInitialBookSnapshot(const std::string& symbolLowerCa
         for (auto& level : jsonResponse["bids"]) {
             if (level.size() < 2) continue;
 
-            double price = std::stod(level[0].get<std::string>());
-            double quantity = std::stod(level[1].get<std::string>());
+            Price price = parseFixed(level[0].get<std::string>(), scale.priceDecimals);
+            Qty quantity = parseFixed(level[1].get<std::string>(), scale.qtyDecimals);
 
-            orderBook->applyBidLevel(price, quantity);
+            out.bids.emplace_back(price, quantity);
         }
 
         // ------------------------------
@@ -114,10 +206,10 @@ bool BinanceRestClient::loadInitialBookSnapshot(const std::string& symbolLowerCa
         for (auto& level : jsonResponse["asks"]) {
             if (level.size() < 2) continue;
 
-            double price = std::stod(level[0].get<std::string>());
-            double quantity = std::stod(level[1].get<std::string>());
+            Price price = parseFixed(level[0].get<std::string>(), scale.priceDecimals);
+            Qty quantity = parseFixed(level[1].get<std::string>(), scale.qtyDecimals);
 
-            orderBook->applyAskLevel(price, quantity);
+            out.asks.emplace_back(price, quantity);
         }
     }
     catch (const std::exception& ex) {
@@ -1,9 +1,20 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 #include <cstdint>
 
+#include "SnapshotSource.h"
+#include "BinanceEndpoints.h"
+
 class OrderBook;
+class JournalWriter;
+struct SymbolScale;
+struct DepthSnapshot;
+
+namespace cpr { class Session; }
 
 // -----------------------------------------------------------------------------
 // BinanceRestClient
@@ -17,13 +28,28 @@ class OrderBook;
 //   uint64_t lastId = 0;
 //   client.loadInitialBookSnapshot("btcusdt", orderBook, 10, lastId);
 //
+// Conexiones:
+//   Cada request toma una cpr::Session del pool (keep-alive: la conexin TLS
+//   se reutiliza entre snapshots) y la devuelve al terminar. El pool crece a
+//   demanda hasta maxSessions; con todas ocupadas el request espera una
+//   libre. Se puede llamar desde varios hilos (arranque en paralelo, resyncs).
+//
 // Dependencias:
 //   - cpr (HTTP client)
 //   - nlohmann::json (parser JSON)
 // -----------------------------------------------------------------------------
-class BinanceRestClient {
+class BinanceRestClient : public SnapshotSource {
 public:
-    BinanceRestClient();
+    // restBaseUrl permite apuntar a otro servidor (ej: mock local)
+    // maxSessions: conexiones persistentes (= requests simultneos como mximo)
+    explicit BinanceRestClient(std::string restBaseUrl = kBinanceRestBaseUrl, size_t maxSessions = 1);
+    ~BinanceRestClient() override;
+
+    BinanceRestClient(const BinanceRestClient&) = delete;
+    BinanceRestClient& operator=(const BinanceRestClient&) = delete;
+
+    // Graba el body de cada snapshot recibido en el journal (nullptr = no grabar)
+    void recordTo(JournalWriter* journal) { _journal = journal; }
 
     // -------------------------------------------------------------------------
     // loadInitialBookSnapshot
@@ -43,5 +69,39 @@ public:
     bool loadInitialBookSnapshot(const std::string& symbolLowerCase,
         std::shared_ptr<OrderBook> orderBook,
         int limit,
+        uint64_t& outLastUpdateId) override;
+
+    // -------------------------------------------------------------------------
+    // applySnapshotBody
+    // -------------------------------------------------------------------------
+    // Parsea el body JSON de /api/v3/depth y lo carga en orderBook (lo vaca
+    // antes y lo recorta a su maxDepth). Parseo en streaming, sin DOM, salvo
+    // que el body no tenga la forma esperada. Compartido con el replay de
+    // journals. symbolForLogs solo se usa en los mensajes de error.
+    // -------------------------------------------------------------------------
+    static bool applySnapshotBody(const std::string& body,
+        const std::string& symbolForLogs,
+        OrderBook& orderBook,
         uint64_t& outLastUpdateId);
+
+private:
+    // Fallback de applySnapshotBody con el DOM de nlohmann::json
+    static bool parseSnapshotJson(const std::string& body,
+        const std::string& symbolForLogs,
+        const SymbolScale& scale,
+        DepthSnapshot& out);
+
+    // Toma una sesin libre (o crea una si hay cupo; si no, espera)
+    std::unique_ptr<cpr::Session> acquireSession();
+    void releaseSession(std::unique_ptr<cpr::Session> session);
+
+    std::string _restBaseUrl;
+    JournalWriter* _journal = nullptr;
+
+    // Pool de sesiones keep-alive
+    size_t _maxSessions;
+    size_t _createdSessions = 0;
+    std::vector<std::unique_ptr<cpr::Session>> _idleSessions;
+    std::mutex _sessionsMtx;
+    std::condition_variable _sessionsCv;
 };
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "BinanceStreamMux.h"
+#include "MarketDataParser.h"
+
+#include <algorithm>
+#include <iostream>
+
+BinanceStreamMux::BinanceStreamMux(size_t maxStreamsPerSocket, const std::string& wsBaseUrl)
+    : _maxStreamsPerSocket(maxStreamsPerSocket > 0 ? maxStreamsPerSocket : kDefaultStreamsPerSocket)
+    , _wsBaseUrl(wsBaseUrl)
+{
+}
+
+BinanceStreamMux::~BinanceStreamMux() {
+    stop();
+}
+
+void BinanceStreamMux::subscribe(const std::string& streamName, FrameHandler handler) {
+    if (_running) {
+        std::cerr << "[StreamMux] WARNING: subscribe(" << streamName
+            << ") despues de start(), se ignora\n";
+        return;
+    }
+    _pending.push_back(Route{ streamName, std::move(handler) });
+}
+
+void BinanceStreamMux::start() {
+    if (_running.exchange(true)) {
+        return;
+    }
+
+    // Repartimos las suscripciones en conexiones de hasta _maxStreamsPerSocket
+    for (size_t first = 0; first < _pending.size(); first += _maxStreamsPerSocket) {
+        auto conn = std::make_unique<Connection>();
+        conn->id = _connections.size();
+
+        size_t last = std::min(first + _maxStreamsPerSocket, _pending.size());
+        for (size_t i = first; i < last; ++i) {
+            conn->routes.push_back(std::move(_pending[i]));
+        }
+        for (auto& route : conn->routes) {
+            conn->byStream[route.stream] = &route.handler;
+        }
+
+        // <wsBaseUrl>/stream?streams=a/b/c
+        std::string wsUrl = _wsBaseUrl + "/stream?streams=";
+        for (size_t i = 0; i < conn->routes.size(); ++i) {
+            if (i > 0) wsUrl += "/";
+            wsUrl += conn->routes[i].stream;
+        }
+
+        conn->ws = std::make_unique<ix::WebSocket>();
+        conn->ws->setUrl(wsUrl);
+
+        {
+            #ifdef _WIN32
+                    ix::SocketTLSOptions tlsOptions;
+                    conn->ws->setTLSOptions(tlsOptions);
+            #else
+                    ix::SocketTLSOptions tlsOptions;
+                    tlsOptions.caFile = "/etc/ssl/certs/ca-certificates.crt";
+                    conn->ws->setTLSOptions(tlsOptions);
+            #endif
+        }
+
+        Connection* connPtr = conn.get();
+        conn->ws->setOnMessageCallback(
+            [this, connPtr](const ix::WebSocketMessagePtr& msg)
+            {
+                onMessage(*connPtr, msg);
+            }
+        );
+
+        _connections.push_back(std::move(conn));
+    }
+    _pending.clear();
+
+    for (auto& conn : _connections) {
+        conn->ws->start();
+    }
+}
+
+void BinanceStreamMux::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+
+    for (auto& conn : _connections) {
+        conn->ws->stop();
+    }
+    std::cerr << "[StreamMux] Detenidas " << _connections.size() << " conexiones\n";
+}
+
+void BinanceStreamMux::onMessage(Connection& conn, const ix::WebSocketMessagePtr& msg) {
+    switch (msg->type) {
+    case ix::WebSocketMessageType::Open:
+        std::cerr << "[StreamMux] Conexion " << conn.id << " abierta ("
+            << conn.routes.size() << " streams)\n";
+        return;
+
+    case ix::WebSocketMessageType::Close:
+        std::cerr << "[StreamMux] Conexion " << conn.id << " cerrada\n";
+        return;
+
+    case ix::WebSocketMessageType::Error:
+        std::cerr << "[StreamMux] ERROR en conexion " << conn.id
+            << ": " << msg->errorInfo.reason << "\n";
+        return;
+
+    case ix::WebSocketMessageType::Message:
+        break;
+
+    default:
+        return;
+    }
+
+    const std::string& text = msg->str;
+    CombinedEnvelope envelope;
+    if (!parseCombinedEnvelope(text.data(), text.size(), envelope)) {
+        return; // no es un frame de combined stream (ej: respuesta de suscripción)
+    }
+
+    std::string_view stream(envelope.streamFirst,
+        static_cast<size_t>(envelope.streamLast - envelope.streamFirst));
+    auto it = conn.byStream.find(stream);
+    if (it == conn.byStream.end()) {
+        return;
+    }
+
+    (*it->second)(envelope.dataFirst,
+        static_cast<size_t>(envelope.dataLast - envelope.dataFirst));
+}
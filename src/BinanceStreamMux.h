@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <cstddef>
+
+#include <ixwebsocket/IXWebSocket.h>
+#include "BinanceEndpoints.h"
+
+// -----------------------------------------------------------------------------
+// BinanceStreamMux
+// -----------------------------------------------------------------------------
+// Administrador de conexiones para combined streams de Binance:
+//   wss://stream.binance.com:9443/stream?streams=btcusdt@depth@100ms/btcusdt@trade/...
+//
+// En lugar de abrir un WebSocket (y un hilo de ixwebsocket) por stream, agrupa
+// hasta maxStreamsPerSocket streams por conexión. Cada frame llega envuelto como
+//   {"stream":"<nombre>","data":{...}}
+// y se rutea por el campo "stream" al handler registrado, pasándole solo el
+// rango crudo de "data" (sin copiarlo).
+//
+// Ejemplo:
+//   BinanceStreamMux mux(200);
+//   mux.subscribe("btcusdt@trade", [](const char* data, size_t len) { ... });
+//   mux.start();
+//   ...
+//   mux.stop();
+//
+// Threading:
+//   - subscribe() solo antes de start().
+//   - Cada conexión tiene su propio hilo de ixwebsocket; todos los frames de un
+//     stream llegan siempre por el mismo hilo (un único productor por stream).
+// -----------------------------------------------------------------------------
+class BinanceStreamMux {
+public:
+    using FrameHandler = std::function<void(const char* data, size_t len)>;
+
+    // Binance admite hasta 1024 streams por conexión
+    static constexpr size_t kDefaultStreamsPerSocket = 200;
+
+    explicit BinanceStreamMux(size_t maxStreamsPerSocket = kDefaultStreamsPerSocket,
+        const std::string& wsBaseUrl = kBinanceWsBaseUrl);
+    ~BinanceStreamMux();
+
+    // Registra un stream (ej "btcusdt@depth@100ms") y su consumidor.
+    void subscribe(const std::string& streamName, FrameHandler handler);
+
+    // Abre las conexiones necesarias. Idempotente.
+    void start();
+
+    // Cierra todas las conexiones. Idempotente.
+    void stop();
+
+    size_t connectionCount() const { return _connections.size(); }
+
+private:
+    struct Route {
+        std::string stream;
+        FrameHandler handler;
+    };
+
+    struct Connection {
+        size_t id = 0;
+        std::vector<Route> routes;
+        // Vista -> handler; las claves apuntan a routes[i].stream (estable tras start)
+        std::unordered_map<std::string_view, const FrameHandler*> byStream;
+        std::unique_ptr<ix::WebSocket> ws;
+    };
+
+    void onMessage(Connection& conn, const ix::WebSocketMessagePtr& msg);
+
+    size_t _maxStreamsPerSocket;
+    std::string _wsBaseUrl;
+    std::vector<Route> _pending; // suscripciones antes de start()
+    std::vector<std::unique_ptr<Connection>> _connections;
+    std::atomic<bool> _running{ false };
+};
@@ -1,13 +1,49 @@
 ﻿#include "BinanceTradeStream.h"
 #include "TradeStats.h"
+#include "MarketDataParser.h"
+#include "Journal.h"
+#include "ShmBookWriter.h"
+#include "Utils.h"
 
 #include <iostream>
 #include <cctype>
 #include <nlohmann/json.hpp>
 
+namespace {
+
+// Fallback genérico con nlohmann::json para frames que el parser dedicado no
+// reconoce. Retorna false si el mensaje no es un trade.
+bool parseTradeJson(const char* data, size_t len, const SymbolScale& scale, TradeEvent& out) {
+    using nlohmann::json;
+
+    json jsonMsg = json::parse(data, data + len);
+
+    // Binance trade event:
+    //  "p": precio (string)
+    //  "q": cantidad (string)
+    //  "m": isBuyerMaker (bool)
+    if (!jsonMsg.contains("p") ||
+        !jsonMsg.contains("q") ||
+        !jsonMsg.contains("m"))
+    {
+        return false;
+    }
+
+    out.price = parseFixed(jsonMsg["p"].get<std::string>(), scale.priceDecimals);
+    out.qty = parseFixed(jsonMsg["q"].get<std::string>(), scale.qtyDecimals);
+    out.isBuyerMaker = jsonMsg["m"].get<bool>();
+    if (jsonMsg.contains("T")) out.tradeTime = jsonMsg["T"].get<uint64_t>();
+    if (jsonMsg.contains("E")) out.eventTime = jsonMsg["E"].get<uint64_t>();
+    return true;
+}
+
+} // namespace
+
 BinanceTradeStream::BinanceTradeStream(const std::string& symbolLower,
-    std::shared_ptr<TradeStats> tradeStats)
+    std::shared_ptr<TradeStats> tradeStats,
+    const std::string& wsBaseUrl)
     : _symbolLower(symbolLower)
+    , _wsBaseUrl(wsBaseUrl)
     , _tradeStats(std::move(tradeStats))
 {
     // Precalculamos la versión en mayúsculas (ej: "BTCUSDT")
@@ -23,12 +59,17 @@ void BinanceTradeStream::start() {
         return;
     }
 
+    // Con multiplexor los frames llegan por su conexión compartida (ver attach)
+    if (_mux) {
+        return;
+    }
+
     // Stream de trades en tiempo real:
-    //   wss://stream.binance.com:9443/ws/<symbol>@trade
+    //   <wsBaseUrl>/ws/<symbol>@trade
     //
     // Ejemplo: wss://stream.binance.com:9443/ws/btcusdt@trade
     std::string wsUrl =
-        "wss://stream.binance.com:9443/ws/" +
+        _wsBaseUrl + "/ws/" +
         _symbolLower +
         "@trade";
 
@@ -48,8 +89,6 @@ void BinanceTradeStream::start() {
     _ws.setOnMessageCallback(
         [this](const ix::WebSocketMessagePtr& msg)
         {
-            using nlohmann::json;
-
             switch (msg->type) {
             case ix::WebSocketMessageType::Open:
                 std::cerr << "[TradeStream] Conectado " << _symbolLower << "\n";
@@ -72,49 +111,78 @@ void BinanceTradeStream::start() {
             }
 
             // Mensaje normal de trade
-            try {
-                json jsonMsg = json::parse(msg->str);
-
-                // Binance trade event:
-                //  "p": precio (string)
-                //  "q": cantidad (string)
-                //  "m": isBuyerMaker (bool)
-                //
-                // Convención:
-                //   isBuyerMaker = true  → trade lo inició el vendedor (side = "sell")
-                //   isBuyerMaker = false → trade lo inició el comprador (side = "buy")
-                if (!jsonMsg.contains("p") ||
-                    !jsonMsg.contains("q") ||
-                    !jsonMsg.contains("m"))
-                {
-                    return;
-                }
-
-                double price = std::stod(jsonMsg["p"].get<std::string>());
-                double quantity = std::stod(jsonMsg["q"].get<std::string>());
-                bool isBuyerMaker = jsonMsg["m"].get<bool>();
-
-                // Actualizar estadísticas del símbolo (último trade, VWAP sesión, etc.)
-                if (_tradeStats) {
-                    _tradeStats->onTrade(price, quantity, isBuyerMaker ? "sell" : "buy");
-                }
-            }
-            catch (const std::exception& ex) {
-                std::cerr << "[TradeStream] ERROR parseando trade de "
-                    << _symbolLower << ": " << ex.what() << "\n";
-            }
+            onFrame(msg->str.data(), msg->str.size());
         }
     );
 
     _ws.start();
 }
 
+void BinanceTradeStream::attach(BinanceStreamMux& mux) {
+    _mux = &mux;
+    mux.subscribe(_symbolLower + "@trade",
+        [this](const char* data, size_t len) { onFrame(data, len); });
+}
+
+void BinanceTradeStream::recordTo(JournalWriter* journal) {
+    _journal = journal;
+    if (_journal) {
+        _journalStreamId = _journal->streamId(_symbolLower + "@trade");
+    }
+}
+
+void BinanceTradeStream::publishTo(ShmBookWriter* shm, uint32_t slot) {
+    _shm = shm;
+    _shmSlot = slot;
+}
+
+void BinanceTradeStream::onFrame(const char* data, size_t len) {
+    if (_journal) {
+        _journal->append(JournalRecordType::TradeFrame, _journalStreamId, data, len);
+    }
+
+    try {
+        if (!_tradeStats) return;
+
+        // Camino rápido: parser dedicado del evento trade (sin DOM ni strings).
+        // Si el frame tiene otra forma, caemos al parseo con nlohmann.
+        //
+        // Convención:
+        //   isBuyerMaker = true  → trade lo inició el vendedor (side = "sell")
+        //   isBuyerMaker = false → trade lo inició el comprador (side = "buy")
+        const SymbolScale& scale = _tradeStats->scale();
+        TradeEvent trade;
+        if (!parseTrade(data, len, scale, trade) &&
+            !parseTradeJson(data, len, scale, trade))
+        {
+            return;
+        }
+
+        // Actualizar estadísticas del símbolo (último trade, VWAP sesión, etc.)
+        _tradeStats->onTrade(trade.price, trade.qty, trade.isBuyerMaker ? "sell" : "buy", trade.tradeTime);
+
+        // Memoria compartida: último trade y VWAPs a la hora del trade
+        if (_shm) {
+            const double nowSec = trade.tradeTime > 0
+                ? static_cast<double>(trade.tradeTime) / 1000.0
+                : nowUnixSeconds();
+            _shm->writeTrade(_shmSlot, _tradeStats->snapshotTop(nowSec), trade.tradeTime);
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "[TradeStream] ERROR parseando trade de "
+            << _symbolLower << ": " << ex.what() << "\n";
+    }
+}
+
 void BinanceTradeStream::stop() {
     if (!_running.exchange(false)) {
         // ya estaba detenido
         return;
     }
 
-    _ws.stop();
+    if (!_mux) {
+        _ws.stop();
+    }
     std::cerr << "[TradeStream] Detenido " << _symbolLower << "\n";
 }
\ No newline at end of file
@@ -2,10 +2,15 @@
 #include <string>
 #include <memory>
 #include <atomic>
+#include <cstdint>
 
 #include <ixwebsocket/IXWebSocket.h>
+#include "BinanceStreamMux.h"
+#include "BinanceEndpoints.h"
 
 class TradeStats;
+class JournalWriter;
+class ShmBookWriter;
 
 // -----------------------------------------------------------------------------
 // BinanceTradeStream
@@ -34,8 +39,24 @@ class TradeStats;
 class BinanceTradeStream {
 public:
     // symbolLower debe venir en minúsculas (ej. "btcusdt")
+    // wsBaseUrl permite apuntar a otro servidor (ej: mock local).
     BinanceTradeStream(const std::string& symbolLower,
-        std::shared_ptr<TradeStats> tradeStats);
+        std::shared_ptr<TradeStats> tradeStats,
+        const std::string& wsBaseUrl = kBinanceWsBaseUrl);
+
+    // Modo multiplexado: se suscribe a <symbol>@trade en el BinanceStreamMux
+    // compartido en lugar de abrir su propio WebSocket. Llamar antes de mux.start().
+    void attach(BinanceStreamMux& mux);
+
+    // Graba cada frame crudo recibido en el journal. Llamar antes de start().
+    void recordTo(JournalWriter* journal);
+
+    // Publica último trade y VWAPs en el slot del segmento compartido en cada
+    // trade. Llamar antes de start().
+    void publishTo(ShmBookWriter* shm, uint32_t slot);
+
+    // Entrega un frame como si hubiera llegado por el WebSocket (replay de journals).
+    void injectFrame(const char* data, size_t len) { onFrame(data, len); }
 
     // Abre la conexión WebSocket y comienza a recibir eventos de trade.
     // Es idempotente: si ya estaba corriendo, no hace nada.
@@ -46,19 +67,36 @@ public:
     void stop();
 
 private:
+    // Parsea un frame de trade (payload crudo) y actualiza TradeStats.
+    void onFrame(const char* data, size_t len);
+
     // Símbolo en minúsculas (ej "btcusdt")
     std::string _symbolLower;
 
     // Versión en mayúsculas (ej "BTCUSDT"), útil para logs o llamadas REST si hiciera falta
     std::string _symbolUpper;
 
+    // URL base del WebSocket (sin "/" final)
+    std::string _wsBaseUrl;
+
     // Donde se acumulan las métricas del símbolo:
     //  último trade, VWAP sesión, lado agresor, etc.
     std::shared_ptr<TradeStats> _tradeStats;
 
-    // Socket WebSocket hacia Binance
+    // Socket WebSocket hacia Binance (sin uso si _mux != nullptr)
     ix::WebSocket _ws;
 
+    // Multiplexor compartido (modo combined streams), o nullptr
+    BinanceStreamMux* _mux = nullptr;
+
+    // Journal de captura (nullptr = no se graba) y id del stream en él
+    JournalWriter* _journal = nullptr;
+    uint16_t _journalStreamId = 0;
+
+    // Memoria compartida (nullptr = no se publica) y slot del símbolo
+    ShmBookWriter* _shm = nullptr;
+    uint32_t _shmSlot = 0;
+
     // Estado de ejecución del stream (true = activo)
     std::atomic<bool> _running{ false };
 };
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "BookAnalytics.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BOOK_ANALYTICS_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BOOK_ANALYTICS_SSE2 1
+#endif
+
+namespace {
+
+constexpr size_t kLanes = 4; // los arrays se rellenan a múltiplo de 4 doubles
+
+// Notional (px * qty) de los niveles con lo <= px <= hi. px va del mejor
+// al peor, así que los niveles dentro del rango son un prefijo: corta en el
+// primer bloque sin ninguno (el relleno, con px = 0, nunca está dentro).
+// n múltiplo de kLanes.
+double rangeNotional(const double* px, const double* qty, size_t n, double lo, double hi) {
+#if defined(BOOK_ANALYTICS_AVX)
+    const __m256d vlo = _mm256_set1_pd(lo);
+    const __m256d vhi = _mm256_set1_pd(hi);
+    __m256d acc = _mm256_setzero_pd();
+    for (size_t i = 0; i < n; i += 4) {
+        const __m256d p = _mm256_loadu_pd(px + i);
+        const __m256d in = _mm256_and_pd(_mm256_cmp_pd(p, vlo, _CMP_GE_OQ), _mm256_cmp_pd(p, vhi, _CMP_LE_OQ));
+        if (_mm256_movemask_pd(in) == 0) {
+            break;
+        }
+        acc = _mm256_add_pd(acc, _mm256_and_pd(in, _mm256_mul_pd(p, _mm256_loadu_pd(qty + i))));
+    }
+    const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#elif defined(BOOK_ANALYTICS_SSE2)
+    const __m128d vlo = _mm_set1_pd(lo);
+    const __m128d vhi = _mm_set1_pd(hi);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    for (size_t i = 0; i < n; i += 4) {
+        const __m128d p0 = _mm_loadu_pd(px + i);
+        const __m128d p1 = _mm_loadu_pd(px + i + 2);
+        const __m128d in0 = _mm_and_pd(_mm_cmpge_pd(p0, vlo), _mm_cmple_pd(p0, vhi));
+        const __m128d in1 = _mm_and_pd(_mm_cmpge_pd(p1, vlo), _mm_cmple_pd(p1, vhi));
+        if ((_mm_movemask_pd(in0) | _mm_movemask_pd(in1)) == 0) {
+            break;
+        }
+        acc0 = _mm_add_pd(acc0, _mm_and_pd(in0, _mm_mul_pd(p0, _mm_loadu_pd(qty + i))));
+        acc1 = _mm_add_pd(acc1, _mm_and_pd(in1, _mm_mul_pd(p1, _mm_loadu_pd(qty + i + 2))));
+    }
+    const __m128d acc = _mm_add_pd(acc0, acc1);
+    return _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+#else
+    double acc[kLanes] = {};
+    for (size_t i = 0; i < n; i += kLanes) {
+        bool any = false;
+        for (size_t l = 0; l < kLanes; ++l) {
+            const double p = px[i + l];
+            const bool in = p >= lo && p <= hi;
+            acc[l] += in ? p * qty[i + l] : 0.0;
+            any = any || in;
+        }
+        if (!any) {
+            break;
+        }
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+}
+
+// sum = suma de qty, weighted = suma de qty * w. n múltiplo de kLanes.
+void qtySums(const double* qty, const double* w, size_t n, double& sum, double& weighted) {
+#if defined(BOOK_ANALYTICS_AVX)
+    __m256d s = _mm256_setzero_pd();
+    __m256d ws = _mm256_setzero_pd();
+    for (size_t i = 0; i < n; i += 4) {
+        const __m256d q = _mm256_loadu_pd(qty + i);
+        s = _mm256_add_pd(s, q);
+        ws = _mm256_add_pd(ws, _mm256_mul_pd(q, _mm256_loadu_pd(w + i)));
+    }
+    const __m128d s2 = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    const __m128d ws2 = _mm_add_pd(_mm256_castpd256_pd128(ws), _mm256_extractf128_pd(ws, 1));
+    sum = _mm_cvtsd_f64(_mm_add_sd(s2, _mm_unpackhi_pd(s2, s2)));
+    weighted = _mm_cvtsd_f64(_mm_add_sd(ws2, _mm_unpackhi_pd(ws2, ws2)));
+#elif defined(BOOK_ANALYTICS_SSE2)
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    __m128d ws0 = _mm_setzero_pd();
+    __m128d ws1 = _mm_setzero_pd();
+    for (size_t i = 0; i < n; i += 4) {
+        const __m128d q0 = _mm_loadu_pd(qty + i);
+        const __m128d q1 = _mm_loadu_pd(qty + i + 2);
+        s0 = _mm_add_pd(s0, q0);
+        s1 = _mm_add_pd(s1, q1);
+        ws0 = _mm_add_pd(ws0, _mm_mul_pd(q0, _mm_loadu_pd(w + i)));
+        ws1 = _mm_add_pd(ws1, _mm_mul_pd(q1, _mm_loadu_pd(w + i + 2)));
+    }
+    const __m128d s = _mm_add_pd(s0, s1);
+    const __m128d ws = _mm_add_pd(ws0, ws1);
+    sum = _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    weighted = _mm_cvtsd_f64(_mm_add_sd(ws, _mm_unpackhi_pd(ws, ws)));
+#else
+    double s[kLanes] = {};
+    double ws[kLanes] = {};
+    for (size_t i = 0; i < n; i += kLanes) {
+        for (size_t l = 0; l < kLanes; ++l) {
+            s[l] += qty[i + l];
+            ws[l] += qty[i + l] * w[i + l];
+        }
+    }
+    sum = (s[0] + s[1]) + (s[2] + s[3]);
+    weighted = (ws[0] + ws[1]) + (ws[2] + ws[3]);
+#endif
+}
+
+} // namespace
+
+BookAnalytics::BookAnalytics(const AnalyticsConfig& config)
+    : _bandsBps(config.bandsBps)
+    , _levels(std::max(config.levels, 1))
+    , _padded((static_cast<size_t>(_levels) + kLanes - 1) / kLanes * kLanes)
+    , _weights(_padded, 0.0)
+{
+    if (_bandsBps.size() > kMaxAnalyticsBands) {
+        throw std::runtime_error("BookAnalytics: demasiadas bandas (max 8)");
+    }
+    for (int i = 0; i < _levels; ++i) {
+        _weights[static_cast<size_t>(i)] = 1.0 / static_cast<double>(i + 1);
+    }
+    for (Side* side : { &_bids, &_asks }) {
+        side->px.assign(_padded, 0.0);
+        side->qty.assign(_padded, 0.0);
+    }
+}
+
+void BookAnalytics::load(const std::vector<Level>& levels, const SymbolScale& scale, Side& side) {
+    // AoS en punto fijo -> SoA en decimal. int64 -> double no tiene
+    // instrucción empaquetada antes de AVX-512: este paso queda escalar.
+    const double pxUnit = 1.0 / static_cast<double>(pow10i(scale.priceDecimals));
+    const double qtyUnit = 1.0 / static_cast<double>(pow10i(scale.qtyDecimals));
+    const size_t count = std::min(levels.size(), static_cast<size_t>(_levels));
+    for (size_t i = 0; i < count; ++i) {
+        side.px[i] = static_cast<double>(levels[i].price) * pxUnit;
+        side.qty[i] = static_cast<double>(levels[i].qty) * qtyUnit;
+    }
+    // Lo que quedó de la pasada anterior pasa a ser relleno
+    std::fill(side.px.begin() + static_cast<std::ptrdiff_t>(count),
+        side.px.begin() + static_cast<std::ptrdiff_t>(std::max(count, side.count)), 0.0);
+    std::fill(side.qty.begin() + static_cast<std::ptrdiff_t>(count),
+        side.qty.begin() + static_cast<std::ptrdiff_t>(std::max(count, side.count)), 0.0);
+    side.count = count;
+}
+
+void BookAnalytics::compute(const std::vector<Level>& bids, const std::vector<Level>& asks,
+    const SymbolScale& scale, DepthMetrics& out)
+{
+    const size_t bands = _bandsBps.size();
+    out.bidNotional.assign(bands, 0.0);
+    out.askNotional.assign(bands, 0.0);
+    out.microprice = 0.0;
+    out.weightedImbalance = 0.0;
+    out.bidSlope = 0.0;
+    out.askSlope = 0.0;
+
+    load(bids, scale, _bids);
+    load(asks, scale, _asks);
+
+    // Sin los dos lados no hay mid: todo queda en 0
+    if (_bids.count == 0 || _asks.count == 0) {
+        return;
+    }
+
+    // microprice en ticks, con las cantidades en punto fijo (la escala se cancela)
+    const double bidPx = static_cast<double>(bids[0].price);
+    const double askPx = static_cast<double>(asks[0].price);
+    const double bidQty = static_cast<double>(bids[0].qty);
+    const double askQty = static_cast<double>(asks[0].qty);
+    out.microprice = bidQty + askQty > 0.0
+        ? (bidPx * askQty + askPx * bidQty) / (bidQty + askQty)
+        : (bidPx + askPx) / 2.0;
+
+    const double mid = (_bids.px[0] + _asks.px[0]) / 2.0;
+
+    // Bandas: [mid - N bps, mid] en bids y [mid, mid + N bps] en asks. Los
+    // niveles que no se analizan (más allá de levels) no entran aunque caigan
+    // dentro de la banda.
+    for (size_t b = 0; b < bands; ++b) {
+        const double width = mid * static_cast<double>(_bandsBps[b]) / 10'000.0;
+        out.bidNotional[b] = rangeNotional(_bids.px.data(), _bids.qty.data(), _padded, mid - width, mid);
+        out.askNotional[b] = rangeNotional(_asks.px.data(), _asks.qty.data(), _padded, mid, mid + width);
+    }
+
+    double bidSum = 0.0;
+    double bidWeighted = 0.0;
+    double askSum = 0.0;
+    double askWeighted = 0.0;
+    qtySums(_bids.qty.data(), _weights.data(), _padded, bidSum, bidWeighted);
+    qtySums(_asks.qty.data(), _weights.data(), _padded, askSum, askWeighted);
+
+    if (bidWeighted + askWeighted > 0.0) {
+        out.weightedImbalance = bidWeighted / (bidWeighted + askWeighted);
+    }
+
+    // Pendiente: cantidad acumulada / distancia (bps) del último nivel al mid
+    const double bidDistBps = (mid - _bids.px[_bids.count - 1]) / mid * 10'000.0;
+    const double askDistBps = (_asks.px[_asks.count - 1] - mid) / mid * 10'000.0;
+    if (bidDistBps > 0.0) out.bidSlope = bidSum / bidDistBps;
+    if (askDistBps > 0.0) out.askSlope = askSum / askDistBps;
+}
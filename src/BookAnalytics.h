@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "FixedPoint.h"
+#include "BookSide.h"
+#include "SnapshotRecord.h"
+
+constexpr size_t kMaxAnalyticsBands = 8;
+
+struct AnalyticsConfig {
+    std::vector<int> bandsBps; // --analytics=5,10,25: bandas alrededor del mid (hasta 8; vacío = sin analytics)
+    int levels = 20;           // --analytics-levels=20: niveles por lado que se analizan
+};
+
+// -----------------------------------------------------------------------------
+// BookAnalytics
+// -----------------------------------------------------------------------------
+// Métricas de profundidad de un libro (DepthMetrics) para cada fila que
+// publica el Publisher, sobre los `levels` mejores niveles de cada lado:
+// - notional acumulado (en quote) dentro de mid -N bps (bids) y mid +N bps
+//   (asks) para cada banda
+// - microprice: (bid * askQty + ask * bidQty) / (bidQty + askQty)
+// - imbalance ponderado: bids / (bids + asks) con peso 1/(nivel+1)
+// - pendiente de cada lado: cantidad acumulada por bp de distancia entre el
+//   mid y el último nivel analizado
+//
+// Los niveles se pasan una vez a un layout de structure-of-arrays (precio y
+// cantidad en decimal, en arrays de double contiguos y rellenos con ceros
+// hasta múltiplo de 4) y las sumas son kernels SIMD sin saltos: AVX si se
+// compila con -mavx, si no SSE2 (base de x86-64), y un loop escalar en otras
+// arquitecturas. El relleno no suma (cantidad 0), así no hay colas escalares.
+//
+// Reutiliza sus arrays entre llamadas: en régimen no reserva memoria.
+// No es thread-safe (la usa el hilo del Publisher).
+// Lanza std::runtime_error con más de kMaxAnalyticsBands bandas.
+// -----------------------------------------------------------------------------
+class BookAnalytics {
+public:
+    explicit BookAnalytics(const AnalyticsConfig& config);
+
+    // bids/asks del mejor al peor (se usan hasta levels() por lado)
+    void compute(const std::vector<Level>& bids, const std::vector<Level>& asks,
+        const SymbolScale& scale, DepthMetrics& out);
+
+    const std::vector<int>& bands() const { return _bandsBps; }
+    int levels() const { return _levels; }
+
+private:
+    // Un lado del libro en SoA (capacidad fija: _padded)
+    struct Side {
+        std::vector<double> px;
+        std::vector<double> qty;
+        size_t count = 0;
+    };
+
+    void load(const std::vector<Level>& levels, const SymbolScale& scale, Side& side);
+
+    std::vector<int> _bandsBps;
+    int _levels;
+    size_t _padded; // levels redondeado a múltiplo de 4
+    std::vector<double> _weights; // 1/(nivel+1), 0 en el relleno
+    Side _bids;
+    Side _asks;
+};
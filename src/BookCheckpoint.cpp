@@ -0,0 +1,250 @@
+#include "BookCheckpoint.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Journal.h"
+
+namespace {
+
+constexpr uint32_t kMagic = 0x54504B43; // "CKPT"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kSymbolLen = 32;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t levels;       // niveles por lado en cada slot
+    int32_t priceDecimals;
+    int32_t qtyDecimals;
+    uint32_t reserved0;
+    char symbol[kSymbolLen];
+    uint8_t reserved[8];
+};
+
+struct SlotHeader {
+    uint64_t seq;          // 0 = vacío; el válido con seq más alta es el último
+    uint64_t lastUpdateId;
+    uint64_t savedNs;      // epoch ns de la escritura
+    uint32_t bidCount;
+    uint32_t askCount;
+    uint64_t checksum;     // FNV-1a de los campos anteriores y de los niveles usados
+    uint8_t reserved[24];
+};
+
+struct FileLevel {
+    int64_t price;
+    int64_t qty;
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader debe medir 64 bytes");
+static_assert(sizeof(SlotHeader) == 64, "SlotHeader debe medir 64 bytes");
+
+size_t slotSizeFor(uint32_t levels) {
+    return sizeof(SlotHeader) + 2 * static_cast<size_t>(levels) * sizeof(FileLevel);
+}
+
+size_t fileSizeFor(uint32_t levels) {
+    return sizeof(FileHeader) + 2 * slotSizeFor(levels);
+}
+
+// FNV-1a de 64 bits, encadenable
+uint64_t fnv1a(const void* data, size_t len, uint64_t hash = 14695981039346656037ull) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t slotChecksum(const SlotHeader* slot, uint32_t levels) {
+    const auto* bids = reinterpret_cast<const FileLevel*>(slot + 1);
+    const FileLevel* asks = bids + levels;
+    uint64_t hash = fnv1a(slot, offsetof(SlotHeader, checksum));
+    hash = fnv1a(bids, slot->bidCount * sizeof(FileLevel), hash);
+    return fnv1a(asks, slot->askCount * sizeof(FileLevel), hash);
+}
+
+bool slotValid(const SlotHeader* slot, uint32_t levels) {
+    return slot->seq != 0
+        && slot->bidCount <= levels && slot->askCount <= levels
+        && slot->checksum == slotChecksum(slot, levels);
+}
+
+} // namespace
+
+BookCheckpoint::BookCheckpoint(const std::string& dir, const std::string& symbol,
+    const SymbolScale& scale, int levels)
+    : _path(dir + "/" + symbol + ".ckpt")
+    , _levels(static_cast<uint32_t>(std::max(levels, 1)))
+{
+#ifdef _WIN32
+    throw std::runtime_error("--checkpoint: archivos mapeados no disponibles en Windows");
+#else
+    if (symbol.size() >= kSymbolLen) {
+        throw std::runtime_error("BookCheckpoint: simbolo demasiado largo " + symbol);
+    }
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("No se pudo crear el directorio de checkpoints: " + dir);
+    }
+
+    const int fd = ::open(_path.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("No se pudo abrir el checkpoint: " + _path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("No se pudo leer el checkpoint: " + _path);
+    }
+
+    // 1. Lo que haya dejado la corrida anterior, con su propio layout: el
+    //    último slot válido si el archivo es de este símbolo y escala
+    bool reuseLayout = false;
+    const size_t oldSize = static_cast<size_t>(st.st_size);
+    if (oldSize >= sizeof(FileHeader)) {
+        void* p = ::mmap(nullptr, oldSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            const auto* header = static_cast<const FileHeader*>(p);
+            const bool compatible = header->magic == kMagic && header->version == kVersion
+                && header->priceDecimals == scale.priceDecimals
+                && header->qtyDecimals == scale.qtyDecimals
+                && std::strncmp(header->symbol, symbol.c_str(), kSymbolLen) == 0
+                && oldSize == fileSizeFor(header->levels);
+
+            if (compatible) {
+                const uint32_t oldLevels = header->levels;
+                const SlotHeader* best = nullptr;
+                for (uint32_t i = 0; i < 2; ++i) {
+                    const auto* slot = reinterpret_cast<const SlotHeader*>(
+                        static_cast<const char*>(p) + sizeof(FileHeader) + i * slotSizeFor(oldLevels));
+                    if (slotValid(slot, oldLevels) && (!best || slot->seq > best->seq)) {
+                        best = slot;
+                    }
+                }
+
+                if (best) {
+                    const auto* bids = reinterpret_cast<const FileLevel*>(best + 1);
+                    const FileLevel* asks = bids + oldLevels;
+                    _restored.lastUpdateId = best->lastUpdateId;
+                    _restored.bids.clear();
+                    _restored.asks.clear();
+                    for (uint32_t i = 0; i < best->bidCount; ++i) {
+                        _restored.bids.emplace_back(bids[i].price, bids[i].qty);
+                    }
+                    for (uint32_t i = 0; i < best->askCount; ++i) {
+                        _restored.asks.emplace_back(asks[i].price, asks[i].qty);
+                    }
+                    _restoredNs = best->savedNs;
+                    _hasRestored = true;
+                    _seq = best->seq;
+                }
+                reuseLayout = oldLevels == _levels;
+            }
+            ::munmap(p, oldSize);
+        }
+    }
+
+    // 2. Si cambió el layout (otro --depth, otra escala, archivo nuevo o
+    //    ajeno) se recrea en ceros: ningún slot válido hasta la primera
+    //    escritura. Lo leído arriba sigue disponible para restore().
+    _size = fileSizeFor(_levels);
+    if (!reuseLayout) {
+        if (::ftruncate(fd, 0) != 0 || ::ftruncate(fd, static_cast<off_t>(_size)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("No se pudo dimensionar el checkpoint: " + _path);
+        }
+    }
+
+    void* p = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("mmap fallido para el checkpoint: " + _path);
+    }
+    _base = static_cast<char*>(p);
+
+    if (!reuseLayout) {
+        auto* header = reinterpret_cast<FileHeader*>(_base);
+        header->version = kVersion;
+        header->levels = _levels;
+        header->priceDecimals = scale.priceDecimals;
+        header->qtyDecimals = scale.qtyDecimals;
+        std::memcpy(header->symbol, symbol.c_str(), symbol.size() + 1);
+        header->magic = kMagic;
+    }
+
+    _bids.reserve(_levels);
+    _asks.reserve(_levels);
+#endif
+}
+
+BookCheckpoint::~BookCheckpoint() {
+#ifndef _WIN32
+    if (_base) {
+        ::msync(_base, _size, MS_ASYNC);
+        ::munmap(_base, _size);
+    }
+#endif
+}
+
+char* BookCheckpoint::slotAt(uint32_t index) const {
+    return _base + sizeof(FileHeader) + index * slotSizeFor(_levels);
+}
+
+bool BookCheckpoint::restore(DepthSnapshot& snap, uint64_t& savedNs) {
+    if (!_hasRestored) {
+        return false;
+    }
+    _hasRestored = false;
+    snap = std::move(_restored);
+    savedNs = _restoredNs;
+    return true;
+}
+
+void BookCheckpoint::write(OrderBook& book, uint64_t lastUpdateId) {
+#ifndef _WIN32
+    book.topLevels(static_cast<int>(_levels), _bids, _asks);
+
+    // El slot que no tiene el último checkpoint: si morimos a mitad de esta
+    // copia, el otro sigue intacto
+    const uint64_t seq = _seq + 1;
+    auto* slot = reinterpret_cast<SlotHeader*>(slotAt(static_cast<uint32_t>(seq & 1)));
+    FileLevel* bids = reinterpret_cast<FileLevel*>(slot + 1);
+    FileLevel* asks = bids + _levels;
+
+    const uint32_t bidCount = static_cast<uint32_t>(std::min<size_t>(_bids.size(), _levels));
+    const uint32_t askCount = static_cast<uint32_t>(std::min<size_t>(_asks.size(), _levels));
+    for (uint32_t i = 0; i < bidCount; ++i) {
+        bids[i] = FileLevel{ _bids[i].price, _bids[i].qty };
+    }
+    for (uint32_t i = 0; i < askCount; ++i) {
+        asks[i] = FileLevel{ _asks[i].price, _asks[i].qty };
+    }
+
+    slot->seq = seq;
+    slot->lastUpdateId = lastUpdateId;
+    slot->savedNs = journalNowNs();
+    slot->bidCount = bidCount;
+    slot->askCount = askCount;
+    slot->checksum = slotChecksum(slot, _levels);
+    _seq = seq;
+
+    // Sin esperar al disco: ante una caída del proceso el page cache ya lo
+    // tiene, y ante un corte de luz el checksum descarta lo que quedó a medias
+    ::msync(_base, _size, MS_ASYNC);
+#else
+    (void)book;
+    (void)lastUpdateId;
+#endif
+}
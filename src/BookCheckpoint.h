@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FixedPoint.h"
+#include "BookSide.h"
+#include "OrderBook.h"
+
+// -----------------------------------------------------------------------------
+// BookCheckpoint
+// -----------------------------------------------------------------------------
+// Checkpoint en disco del libro de un símbolo (--checkpoint=dir): el archivo
+// <dir>/<symbol>.ckpt, mapeado en memoria, con los niveles del libro y el
+// lastUpdateId con el que quedaron. Al reiniciar, el BookSyncWorker lo usa
+// en lugar del snapshot REST si el stream todavía engancha con ese id.
+//
+// Layout (endianness y alineación nativas del host):
+//   FileHeader (64 bytes)       símbolo, escala y niveles por lado
+//   Slot[2], cada uno con:
+//     SlotHeader (64 bytes)     secuencia, lastUpdateId, cantidades, checksum
+//     Level bids[levels]
+//     Level asks[levels]
+//
+// Consistencia ante caídas: cada escritura va al slot que NO tiene el último
+// checkpoint y lleva un checksum (FNV-1a) de todo su contenido. Si el proceso
+// muere a mitad de una escritura ese slot no valida y queda el anterior.
+//
+// Un solo escritor por archivo (el hilo que consume el símbolo).
+// Lanza std::runtime_error si no puede abrirlo (o en Windows).
+// -----------------------------------------------------------------------------
+class BookCheckpoint {
+public:
+    // levels: niveles por lado que entran en cada slot (el --depth del libro).
+    // Si el archivo existe y es de este símbolo y escala, su último
+    // checkpoint válido queda disponible en restore().
+    BookCheckpoint(const std::string& dir, const std::string& symbol,
+        const SymbolScale& scale, int levels);
+    ~BookCheckpoint();
+
+    BookCheckpoint(const BookCheckpoint&) = delete;
+    BookCheckpoint& operator=(const BookCheckpoint&) = delete;
+
+    // Entrega (una sola vez) el checkpoint leído al abrir. savedNs: cuándo
+    // se escribió (epoch ns). false si no había ninguno válido.
+    bool restore(DepthSnapshot& snap, uint64_t& savedNs);
+
+    // Copia hasta `levels` niveles por lado del libro al slot libre y lo
+    // deja como el último checkpoint
+    void write(OrderBook& book, uint64_t lastUpdateId);
+
+    const std::string& path() const { return _path; }
+
+private:
+    char* slotAt(uint32_t index) const;
+
+    std::string _path;
+    uint32_t _levels;
+    size_t _size = 0;
+    char* _base = nullptr;
+
+    // secuencia del último checkpoint válido (0 = ninguno)
+    uint64_t _seq = 0;
+
+    // leído al abrir, hasta que lo pide restore()
+    bool _hasRestored = false;
+    DepthSnapshot _restored;
+    uint64_t _restoredNs = 0;
+
+    // niveles leídos del libro en cada write()
+    std::vector<Level> _bids;
+    std::vector<Level> _asks;
+};
@@ -0,0 +1,28 @@
+#include "BookSide.h"
+#include "PriceLadder.h"
+
+#include <stdexcept>
+
+BookEngine parseBookEngine(const std::string& name) {
+    if (name == "map") return BookEngine::Map;
+    if (name == "ladder") return BookEngine::Ladder;
+    throw std::runtime_error("Motor de libro desconocido: " + name + " (usar map|ladder)");
+}
+
+const char* bookEngineName(BookEngine engine) {
+    switch (engine) {
+    case BookEngine::Ladder: return "ladder";
+    case BookEngine::Map:
+    default:                 return "map";
+    }
+}
+
+std::unique_ptr<BookSide> makeBookSide(BookEngine engine, bool isBid, const SymbolScale& scale) {
+    if (engine == BookEngine::Ladder) {
+        return std::make_unique<PriceLadder>(isBid, scale.tickSize);
+    }
+    if (isBid) {
+        return std::make_unique<MapBookSide<std::greater<Price>>>();
+    }
+    return std::make_unique<MapBookSide<std::less<Price>>>();
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <iterator>
+#include <cstddef>
+
+#include "FixedPoint.h"
+
+// Precio y cantidad en punto fijo (ver FixedPoint.h / SymbolScale)
+struct Level {
+    Price price;
+    Qty qty;
+};
+
+// Motor de almacenamiento de niveles de un lado del libro
+enum class BookEngine {
+    Map,    // std::map (árbol rojo-negro), el motor original
+    Ladder  // escalera de precios indexada por tick (ver PriceLadder.h)
+};
+
+// "map" / "ladder" -> BookEngine. Lanza std::runtime_error si no se reconoce.
+BookEngine parseBookEngine(const std::string& name);
+const char* bookEngineName(BookEngine engine);
+
+// -----------------------------------------------------------------------------
+// BookSide
+// -----------------------------------------------------------------------------
+// Un lado del libro (bids o asks): precio -> cantidad agregada.
+// "Mejor" significa el precio más alto para bids y el más bajo para asks.
+//
+// No es thread-safe: OrderBook lo protege con su propio mutex.
+// -----------------------------------------------------------------------------
+class BookSide {
+public:
+    virtual ~BookSide() = default;
+
+    // Inserta/actualiza el nivel; qty == 0 lo elimina.
+    virtual void set(Price px, Qty qty) = 0;
+
+    virtual void clear() = 0;
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+
+    // Mejor nivel. Precondición: !empty().
+    virtual Level best() const = 0;
+
+    // Agrega a out hasta n niveles, del mejor al peor.
+    virtual void top(int n, std::vector<Level>& out) const = 0;
+
+    // Elimina los peores niveles hasta dejar a lo sumo maxLevels.
+    virtual void trimTo(size_t maxLevels) = 0;
+};
+
+// -----------------------------------------------------------------------------
+// MapBookSide
+// -----------------------------------------------------------------------------
+// Implementación sobre std::map. Compare = std::greater<Price> para bids
+// (begin() = best bid) y std::less<Price> para asks (begin() = best ask).
+// -----------------------------------------------------------------------------
+template <class Compare>
+class MapBookSide : public BookSide {
+public:
+    void set(Price px, Qty qty) override {
+        if (qty == 0)
+            _levels.erase(px);
+        else
+            _levels[px] = qty;
+    }
+
+    void clear() override { _levels.clear(); }
+    bool empty() const override { return _levels.empty(); }
+    size_t size() const override { return _levels.size(); }
+
+    Level best() const override {
+        auto it = _levels.begin();
+        return Level{ it->first, it->second };
+    }
+
+    void top(int n, std::vector<Level>& out) const override {
+        int count = 0;
+        for (auto& kv : _levels) {
+            if (count++ >= n) break;
+            out.push_back(Level{ kv.first, kv.second });
+        }
+    }
+
+    void trimTo(size_t maxLevels) override {
+        while (_levels.size() > maxLevels) {
+            _levels.erase(std::prev(_levels.end())); // el peor es el último
+        }
+    }
+
+private:
+    std::map<Price, Qty, Compare> _levels;
+};
+
+// Crea el lado pedido con el motor indicado.
+std::unique_ptr<BookSide> makeBookSide(BookEngine engine, bool isBid, const SymbolScale& scale);
@@ -0,0 +1,285 @@
+#include "BookSyncPool.h"
+#include "BookSyncWorker.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Desbalance tolerado antes de mover símbolos (sobre el promedio por shard)
+constexpr double kMaxImbalance = 0.25;
+
+void pinCurrentThread(size_t core) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (core % 64));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "[SyncPool] No se pudo fijar el hilo al core " << core << "\n";
+    }
+#else
+    (void)core; // sin API de afinidad (macOS): se ignora
+#endif
+}
+
+size_t coreCount() {
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+} // namespace
+
+size_t defaultShardCount(size_t symbolCount) {
+    const size_t shards = std::max<size_t>(1, coreCount() / 2);
+    return std::max<size_t>(1, std::min(shards, symbolCount));
+}
+
+BookSyncPool::BookSyncPool(const BookSyncPoolConfig& config, size_t symbolCount)
+    : _config(config)
+{
+    const size_t count = _config.shards > 0 ? _config.shards : defaultShardCount(symbolCount);
+    for (size_t i = 0; i < count; ++i) {
+        _shards.push_back(std::make_unique<Shard>(_config.idle));
+    }
+    _symbolsPerShard.assign(count, 0);
+}
+
+BookSyncPool::~BookSyncPool() {
+    stop();
+}
+
+void BookSyncPool::add(BookSyncWorker* worker) {
+    std::lock_guard<std::mutex> lock(_ctlMtx);
+
+    const size_t target = static_cast<size_t>(
+        std::min_element(_symbolsPerShard.begin(), _symbolsPerShard.end()) - _symbolsPerShard.begin());
+    ++_symbolsPerShard[target];
+
+    _entries.push_back(std::make_unique<Entry>());
+    Entry* e = _entries.back().get();
+    e->worker = worker;
+    e->shard = target;
+
+    if (_running) {
+        e->inTransit = true;
+        post(target, Command{ e, target });
+    }
+    else {
+        worker->notifyTo(&_shards[target]->waiter);
+        _shards[target]->entries.push_back(e);
+    }
+}
+
+void BookSyncPool::addAll(const std::vector<std::unique_ptr<BookSyncWorker>>& workers, size_t parallelism) {
+    std::atomic<size_t> next{ 0 };
+    auto bootstrap = [&] {
+        for (size_t i = next++; i < workers.size(); i = next++) {
+            workers[i]->start(/*ownThread*/ false);
+            add(workers[i].get());
+        }
+    };
+
+    // El hilo llamador también arranca símbolos
+    const size_t helpers = std::min(std::max<size_t>(1, parallelism), workers.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < helpers; ++t) {
+        threads.emplace_back(bootstrap);
+    }
+    bootstrap();
+    for (auto& thr : threads) {
+        thr.join();
+    }
+}
+
+void BookSyncPool::start() {
+    if (_running.exchange(true)) {
+        return;
+    }
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        _shards[i]->thr = std::thread(&BookSyncPool::runShard, this, i);
+    }
+    if (_config.rebalanceMs > 0 && _shards.size() > 1) {
+        _rebalancer = std::thread(&BookSyncPool::runRebalancer, this);
+    }
+}
+
+void BookSyncPool::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_ctlMtx);
+    }
+    _ctlCv.notify_all();
+    if (_rebalancer.joinable()) {
+        _rebalancer.join();
+    }
+
+    for (auto& shard : _shards) {
+        shard->waiter.wakeAll();
+        if (shard->thr.joinable()) {
+            shard->thr.join();
+        }
+    }
+
+    // Los streams siguen vivos hasta worker->stop(): que vuelvan a su waiter
+    for (auto& e : _entries) {
+        e->worker->notifyTo(nullptr);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Shards
+// -----------------------------------------------------------------------------
+
+void BookSyncPool::runShard(size_t index) {
+    using namespace std::chrono_literals;
+
+    Shard& shard = *_shards[index];
+    if (_config.pin) {
+        pinCurrentThread(index % coreCount());
+    }
+
+    auto ready = [&] {
+        if (!_running || shard.inboxPending.load(std::memory_order_acquire)) return true;
+        for (const Entry* e : shard.entries) {
+            if (e->worker->hasPendingUpdates()) return true;
+        }
+        return false;
+    };
+
+    while (_running) {
+        if (shard.inboxPending.load(std::memory_order_acquire)) {
+            applyInbox(index);
+        }
+
+        size_t consumed = 0;
+        for (Entry* e : shard.entries) {
+            const size_t n = e->worker->poll();
+            if (n > 0) {
+                e->consumed.store(e->consumed.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+                consumed += n;
+            }
+        }
+
+        // El timeout acota la espera para reintentar el enganche con el backlog
+        if (consumed == 0) {
+            shard.waiter.idle(ready, 50ms);
+        }
+    }
+}
+
+void BookSyncPool::applyInbox(size_t index) {
+    Shard& shard = *_shards[index];
+
+    std::vector<Command> commands;
+    {
+        std::lock_guard<std::mutex> lock(shard.inboxMtx);
+        commands.swap(shard.inbox);
+        shard.inboxPending.store(false, std::memory_order_relaxed);
+    }
+
+    for (const Command& cmd : commands) {
+        if (cmd.target == index) {
+            // Adoptar: el shard anterior ya no lo toca (lo soltó antes de mandarlo)
+            shard.entries.push_back(cmd.entry);
+            cmd.entry->worker->notifyTo(&shard.waiter);
+            cmd.entry->inTransit.store(false, std::memory_order_release);
+        }
+        else {
+            // Soltar: a partir de acá este hilo no vuelve a llamar a poll()
+            auto it = std::find(shard.entries.begin(), shard.entries.end(), cmd.entry);
+            if (it != shard.entries.end()) {
+                shard.entries.erase(it);
+            }
+            post(cmd.target, Command{ cmd.entry, cmd.target });
+        }
+    }
+}
+
+void BookSyncPool::post(size_t index, Command cmd) {
+    Shard& shard = *_shards[index];
+    {
+        std::lock_guard<std::mutex> lock(shard.inboxMtx);
+        shard.inbox.push_back(cmd);
+        shard.inboxPending.store(true, std::memory_order_release);
+    }
+    shard.waiter.notify();
+}
+
+// -----------------------------------------------------------------------------
+// Rebalanceo
+// -----------------------------------------------------------------------------
+
+void BookSyncPool::runRebalancer() {
+    auto last = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(_ctlMtx);
+
+    while (!_ctlCv.wait_for(lock, std::chrono::milliseconds(_config.rebalanceMs), [this] { return !_running; })) {
+        const auto now = std::chrono::steady_clock::now();
+        rebalance(std::chrono::duration<double>(now - last).count());
+        last = now;
+    }
+}
+
+void BookSyncPool::rebalance(double seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+
+    std::vector<double> load(_shards.size(), 0.0);
+    double total = 0.0;
+    for (auto& e : _entries) {
+        const uint64_t consumed = e->consumed.load(std::memory_order_relaxed);
+        e->rate = static_cast<double>(consumed - e->lastConsumed) / seconds;
+        e->lastConsumed = consumed;
+        load[e->shard] += e->rate;
+        total += e->rate;
+    }
+    if (total <= 0.0) {
+        return;
+    }
+    const double average = total / static_cast<double>(_shards.size());
+
+    for (size_t moves = 0; moves < _entries.size(); ++moves) {
+        const size_t hi = static_cast<size_t>(std::max_element(load.begin(), load.end()) - load.begin());
+        const size_t lo = static_cast<size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        if (load[hi] <= average * (1.0 + kMaxImbalance)) {
+            break;
+        }
+
+        // El más caliente de hi que, movido a lo, achica la diferencia
+        Entry* best = nullptr;
+        for (auto& e : _entries) {
+            if (e->shard != hi || e->inTransit.load(std::memory_order_acquire)) continue;
+            if (e->rate < 1.0 || e->rate >= load[hi] - load[lo]) continue;
+            if (!best || e->rate > best->rate) best = e.get();
+        }
+        if (!best) {
+            break;
+        }
+
+        std::cerr << "[SyncPool] " << best->worker->symbol() << ": shard " << hi << " -> " << lo
+            << " (" << static_cast<uint64_t>(best->rate) << " upd/s)\n";
+
+        best->inTransit.store(true, std::memory_order_relaxed);
+        best->shard = lo;
+        --_symbolsPerShard[hi];
+        ++_symbolsPerShard[lo];
+        load[hi] -= best->rate;
+        load[lo] += best->rate;
+        post(hi, Command{ best, lo });
+    }
+}
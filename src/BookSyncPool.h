@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IdleStrategy.h"
+
+class BookSyncWorker;
+
+struct BookSyncPoolConfig {
+    size_t shards = 0;            // --shards=N (0 = según los cores, ver defaultShardCount)
+    bool pin = false;             // --shard-pin: shard i fijo en el core i
+    int64_t rebalanceMs = 10'000; // --rebalance-every=10s (0 = sin rebalanceo)
+    IdleStrategy idle = IdleStrategy::Block;
+};
+
+// Mitad de los cores (el resto queda para sockets, Publisher y writer), al
+// menos 1 y nunca más que símbolos
+size_t defaultShardCount(size_t symbolCount);
+
+// -----------------------------------------------------------------------------
+// BookSyncPool
+// -----------------------------------------------------------------------------
+// N hilos (shards) que mantienen los libros de todos los símbolos: cada shard
+// recorre sus BookSyncWorker llamando a poll() y, cuando ninguno tuvo updates,
+// espera en un IdleWaiter propio al que avisan los depth streams de sus
+// símbolos. La cantidad de hilos depende de los cores, no de los símbolos.
+//
+// Rebalanceo: un hilo de control mide cada rebalanceMs los updates por
+// segundo de cada símbolo. Si el shard más cargado supera en más de 25% el
+// promedio, mueve al menos cargado el símbolo más caliente que achica la
+// diferencia (y repite). Una mudanza es un mensaje al shard de origen: ese
+// shard deja de consumir el símbolo y recién entonces lo pasa al destino, así
+// la cola SPSC nunca tiene dos consumidores.
+//
+// Un resync no bloquea al shard: el snapshot se baja en otro hilo (ver
+// BookSyncWorker).
+//
+// Thread-safety: start/stop desde un único hilo de control; add también
+// desde varios hilos a la vez (arranque en paralelo, ver addAll).
+// -----------------------------------------------------------------------------
+class BookSyncPool {
+public:
+    BookSyncPool(const BookSyncPoolConfig& config, size_t symbolCount);
+    ~BookSyncPool();
+
+    BookSyncPool(const BookSyncPool&) = delete;
+    BookSyncPool& operator=(const BookSyncPool&) = delete;
+
+    // Asigna el worker (ya arrancado con start(false)) al shard con menos
+    // símbolos. Antes o después de start().
+    void add(BookSyncWorker* worker);
+
+    // Arranque en paralelo: hasta parallelism hilos hacen start(false) (WS +
+    // snapshot REST) de los workers y cada uno entra al pool apenas tiene su
+    // snapshot. Retorna cuando todos arrancaron. Con el pool ya en marcha,
+    // los primeros símbolos se mantienen mientras los demás siguen bajando.
+    void addAll(const std::vector<std::unique_ptr<BookSyncWorker>>& workers, size_t parallelism);
+
+    void start();
+
+    // Detiene los shards. Después ningún hilo del pool toca los workers.
+    void stop();
+
+    size_t shardCount() const { return _shards.size(); }
+
+private:
+    struct Entry {
+        BookSyncWorker* worker = nullptr;
+        std::atomic<uint64_t> consumed{ 0 };  // updates aplicados (lo escribe el shard dueño)
+        std::atomic<bool> inTransit{ false }; // mudanza pedida y todavía no adoptada
+        // vista del hilo de control
+        size_t shard = 0;
+        uint64_t lastConsumed = 0;
+        double rate = 0.0;
+    };
+
+    // target == shard que lo recibe: adoptar. Otro: soltarlo y pasarlo a target.
+    struct Command {
+        Entry* entry;
+        size_t target;
+    };
+
+    struct Shard {
+        explicit Shard(IdleStrategy idle) : waiter(idle) {}
+
+        std::thread thr;
+        IdleWaiter waiter;
+        std::vector<Entry*> entries; // solo el hilo del shard
+
+        std::mutex inboxMtx;
+        std::vector<Command> inbox;
+        std::atomic<bool> inboxPending{ false };
+    };
+
+    void runShard(size_t index);
+    void applyInbox(size_t index);
+    void post(size_t index, Command cmd);
+
+    void runRebalancer();
+    void rebalance(double seconds);
+
+    BookSyncPoolConfig _config;
+    std::vector<std::unique_ptr<Shard>> _shards;
+    std::vector<std::unique_ptr<Entry>> _entries;
+    std::vector<size_t> _symbolsPerShard; // para add()
+
+    std::atomic<bool> _running{ false };
+
+    std::thread _rebalancer;
+    std::mutex _ctlMtx;
+    std::condition_variable _ctlCv;
+};
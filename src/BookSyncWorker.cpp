@@ -1,4 +1,7 @@
 ﻿#include "BookSyncWorker.h"
+#include "ShmBookWriter.h"
+#include "LatencyStats.h"
+#include "Journal.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -6,15 +9,23 @@ using namespace std::chrono_literals;
 
 BookSyncWorker::BookSyncWorker(const std::string& normalizedSymbol,
     std::shared_ptr<OrderBook> orderBook,
-    BinanceRestClient* restClient)
+    SnapshotSource* snapshotSource,
+    IdleStrategy idleStrategy,
+    BinanceStreamMux* streamMux,
+    const std::string& wsBaseUrl)
     : _symbol(normalizedSymbol)
     , _orderBook(std::move(orderBook))
-    , _restClient(restClient)
-    , _depthStream(normalizedSymbol)
+    , _snapshotSource(snapshotSource)
+    , _depthStream(normalizedSymbol, _orderBook->scale(), idleStrategy,
+        BinanceDepthStream::kDefaultQueueCapacity, wsBaseUrl)
 {
+    _spareUpdates.reserve(kSpareUpdates);
+    if (streamMux) {
+        _depthStream.attach(*streamMux);
+    }
 }
 
-void BookSyncWorker::start() {
+void BookSyncWorker::start(bool ownThread) {
     if (_isRunning.exchange(true)) {
         // ya estaba corriendo, no lanzar de nuevo
         return;
@@ -26,27 +37,17 @@ void BookSyncWorker::start() {
     //    NO tocamos el libro todavía.
     // ----------------------------------------------------
     _depthStream.start();
+    _asyncResync = true;
 
     // ----------------------------------------------------
     // 2. Ahora pedimos snapshot REST inicial.
     //    Guardamos snapshotLastUpdateId y aplicamos snapshot al OrderBook.
     // ----------------------------------------------------
-    uint64_t snapshotLastUpdateId = 0;
-    bool snapshotLoaded = _restClient->loadInitialBookSnapshot(
-        _symbol,
-        _orderBook,
-        /*limit*/ 10,
-        snapshotLastUpdateId
-    );
-
-    _snapshotLastUpdateId = snapshotLastUpdateId;
-    _lastAppliedUpdateId = 0;
-    _isSynchronized = false;
+    loadInitialSnapshot();
 
-    if (!snapshotLoaded) {
-        std::cerr << "[BookSync] WARNING: no se pudo obtener snapshot inicial para "
-            << _symbol << "\n";
-        // Seguimos igual: el run() va a intentar nuevamente si hacemos resync más adelante.
+    // Con BookSyncPool el paso 3 lo hace un shard compartido
+    if (!ownThread) {
+        return;
     }
 
     // ----------------------------------------------------
@@ -59,20 +60,95 @@ void BookSyncWorker::start() {
     _workerThread = std::thread(&BookSyncWorker::run, this);
 }
 
+void BookSyncWorker::startReplay() {
+    if (_isRunning.exchange(true)) {
+        return;
+    }
+
+    // Mismo orden que en vivo: los frames grabados antes del snapshot se
+    // entregan después (el replay los retiene mientras busca el snapshot)
+    loadInitialSnapshot();
+}
+
+void BookSyncWorker::replayDepthFrame(const char* data, size_t len) {
+    _depthStream.injectFrame(data, len);
+    drainQueue();
+}
+
+void BookSyncWorker::checkpointTo(const std::string& dir, int64_t intervalMs) {
+    _checkpoint = std::make_unique<BookCheckpoint>(dir, _symbol, _orderBook->scale(), _depth);
+    _checkpointInterval = std::chrono::milliseconds(intervalMs);
+}
+
+void BookSyncWorker::loadInitialSnapshot() {
+    uint64_t snapshotLastUpdateId = 0;
+    bool snapshotLoaded = false;
+
+    // Checkpoint de la corrida anterior: hace de snapshot, pero se carga en
+    // el libro gemelo y solo se publica si el stream engancha con su id (A.6).
+    // Si no engancha, la fase A lo descarta y pide el snapshot REST (resync)
+    DepthSnapshot checkpoint;
+    uint64_t savedNs = 0;
+    if (_checkpoint && _checkpoint->restore(checkpoint, savedNs)) {
+        _stagingBook = makeStagingBook();
+        _stagingBook->loadSnapshot(checkpoint);
+        snapshotLastUpdateId = checkpoint.lastUpdateId;
+        snapshotLoaded = true;
+        _checkpointedUpdateId = checkpoint.lastUpdateId;
+        _hookingCheckpoint = true;
+
+        const uint64_t nowNs = journalNowNs();
+        std::cerr << "[BookSync] Checkpoint restaurado para " << _symbol
+            << " (lastUpdateId " << snapshotLastUpdateId << ", hace "
+            << (nowNs > savedNs ? (nowNs - savedNs) / 1'000'000'000 : 0) << " s)\n";
+    }
+    else {
+        snapshotLoaded = _snapshotSource->loadInitialBookSnapshot(
+            _symbol,
+            _orderBook,
+            _depth,
+            snapshotLastUpdateId
+        );
+    }
+
+    _snapshotLastUpdateId = snapshotLastUpdateId;
+    _lastAppliedUpdateId = 0;
+    _isSynchronized = false;
+
+    if (_shm) {
+        _shm->writeBook(_shmSlot, *_orderBook, _snapshotLastUpdateId, /*synced*/ false);
+    }
+
+    if (!snapshotLoaded) {
+        std::cerr << "[BookSync] WARNING: no se pudo obtener snapshot inicial para "
+            << _symbol << "\n";
+        // Seguimos igual: el run() va a intentar nuevamente si hacemos resync más adelante.
+    }
+}
+
 void BookSyncWorker::stop() {
     if (!_isRunning.exchange(false)) {
         // ya estaba detenido
         return;
     }
 
-    // cerramos el stream de depth primero
+    // cerramos el stream de depth primero y despertamos al worker si dormía
     _depthStream.stop();
+    _depthStream.wakeConsumer();
 
     // esperamos el hilo interno
     if (_workerThread.joinable()) {
         _workerThread.join();
     }
 
+    // y la descarga de un resync que haya quedado en curso
+    if (_resyncThread.joinable()) {
+        _resyncThread.join();
+    }
+
+    // Último checkpoint con lo aplicado hasta acá (ya nadie consume el símbolo)
+    maybeCheckpoint(/*force*/ true);
+
     std::cerr << "[BookSync] Worker detenido para " << _symbol << "\n";
 }
 
@@ -81,17 +157,47 @@ void BookSyncWorker::processBatch(std::deque<DepthUpdate>& pendingUpdates) {
     // FASE A: todavía NO estamos sincronizados
     // ========================================================
     if (!_isSynchronized) {
+        // 0) si hay un resync pedido: esperar su snapshot sin bloquear
         // 1) descartar u <= snapshotLastUpdateId
         // 2) encontrar primer bloque con U <= L+1 <= u
         // 3) aplicar desde ahí en adelante con continuidad estricta
 
+        // A.0 El snapshot del resync todavía no llegó: seguir bufferizando
+        collectResync();
+        if (_resyncInFlight) {
+            return;
+        }
+
+        // A.0a Checkpoint descartado y el resync que lo reemplaza falló:
+        //      no hay libro sobre el que enganchar, volver a pedirlo
+        if (_hookingCheckpoint && !_stagingBook) {
+            requestResync();
+            return;
+        }
+
+        // El enganche se hace sobre el libro gemelo si venimos de un resync
+        // (o de un checkpoint)
+        OrderBook& hookBook = _stagingBook ? *_stagingBook : *_orderBook;
+
         const uint64_t requiredFirstUpdate = _snapshotLastUpdateId + 1;
 
+        // A.0b Arrancando desde un checkpoint, el stream nuevo no puede traer
+        //      ids ya aplicados: si los trae, se reinició la numeración (otro
+        //      servidor, mock) y el checkpoint no sirve -> snapshot REST
+        if (_hookingCheckpoint && !pendingUpdates.empty() &&
+            pendingUpdates.front().lastUpdateId <= _snapshotLastUpdateId)
+        {
+            std::cerr << "[BookSync] El stream de " << _symbol
+                << " esta detras del checkpoint -> resync\n";
+            dropCheckpoint();
+            return;
+        }
+
         // A.1 Descartar del frente lo que YA está cubierto por el snapshot REST
         while (!pendingUpdates.empty() &&
             pendingUpdates.front().lastUpdateId <= _snapshotLastUpdateId)
         {
-            pendingUpdates.pop_front();
+            recycleFront(pendingUpdates);
         }
 
         if (pendingUpdates.empty()) {
@@ -102,22 +208,13 @@ void BookSyncWorker::processBatch(std::deque<DepthUpdate>& pendingUpdates) {
         // A.2 Si el backlog ya está ADELANTADO respecto al snapshot,
         //     significa que perdimos el "puente" -> resnapshot inmediato
         if (pendingUpdates.front().firstUpdateId > requiredFirstUpdate) {
-            uint64_t newSnapshotLastUpdateId = 0;
-            bool snapshotReloaded = _restClient->loadInitialBookSnapshot(
-                _symbol,
-                _orderBook,
-                /*limit*/ 10,
-                newSnapshotLastUpdateId
-            );
-
-            if (!snapshotReloaded) {
-                std::cerr << "[BookSync] ERROR: resnapshot fallido en fase A para "
-                    << _symbol << "\n";
+            if (_hookingCheckpoint) {
+                dropCheckpoint(); // el checkpoint quedó viejo (reinicio más largo que el stream)
                 return;
             }
-
-            _snapshotLastUpdateId = newSnapshotLastUpdateId;
-            // NO vaciamos pendingUpdates: intentaremos enganchar con este backlog en la próxima vuelta
+            requestResync();
+            // NO vaciamos pendingUpdates: intentaremos enganchar con este backlog
+            // cuando llegue el snapshot nuevo
             return;
         }
 
@@ -140,7 +237,7 @@ void BookSyncWorker::processBatch(std::deque<DepthUpdate>& pendingUpdates) {
 
         // A.4 Eliminar lo anterior a startIndex (ya no sirve)
         for (size_t i = 0; i < startIndex; ++i) {
-            pendingUpdates.pop_front();
+            recycleFront(pendingUpdates);
         }
 
         // A.5 Aplicar desde el nuevo frente con continuidad estricta,
@@ -174,14 +271,22 @@ void BookSyncWorker::processBatch(std::deque<DepthUpdate>& pendingUpdates) {
                 }
             }
 
-            _orderBook->applyDepthDelta(update);
+            applyUpdate(update, hookBook);
             lastAppliedInThisPass = update.lastUpdateId;
-            pendingUpdates.pop_front(); // consumido
+            recycleFront(pendingUpdates); // consumido
         }
 
-        // A.6 Sincronizado
+        // A.6 Sincronizado. Si enganchamos sobre el gemelo, pasa a ser el
+        //     publicado en una sola sección crítica
+        if (_stagingBook) {
+            _orderBook->swapLevels(*_stagingBook);
+            _stagingBook.reset();
+            std::cerr << "[BookSync] " << (_hookingCheckpoint ? "Checkpoint enganchado" : "Resync completo")
+                << " para " << _symbol << " (lastUpdateId " << lastAppliedInThisPass << ")\n";
+        }
         _lastAppliedUpdateId = lastAppliedInThisPass;
         _isSynchronized = true;
+        _hookingCheckpoint = false;
         return;
     }
 
@@ -201,52 +306,204 @@ void BookSyncWorker::processBatch(std::deque<DepthUpdate>& pendingUpdates) {
                 << ", recibido [" << update.firstUpdateId
                 << "," << update.lastUpdateId << "]) -> resync\n";
 
-            uint64_t newSnapshotLastUpdateId = 0;
-            bool snapshotReloaded = _restClient->loadInitialBookSnapshot(
-                _symbol,
-                _orderBook,
-                /*limit*/ 10,
-                newSnapshotLastUpdateId
-            );
-
-            if (!snapshotReloaded) {
-                std::cerr << "[BookSync] ERROR: no se pudo resincronizar snapshot para "
-                    << _symbol << "\n";
-            }
-
-            _snapshotLastUpdateId = newSnapshotLastUpdateId;
-            _lastAppliedUpdateId = 0;
+            // El libro publicado queda como está hasta que el gemelo enganche
             _isSynchronized = false;
+            requestResync();
 
             // No consumimos este update; dejamos backlog para reenganchar en fase A
             return;
         }
 
         // Continuidad correcta → aplicar y consumir
-        _orderBook->applyDepthDelta(update);
+        applyUpdate(update, *_orderBook);
         _lastAppliedUpdateId = update.lastUpdateId;
-        pendingUpdates.pop_front();
+        recycleFront(pendingUpdates);
     }
 }
 
-void BookSyncWorker::run() {
-    using namespace std::chrono_literals;
+void BookSyncWorker::recycleFront(std::deque<DepthUpdate>& pendingUpdates) {
+    DepthUpdate& front = pendingUpdates.front();
+    if (_spareUpdates.size() < kSpareUpdates) {
+        front.bids.clear();
+        front.asks.clear();
+        _spareUpdates.push_back(std::move(front));
+    }
+    pendingUpdates.pop_front();
+}
 
-    while (_isRunning) {
-        auto newUpdates = _depthStream.drainUpdates();
+void BookSyncWorker::applyUpdate(const DepthUpdate& update, OrderBook& book) {
+    int64_t appliedNs = 0;
+    if (_latency && update.recvNs != 0) {
+        appliedNs = latencyNowNs();
+        _latency->record(LatencyStage::EnqueuedToApplied, appliedNs - update.enqueuedNs);
+    }
+    book.applyDepthDelta(update, appliedNs);
+}
+
+void BookSyncWorker::requestResync() {
+    if (_resyncInFlight) {
+        return; // ya hay uno en curso: el backlog espera ese snapshot
+    }
+    if (std::chrono::steady_clock::now() < _resyncNotBefore) {
+        return; // el anterior falló hace poco
+    }
+
+    // La descarga anterior ya terminó (su resultado se recogió)
+    if (_resyncThread.joinable()) {
+        _resyncThread.join();
+    }
+
+    _resyncInFlight = true;
+
+    auto book = makeStagingBook();
+
+    if (!_asyncResync) {
+        fetchResyncSnapshot(std::move(book));
+        return;
+    }
+
+    std::cerr << "[BookSync] Pidiendo snapshot de resync para " << _symbol << "\n";
+    _resyncThread = std::thread(&BookSyncWorker::fetchResyncSnapshot, this, std::move(book));
+}
+
+std::shared_ptr<OrderBook> BookSyncWorker::makeStagingBook() const {
+    // Libro gemelo vacío: mismo símbolo, escala, motor, tope y profundidad
+    // de barrido que el publicado (swapLevels intercambia las copias de
+    // barrido sin rehacerlas)
+    auto book = std::make_shared<OrderBook>(_symbol, _orderBook->scale(), _orderBook->engine());
+    book->setMaxDepth(_orderBook->maxDepth());
+    book->setSweepDepth(_orderBook->sweepDepth());
+    return book;
+}
+
+void BookSyncWorker::dropCheckpoint() {
+    // Como un resync fallido: el libro del checkpoint nunca llegó a
+    // publicarse, se tira y la fase A espera el snapshot REST
+    _stagingBook.reset();
+    requestResync();
+}
+
+void BookSyncWorker::fetchResyncSnapshot(std::shared_ptr<OrderBook> book) {
+    uint64_t lastUpdateId = 0;
+    _fetchedOk = _snapshotSource->loadInitialBookSnapshot(
+        _symbol,
+        book,
+        _depth,
+        lastUpdateId
+    );
+    _fetchedLastUpdateId = lastUpdateId;
+    _fetchedBook = std::move(book);
+    _resyncReady.store(true, std::memory_order_release);
+
+    // Despertar al que consume este símbolo (hilo propio o shard)
+    _depthStream.notifyConsumer();
+}
+
+bool BookSyncWorker::collectResync() {
+    if (!_resyncInFlight || !_resyncReady.load(std::memory_order_acquire)) {
+        return false;
+    }
+    _resyncReady.store(false, std::memory_order_relaxed);
+    _resyncInFlight = false;
+
+    std::shared_ptr<OrderBook> book = std::move(_fetchedBook);
+    if (!_fetchedOk) {
+        std::cerr << "[BookSync] ERROR: no se pudo resincronizar snapshot para "
+            << _symbol << "\n";
+        // La fase A lo vuelve a pedir pasada la espera
+        _resyncNotBefore = std::chrono::steady_clock::now() + kResyncRetryDelay;
+        return false;
+    }
+
+    _stagingBook = std::move(book);
+    _snapshotLastUpdateId = _fetchedLastUpdateId;
+    _lastAppliedUpdateId = 0;
+    _hookingCheckpoint = false; // el snapshot nuevo reemplaza al checkpoint
+    return true;
+}
+
+size_t BookSyncWorker::applyContiguousFromQueue() {
+    size_t applied = 0;
+
+    while (DepthUpdate* update = _depthStream.frontUpdate()) {
+        // Cualquier cosa que no sea continuidad exacta la resuelve processBatch
+        if (update->firstUpdateId != _lastAppliedUpdateId + 1) {
+            break;
+        }
+
+        applyUpdate(*update, *_orderBook);
+        _lastAppliedUpdateId = update->lastUpdateId;
+        _depthStream.popUpdate(); // el slot vuelve al productor con su capacidad
+        ++applied;
+    }
+
+    return applied;
+}
 
-        // ⬇️ Append al backlog persistente
-        if (!newUpdates.empty()) {
-            _backlog.insert(_backlog.end(),
-                std::make_move_iterator(newUpdates.begin()),
-                std::make_move_iterator(newUpdates.end()));
+size_t BookSyncWorker::drainQueue() {
+    size_t consumed = 0;
+    const bool wasSynchronized = _isSynchronized;
+
+    // Camino rápido: sincronizados y sin backlog -> aplicar en el lugar
+    if (_isSynchronized && _backlog.empty()) {
+        consumed += applyContiguousFromQueue();
+    }
+
+    // Camino lento: lo que quede (gap, fase de enganche) pasa al backlog
+    while (DepthUpdate* update = _depthStream.frontUpdate()) {
+        // El backlog se queda con el contenido y el slot con los vectores de
+        // un update reciclado, que vuelven calientes al productor
+        _backlog.emplace_back();
+        if (!_spareUpdates.empty()) {
+            _backlog.back() = std::move(_spareUpdates.back());
+            _spareUpdates.pop_back();
         }
+        std::swap(_backlog.back(), *update);
+        _depthStream.popUpdate();
+        ++consumed;
+    }
 
-        if (!_backlog.empty()) {
-            processBatch(_backlog); // ahora processBatch trabaja SOBRE el backlog
-        }        
+    if (!_backlog.empty()) {
+        processBatch(_backlog); // processBatch trabaja SOBRE el backlog
+    }
+
+    // Memoria compartida: una escritura por pasada, con todo lo aplicado
+    // (o si cambió el estado de enganche: gap o libro gemelo recién publicado)
+    if (_shm && (consumed > 0 || wasSynchronized != _isSynchronized)) {
+        _shm->writeBook(_shmSlot, *_orderBook, _lastAppliedUpdateId, _isSynchronized);
+    }
 
-        // Pequeño sleep para no quemar CPU (20ms ~ 50Hz)
-        std::this_thread::sleep_for(20ms);
+    if (_checkpoint) {
+        maybeCheckpoint();
+    }
+
+    return consumed;
+}
+
+void BookSyncWorker::maybeCheckpoint(bool force) {
+    // Solo libros enganchados y con algo nuevo desde el último
+    if (!_checkpoint || !_isSynchronized || _lastAppliedUpdateId == _checkpointedUpdateId) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && now < _nextCheckpoint) {
+        return;
+    }
+
+    _checkpoint->write(*_orderBook, _lastAppliedUpdateId);
+    _checkpointedUpdateId = _lastAppliedUpdateId;
+    _nextCheckpoint = now + _checkpointInterval;
+}
+
+void BookSyncWorker::run() {
+    using namespace std::chrono_literals;
+
+    while (_isRunning) {
+        // Sin updates nuevos: esperar según la estrategia configurada. El
+        // timeout acota la espera para reintentar el enganche con el backlog
+        // (y para recoger el snapshot de un resync aunque no lleguen updates).
+        if (drainQueue() == 0) {
+            _depthStream.waitForUpdates(_isRunning, 50ms);
+        }
     }
 }
@@ -3,12 +3,18 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <deque>
 #include <cstdint>
 
 #include "OrderBook.h"
-#include "BinanceRestClient.h"
+#include "SnapshotSource.h"
 #include "BinanceDepthStream.h"
+#include "IdleStrategy.h"
+#include "BookCheckpoint.h"
+
+class ShmBookWriter;
+struct SymbolLatency;
 
 // BookSyncWorker
 //
@@ -16,36 +22,134 @@
 // - Mantener un OrderBook sincronizado en tiempo real para un smbolo.
 // - Flujo correcto Binance:
 //   1. Abrir el WS de profundidad (<symbol>@depth@500ms) y empezar a bufferizar updates.
-//   2. Bajar snapshot inicial va REST (depth limit=10), guardar lastUpdateId.
+//   2. Bajar snapshot inicial va REST (depth limit=setDepth, 10 por defecto), guardar lastUpdateId.
 //   3. Reproducir desde el buffer hasta enganchar con el snapshot:
 //        Buscar el primer update cuyo rango [U,u] cubra snapshotLastUpdateId+1,
 //        aplicar en orden verificando continuidad.
 //   4. A partir de ah aplicar incrementales asegurando continuidad estricta.
 //   5. Si hay gap -> resync: volver a bajar snapshot y marcar _isSynchronized=false.
+//
+// Resync asncrono:
+// - El snapshot del resync se baja en un hilo aparte (_resyncThread) y se
+//   carga en un libro gemelo (_stagingBook), no en el publicado. Mientras
+//   tanto el worker sigue bufferizando en el backlog sin esperar la red.
+// - La fase A engancha el backlog sobre el libro gemelo; al quedar alineado
+//   se intercambia con el publicado (OrderBook::swapLevels) de una vez. Los
+//   lectores nunca ven un libro vaco ni a medio cargar, solo el viejo
+//   (desactualizado, con synced=false en memoria compartida) hasta el cambio.
+// - En replay el snapshot se carga en el hilo llamador (el journal no se
+//   puede leer desde dos hilos), pero igual sobre el libro gemelo.
+//
+// Checkpoints (checkpointTo):
+// - Cada cierto intervalo, y al detenerse, el worker copia el libro
+//   sincronizado y _lastAppliedUpdateId a un archivo mapeado (BookCheckpoint).
+// - Al arrancar, si hay checkpoint se carga en lugar del snapshot REST y su
+//   id hace de snapshotLastUpdateId: si el primer update del WS todava
+//   engancha (U <= id+1 <= u) el libro sigue sin pedir nada a REST; si no, la
+//   fase A ve el backlog adelantado y cae al resync normal.
 // 
 // Threading:
 // - start() lanza el WS, baja snapshot y despus crea el thread interno (_workerThread).
-// - run() drena updates en loop y mantiene el libro vivo.
+// - run() consume updates de la cola SPSC del depth stream y mantiene el libro
+//   vivo. Cuando no hay updates espera segn la IdleStrategy (busy/yield/block)
+//   en lugar de dormir un tiempo fijo.
+// - start(/*ownThread*/ false): sin hilo propio; un shard de BookSyncPool
+//   llama a poll() junto con los dems smbolos que tiene asignados.
 // - stop() apaga todo limpio.
+// - Replay (startReplay/replayDepthFrame): sin WS ni hilo propio; el que
+//   reproduce el journal entrega cada frame y el worker lo procesa en el acto.
 //
 class BookSyncWorker {
 public:
+    // streamMux (opcional): si se indica, el depth stream se suscribe al
+    // multiplexor compartido en lugar de abrir su propio WebSocket.
+    // wsBaseUrl: servidor del depth stream propio (ej: mock local).
     BookSyncWorker(const std::string& normalizedSymbol,
         std::shared_ptr<OrderBook> orderBook,
-        BinanceRestClient* restClient);
+        SnapshotSource* snapshotSource,
+        IdleStrategy idleStrategy = IdleStrategy::Block,
+        BinanceStreamMux* streamMux = nullptr,
+        const std::string& wsBaseUrl = kBinanceWsBaseUrl);
 
-    // Inicia el proceso de sync (WS primero, luego snapshot REST, luego loop interno)
-    void start();
+    // Inicia el proceso de sync (WS primero, luego snapshot REST, luego loop interno).
+    // ownThread = false: no lanza el loop; lo maneja un BookSyncPool con poll().
+    void start(bool ownThread = true);
 
     // Detiene el loop y cierra el WS
     void stop();
 
+    // Graba los depth frames recibidos en el journal. Llamar antes de start().
+    void recordTo(JournalWriter* journal) { _depthStream.recordTo(journal); }
+
+    // Publica el libro en el slot del segmento compartido despus de cada
+    // pasada que aplic updates. Llamar antes de start().
+    void publishTo(ShmBookWriter* shm, uint32_t slot) { _shm = shm; _shmSlot = slot; }
+
+    // Mide las etapas del depth stream y la espera en cola hasta aplicar
+    // cada update (ver LatencyStats). Llamar antes de start().
+    void measureTo(SymbolLatency* latency) { _latency = latency; _depthStream.measureTo(latency); }
+
+    // Niveles por lado de cada snapshot (limit de /api/v3/depth, hasta 5000)
+    // y tope del libro (OrderBook::setMaxDepth). Llamar antes de start().
+    void setDepth(int levels) {
+        _depth = levels;
+        _orderBook->setMaxDepth(static_cast<size_t>(levels));
+    }
+
+    // Guarda un checkpoint del libro en <dir>/<symbol>.ckpt cada intervalMs
+    // (y al detenerse) y arranca desde l si sigue enganchando con el stream.
+    // Usa la profundidad de setDepth: llamar despus de setDepth y antes de
+    // start(). Lanza std::runtime_error si no puede abrir el archivo.
+    void checkpointTo(const std::string& dir, int64_t intervalMs);
+
+    // Modo replay: carga el snapshot inicial desde el SnapshotSource pero no
+    // abre el WS ni lanza el hilo interno.
+    void startReplay();
+
+    // Modo replay: entrega un depth frame grabado y lo procesa en el hilo llamador.
+    void replayDepthFrame(const char* data, size_t len);
+
+    // ---- BookSyncPool (start(false)) -----------------------------------------
+
+    // Una pasada del loop. Solo desde el shard que tiene asignado el smbolo.
+    // Retorna la cantidad de updates consumidos.
+    size_t poll() { return drainQueue(); }
+
+    // Hay updates esperando en la cola o un snapshot de resync por recoger
+    // (desde cualquier hilo)
+    bool hasPendingUpdates() const {
+        return _depthStream.hasUpdates() || _resyncReady.load(std::memory_order_acquire);
+    }
+
+    // A quin despierta el depth stream cuando encola (el waiter del shard)
+    void notifyTo(IdleWaiter* waiter) { _depthStream.notifyTo(waiter); }
+
+    const std::string& symbol() const { return _symbol; }
+
+    // El libro est enganchado con el stream (desde cualquier hilo)
+    bool isSynchronized() const { return _isSynchronized; }
+
 private:
+    // Benchmarks (bench/BookBench.cpp): acceso a processBatch y al estado de enganche
+    friend struct BookSyncWorkerBench;
+
     // Hilo principal del worker que:
-    // - drena updates del WebSocket
+    // - consume updates del WebSocket (en el lugar si ya estamos sincronizados)
     // - intenta sincronizar / mantener continuidad
     void run();
 
+    // Paso 2 del flujo: snapshot inicial y reseteo del estado de enganche.
+    void loadInitialSnapshot();
+
+    // Una pasada del loop: consume lo que haya en la cola y procesa el backlog.
+    // Retorna la cantidad de updates consumidos de la cola.
+    size_t drainQueue();
+
+    // Camino rpido: ya sincronizados y sin backlog, aplica los updates
+    // contiguos directamente desde la cola SPSC, sin moverlos.
+    // Retorna la cantidad de updates aplicados.
+    size_t applyContiguousFromQueue();
+
     // Procesa un batch de DepthUpdate:
     // - Si no estamos sincronizados an (_isSynchronized == false):
     //     * descartar updates viejos (u <= snapshotLastUpdateId)
@@ -55,9 +159,42 @@ private:
     //
     // - Si ya estamos sincronizados:
     //     * exigir continuidad exacta con _lastAppliedUpdateId+1
-    //     * si hay gap -> resync (nuevo snapshot REST, marcar _isSynchronized=false)
+    //     * si hay gap -> resync (requestResync, marcar _isSynchronized=false)
     void processBatch(std::deque<DepthUpdate>& pendingUpdates);
 
+    // Aplica un update a book (el publicado o el gemelo del resync) y
+    // registra enqueued->applied si se mide
+    void applyUpdate(const DepthUpdate& update, OrderBook& book);
+
+    // Escribe el checkpoint si hay updates nuevos y ya venci el intervalo
+    // (force: sin mirar el intervalo, al detenerse)
+    void maybeCheckpoint(bool force = false);
+
+    // Saca el primer update del backlog guardando sus vectores en
+    // _spareUpdates para el prximo que entre (reemplaza a pop_front)
+    void recycleFront(std::deque<DepthUpdate>& pendingUpdates);
+
+    // Pide un snapshot nuevo para resincronizar (no-op si ya hay uno en
+    // curso o si todava no venci la espera tras un fallo). En vivo lanza
+    // _resyncThread y retorna en el acto; en replay lo carga ac mismo.
+    void requestResync();
+
+    // Libro vaco con la configuracin del publicado, para enganchar un
+    // snapshot de resync o un checkpoint sin tocar lo que se publica
+    std::shared_ptr<OrderBook> makeStagingBook() const;
+
+    // El checkpoint no engancha con el stream: lo descarta sin haberlo
+    // publicado y pide el snapshot REST
+    void dropCheckpoint();
+
+    // Cuerpo de _resyncThread: carga el snapshot en book (un libro gemelo
+    // vaco) y lo deja listo para collectResync().
+    void fetchResyncSnapshot(std::shared_ptr<OrderBook> book);
+
+    // Desde el hilo del worker: si el snapshot pedido ya lleg, lo toma como
+    // _stagingBook y reinicia el enganche. Retorna true si hay libro nuevo.
+    bool collectResync();
+
 private:
     // Smbolo en minsculas (ej "btcusdt")
     std::string _symbol;
@@ -65,8 +202,11 @@ private:
     // Libro de rdenes L2 asociado a este smbolo
     std::shared_ptr<OrderBook> _orderBook;
 
-    // Cliente REST para snapshot/resync
-    BinanceRestClient* _restClient;
+    // Origen de snapshots para sync/resync (REST en vivo o journal en replay)
+    SnapshotSource* _snapshotSource;
+
+    // limit de cada snapshot (ver setDepth)
+    int _depth = 10;
 
     // Stream WS de profundidad (depth updates @500ms)
     BinanceDepthStream _depthStream;
@@ -86,6 +226,56 @@ private:
     // ltimo lastUpdateId que aplicamos con xito sobre el libro
     uint64_t _lastAppliedUpdateId = 0;
 
-    // Backlog persistente de updates del WS (no se pierde entre iteraciones)
+    // Backlog persistente de updates del WS (no se pierde entre iteraciones).
+    // Solo se usa mientras no estamos sincronizados (camino lento).
     std::deque<DepthUpdate> _backlog;
+
+    // Updates vacos con capacidad, devueltos por el backlog. Al pasar un
+    // update de la cola al backlog se intercambia con uno de estos: el slot
+    // conserva buffers calientes y el backlog no reserva memoria en cada gap.
+    static constexpr size_t kSpareUpdates = 256;
+    std::vector<DepthUpdate> _spareUpdates;
+
+    // ---- Resync asncrono ----------------------------------------------------
+    // Espera mnima antes de volver a pedir un snapshot que fall
+    static constexpr std::chrono::milliseconds kResyncRetryDelay{ 1000 };
+
+    // false hasta start(): replay y benchmarks cargan el snapshot en el acto
+    bool _asyncResync = false;
+
+    // Hay un snapshot pedido que todava no se recogi (solo hilo del worker)
+    bool _resyncInFlight = false;
+    std::chrono::steady_clock::time_point _resyncNotBefore{};
+
+    // Hilo de la ltima descarga (se une antes de lanzar otra y en stop())
+    std::thread _resyncThread;
+
+    // Resultado de la descarga: lo escribe _resyncThread y lo publica con
+    // _resyncReady (release); el worker lo lee despus de verlo en true
+    std::shared_ptr<OrderBook> _fetchedBook;
+    uint64_t _fetchedLastUpdateId = 0;
+    bool _fetchedOk = false;
+    std::atomic<bool> _resyncReady{ false };
+
+    // Libro gemelo donde la fase A engancha el snapshot del resync o el
+    // checkpoint restaurado (nullptr = enganchar sobre _orderBook, como en
+    // el snapshot inicial)
+    std::shared_ptr<OrderBook> _stagingBook;
+
+    // Memoria compartida (nullptr = no se publica) y slot del smbolo
+    ShmBookWriter* _shm = nullptr;
+    uint32_t _shmSlot = 0;
+
+    // Histogramas del smbolo (nullptr = sin medir)
+    SymbolLatency* _latency = nullptr;
+
+    // Checkpoint en disco (nullptr = sin checkpoints). Solo lo toca el hilo
+    // que consume el smbolo (y start/stop).
+    std::unique_ptr<BookCheckpoint> _checkpoint;
+    std::chrono::milliseconds _checkpointInterval{ 0 };
+    std::chrono::steady_clock::time_point _nextCheckpoint{};
+    uint64_t _checkpointedUpdateId = 0;
+
+    // El libro arranc desde el checkpoint y todava no enganch
+    bool _hookingCheckpoint = false;
 };
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+// Representación en punto fijo de precios y cantidades
+// -----------------------------------------------------------------------------
+// Binance envía precios y cantidades como strings decimales ("109579.99000000").
+// En lugar de convertirlos a double, los guardamos como enteros de 64 bits en
+// unidades de 10^-decimals: con priceDecimals = 2, "109579.99" -> 10957999.
+//
+// - Las claves del libro comparan como enteros (sin niveles "fantasma" por
+//   doubles casi iguales).
+// - qty == 0 es exacto: no depende del redondeo de std::stod.
+// - La conversión a decimal se hace solo al publicar (Publisher).
+// -----------------------------------------------------------------------------
+
+using Price = int64_t; // precio en unidades de 10^-priceDecimals
+using Qty = int64_t;   // cantidad en unidades de 10^-qtyDecimals
+
+// Potencias de 10 que entran en un int64 (10^0 .. 10^18)
+inline int64_t pow10i(int exp) {
+    static const int64_t table[19] = {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+        100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+        1000000000000LL, 10000000000000LL, 100000000000000LL,
+        1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+        1000000000000000000LL
+    };
+    return (exp >= 0 && exp <= 18) ? table[exp] : 0;
+}
+
+// -----------------------------------------------------------------------------
+// SymbolScale
+// -----------------------------------------------------------------------------
+// Escala de precio/cantidad de un símbolo. Se deriva del tickSize (PRICE_FILTER)
+// y del stepSize (LOT_SIZE) de exchangeInfo: "0.01000000" -> 2 decimales.
+//
+// Por defecto usamos 8 decimales, que es la precisión máxima con la que Binance
+// publica precios y cantidades en Spot, así que la conversión siempre es exacta.
+// -----------------------------------------------------------------------------
+struct SymbolScale {
+    int priceDecimals = 8;
+    int qtyDecimals = 8;
+    Price tickSize = 0;   // tickSize en unidades de precio (0 = desconocido)
+
+    double priceToDouble(double ticks) const { return ticks / static_cast<double>(pow10i(priceDecimals)); }
+    double qtyToDouble(double lots) const { return lots / static_cast<double>(pow10i(qtyDecimals)); }
+};
+
+// -----------------------------------------------------------------------------
+// parseFixed
+// -----------------------------------------------------------------------------
+// Convierte un decimal ASCII [first, last) ("123.4500") a entero en unidades de
+// 10^-decimals, sin reservar memoria. Si el string trae más decimales que la
+// escala, redondea al más cercano.
+//
+// Retorna false si el texto no es un decimal válido o si no entra en int64.
+// -----------------------------------------------------------------------------
+inline bool parseFixed(const char* first, const char* last, int decimals, int64_t& out) {
+    if (first == last || decimals < 0 || decimals > 18) return false;
+
+    bool negative = false;
+    if (*first == '-') {
+        negative = true;
+        ++first;
+    }
+
+    uint64_t value = 0;
+    int digits = 0;      // dígitos significativos acumulados
+    int fracDigits = -1; // -1 = todavía no vimos el punto
+    bool roundUp = false;
+    bool any = false;
+
+    for (const char* p = first; p != last; ++p) {
+        char c = *p;
+        if (c == '.') {
+            if (fracDigits >= 0) return false;
+            fracDigits = 0;
+            continue;
+        }
+        if (c < '0' || c > '9') return false;
+        any = true;
+
+        if (fracDigits >= 0) {
+            if (fracDigits >= decimals) {
+                // dígitos que no entran en la escala: el primero decide el redondeo
+                if (fracDigits == decimals && c >= '5') roundUp = true;
+                ++fracDigits;
+                continue;
+            }
+            ++fracDigits;
+        }
+
+        if (value != 0 || c != '0') {
+            if (++digits > 18) return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (!any) return false;
+
+    int used = fracDigits < 0 ? 0 : (fracDigits > decimals ? decimals : fracDigits);
+    for (int i = used; i < decimals; ++i) {
+        if (value > 922337203685477580ULL) return false;
+        value *= 10;
+    }
+    if (roundUp) ++value;
+    if (value > static_cast<uint64_t>(INT64_MAX)) return false;
+
+    out = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    return true;
+}
+
+// Variante que lanza std::invalid_argument (mismo contrato que std::stod).
+inline int64_t parseFixed(const std::string& text, int decimals) {
+    int64_t out = 0;
+    if (!parseFixed(text.data(), text.data() + text.size(), decimals, out)) {
+        throw std::invalid_argument("decimal invalido: " + text);
+    }
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// decimalsFromStep
+// -----------------------------------------------------------------------------
+// Cantidad de decimales significativos de un tickSize/stepSize:
+//   "0.01000000" -> 2, "1.00000000" -> 0, "0.00001000" -> 5, "0.05" -> 2.
+// -----------------------------------------------------------------------------
+inline int decimalsFromStep(const std::string& step) {
+    auto dot = step.find('.');
+    if (dot == std::string::npos) return 0;
+    auto lastNonZero = step.find_last_not_of('0');
+    if (lastNonZero == std::string::npos || lastNonZero <= dot) return 0;
+    return static_cast<int>(lastNonZero - dot);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+// IdleStrategy
+// -----------------------------------------------------------------------------
+// Qué hace un hilo consumidor cuando no tiene trabajo:
+//   - BusyPoll: vuelve enseguida (el loop gira sin parar, mínima latencia,
+//               un core al 100%).
+//   - Yield:    cede el core con std::this_thread::yield().
+//   - Block:    gira un rato y después se duerme en una condition_variable
+//               hasta que el productor avise (notify) o venza el timeout.
+// -----------------------------------------------------------------------------
+enum class IdleStrategy {
+    BusyPoll,
+    Yield,
+    Block
+};
+
+// "busy" / "yield" / "block" -> IdleStrategy. Lanza std::runtime_error si no se reconoce.
+inline IdleStrategy parseIdleStrategy(const std::string& name) {
+    if (name == "busy") return IdleStrategy::BusyPoll;
+    if (name == "yield") return IdleStrategy::Yield;
+    if (name == "block") return IdleStrategy::Block;
+    throw std::runtime_error("Estrategia de espera desconocida: " + name + " (usar busy|yield|block)");
+}
+
+// -----------------------------------------------------------------------------
+// IdleWaiter
+// -----------------------------------------------------------------------------
+// Punto de encuentro entre un productor y un consumidor con la estrategia
+// elegida. Con Block, el productor solo toma el mutex cuando el consumidor
+// está efectivamente dormido, así que en régimen el camino caliente no hace
+// syscalls.
+//
+// Ejemplo (consumidor):
+//   waiter.idle([&] { return !ring.empty(); }, 100ms);
+// Ejemplo (productor, después de publicar):
+//   waiter.notify();
+// -----------------------------------------------------------------------------
+class IdleWaiter {
+public:
+    explicit IdleWaiter(IdleStrategy strategy = IdleStrategy::Block)
+        : _strategy(strategy)
+    {
+    }
+
+    IdleStrategy strategy() const { return _strategy; }
+
+    // Espera hasta que ready() sea true o pase timeout (según la estrategia).
+    template <class Ready>
+    void idle(Ready ready, std::chrono::milliseconds timeout) {
+        switch (_strategy) {
+        case IdleStrategy::BusyPoll:
+            return;
+
+        case IdleStrategy::Yield:
+            std::this_thread::yield();
+            return;
+
+        case IdleStrategy::Block:
+        default:
+            break;
+        }
+
+        // Spin corto antes de dormir: si el próximo mensaje está por llegar
+        // nos ahorramos el par wait/notify.
+        for (int i = 0; i < kSpinsBeforePark; ++i) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(_mtx);
+        _parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        _cv.wait_for(lock, timeout, [&] { return ready(); });
+        _parked.store(false, std::memory_order_relaxed);
+    }
+
+    // Avisar al consumidor que hay trabajo (barato si no está dormido).
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_parked.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _cv.notify_one();
+        }
+    }
+
+    // Despertar incondicional (por ejemplo al detener el consumidor).
+    void wakeAll() {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _cv.notify_all();
+    }
+
+private:
+    static constexpr int kSpinsBeforePark = 64;
+
+    IdleStrategy _strategy;
+    std::atomic<bool> _parked{ false };
+    std::mutex _mtx;
+    std::condition_variable _cv;
+};
@@ -0,0 +1,152 @@
+#include "Journal.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kMagic[4] = { 'B', 'O', 'B', 'J' };
+constexpr uint32_t kVersion = 1;
+constexpr size_t kRecordHeaderSize = 1 + 2 + 4 + 8;
+constexpr size_t kFileBufferSize = 1 << 20;
+
+template <class T>
+void putLE(char* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+}
+
+template <class T>
+T getLE(const char* in) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return static_cast<T>(v);
+}
+
+} // namespace
+
+uint64_t journalNowNs() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(
+        duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+// -----------------------------------------------------------------------------
+// JournalWriter
+// -----------------------------------------------------------------------------
+
+JournalWriter::JournalWriter(const std::string& path)
+    : _buffer(kFileBufferSize)
+{
+    _file.rdbuf()->pubsetbuf(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    _file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!_file) {
+        throw std::runtime_error("No se pudo crear el journal: " + path);
+    }
+
+    char header[8];
+    std::memcpy(header, kMagic, 4);
+    putLE<uint32_t>(header + 4, kVersion);
+    _file.write(header, sizeof(header));
+}
+
+JournalWriter::~JournalWriter() {
+    flush();
+}
+
+uint16_t JournalWriter::streamId(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    auto it = _ids.find(name);
+    if (it != _ids.end()) {
+        return it->second;
+    }
+
+    uint16_t id = static_cast<uint16_t>(_ids.size());
+    _ids.emplace(name, id);
+    writeRecordLocked(JournalRecordType::StreamDef, id, journalNowNs(), name.data(), name.size());
+    return id;
+}
+
+void JournalWriter::append(JournalRecordType type, uint16_t streamId, const char* data, size_t len) {
+    const uint64_t now = journalNowNs();
+    std::lock_guard<std::mutex> lock(_mtx);
+    writeRecordLocked(type, streamId, now, data, len);
+}
+
+void JournalWriter::flush() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _file.flush();
+}
+
+void JournalWriter::writeRecordLocked(JournalRecordType type, uint16_t streamId,
+    uint64_t recvTimeNs, const char* data, size_t len)
+{
+    char header[kRecordHeaderSize];
+    header[0] = static_cast<char>(type);
+    putLE<uint16_t>(header + 1, streamId);
+    putLE<uint32_t>(header + 3, static_cast<uint32_t>(len));
+    putLE<uint64_t>(header + 7, recvTimeNs);
+
+    _file.write(header, sizeof(header));
+    _file.write(data, static_cast<std::streamsize>(len));
+}
+
+// -----------------------------------------------------------------------------
+// JournalReader
+// -----------------------------------------------------------------------------
+
+JournalReader::JournalReader(const std::string& path)
+    : _buffer(kFileBufferSize)
+{
+    _file.rdbuf()->pubsetbuf(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    _file.open(path, std::ios::in | std::ios::binary);
+    if (!_file) {
+        throw std::runtime_error("No se pudo abrir el journal: " + path);
+    }
+
+    char header[8];
+    if (!_file.read(header, sizeof(header)) ||
+        std::memcmp(header, kMagic, 4) != 0 ||
+        getLE<uint32_t>(header + 4) != kVersion)
+    {
+        throw std::runtime_error("Journal invalido o de otra version: " + path);
+    }
+}
+
+bool JournalReader::next(JournalRecord& out) {
+    while (true) {
+        char header[kRecordHeaderSize];
+        if (!_file.read(header, sizeof(header))) {
+            return false;
+        }
+
+        out.type = static_cast<JournalRecordType>(static_cast<unsigned char>(header[0]));
+        out.streamId = getLE<uint16_t>(header + 1);
+        const uint32_t len = getLE<uint32_t>(header + 3);
+        out.recvTimeNs = getLE<uint64_t>(header + 7);
+
+        out.payload.resize(len);
+        if (len > 0 && !_file.read(&out.payload[0], len)) {
+            return false; // registro truncado (captura cortada)
+        }
+
+        if (out.type == JournalRecordType::StreamDef) {
+            if (_names.size() <= out.streamId) {
+                _names.resize(static_cast<size_t>(out.streamId) + 1);
+            }
+            _names[out.streamId] = out.payload;
+            continue;
+        }
+        return true;
+    }
+}
+
+const std::string& JournalReader::streamName(uint16_t id) const {
+    static const std::string empty;
+    return id < _names.size() ? _names[id] : empty;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Journal de captura de market data
+// -----------------------------------------------------------------------------
+// Archivo binario append-only con los frames crudos tal como llegaron:
+// depth updates, trades y los bodies de los snapshots REST. Sirve para
+// reproducir una sesión sin red (ver JournalReplay).
+//
+// Formato (little-endian):
+//   Cabecera:  "BOBJ" (4 bytes) | version u32
+//   Registro:  type u8 | streamId u16 | length u32 | recvTimeNs u64 | payload[length]
+//
+// Los streamId se definen dentro del mismo archivo con registros StreamDef
+// (payload = nombre, ej "btcusdt@depth"), antes del primer uso.
+// recvTimeNs es el momento de recepción en epoch (system_clock), en ns.
+// -----------------------------------------------------------------------------
+
+enum class JournalRecordType : uint8_t {
+    StreamDef = 0,    // define streamId -> nombre
+    DepthFrame = 1,   // payload de un depthUpdate (WS)
+    TradeFrame = 2,   // payload de un trade (WS)
+    SnapshotBody = 3  // body JSON de GET /api/v3/depth
+};
+
+struct JournalRecord {
+    JournalRecordType type = JournalRecordType::StreamDef;
+    uint16_t streamId = 0;
+    uint64_t recvTimeNs = 0;
+    std::string payload; // se reutiliza entre lecturas
+};
+
+// Epoch actual en nanosegundos (system_clock)
+uint64_t journalNowNs();
+
+// -----------------------------------------------------------------------------
+// JournalWriter
+// -----------------------------------------------------------------------------
+// Thread-safe: lo comparten los hilos de WebSocket y los workers (REST).
+// Lanza std::runtime_error si no puede abrir el archivo.
+// -----------------------------------------------------------------------------
+class JournalWriter {
+public:
+    explicit JournalWriter(const std::string& path);
+    ~JournalWriter();
+
+    // Id del stream (lo define en el archivo la primera vez que se pide)
+    uint16_t streamId(const std::string& name);
+
+    // Agrega un registro con timestamp de recepción = ahora
+    void append(JournalRecordType type, uint16_t streamId, const char* data, size_t len);
+
+    void flush();
+
+private:
+    void writeRecordLocked(JournalRecordType type, uint16_t streamId,
+        uint64_t recvTimeNs, const char* data, size_t len);
+
+    std::mutex _mtx;
+    std::ofstream _file;
+    std::vector<char> _buffer; // buffer grande para el ofstream
+    std::unordered_map<std::string, uint16_t> _ids;
+};
+
+// -----------------------------------------------------------------------------
+// JournalReader
+// -----------------------------------------------------------------------------
+// Lectura secuencial. next() saltea los StreamDef (los registra internamente)
+// y devuelve false al llegar al final o ante un registro truncado.
+// Lanza std::runtime_error si el archivo no existe o la cabecera no es válida.
+// -----------------------------------------------------------------------------
+class JournalReader {
+public:
+    explicit JournalReader(const std::string& path);
+
+    bool next(JournalRecord& out);
+
+    // Nombre de un streamId ya definido ("" si no existe)
+    const std::string& streamName(uint16_t id) const;
+
+private:
+    std::ifstream _file;
+    std::vector<char> _buffer;
+    std::vector<std::string> _names;
+};
@@ -0,0 +1,160 @@
+#include "JournalReplay.h"
+#include "BookSyncWorker.h"
+#include "BinanceTradeStream.h"
+#include "BinanceRestClient.h"
+
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t kNsPerSec = 1'000'000'000ULL;
+
+// Tope de registros retenidos al buscar un snapshot hacia adelante; si un
+// símbolo no vuelve a tener snapshot no queremos cargar todo el journal.
+constexpr size_t kMaxLookahead = 100'000;
+
+} // namespace
+
+JournalReplay::JournalReplay(const std::string& path, double speed)
+    : _reader(path)
+    , _speed(speed)
+{
+}
+
+void JournalReplay::addSymbol(const std::string& symbolLower,
+    BookSyncWorker* worker,
+    BinanceTradeStream* trades)
+{
+    _targets[symbolLower] = Target{ worker, trades };
+}
+
+bool JournalReplay::loadInitialBookSnapshot(const std::string& symbolLowerCase,
+    std::shared_ptr<OrderBook> orderBook,
+    int /*limit*/,
+    uint64_t& outLastUpdateId)
+{
+    auto isSnapshotFor = [&](const JournalRecord& rec) {
+        return rec.type == JournalRecordType::SnapshotBody &&
+            symbolOf(rec.streamId) == symbolLowerCase;
+    };
+
+    // 1. Un snapshot ya leído por adelantado (lo buscó otro símbolo)
+    auto it = std::find_if(_lookahead.begin(), _lookahead.end(), isSnapshotFor);
+    if (it != _lookahead.end()) {
+        std::string body = std::move(it->payload);
+        _lookahead.erase(it);
+        return BinanceRestClient::applySnapshotBody(body, symbolLowerCase, *orderBook, outLastUpdateId);
+    }
+
+    // 2. Leer hacia adelante reteniendo todo lo demás para entregarlo en orden
+    JournalRecord rec;
+    while (_lookahead.size() < kMaxLookahead && _reader.next(rec)) {
+        if (isSnapshotFor(rec)) {
+            return BinanceRestClient::applySnapshotBody(rec.payload, symbolLowerCase, *orderBook, outLastUpdateId);
+        }
+        _lookahead.push_back(std::move(rec));
+        rec = JournalRecord{};
+    }
+
+    std::cerr << "[Replay] No hay mas snapshots grabados para " << symbolLowerCase << "\n";
+    return false;
+}
+
+void JournalReplay::run(const std::atomic<bool>& running, const TickHandler& onTick) {
+    using Clock = std::chrono::steady_clock;
+
+    JournalRecord rec;
+    bool first = true;
+    uint64_t firstNs = 0;
+    uint64_t nextTickNs = 0;
+    Clock::time_point wallStart;
+    uint64_t replayed = 0;
+
+    while (running && nextRecord(rec)) {
+        if (first) {
+            first = false;
+            firstNs = rec.recvTimeNs;
+            nextTickNs = firstNs + kNsPerSec;
+            wallStart = Clock::now();
+        }
+
+        // Ritmo grabado: esperar al offset del registro (escalado por speed),
+        // de a tramos cortos para poder cortar con Ctrl+C
+        if (_speed > 0.0 && rec.recvTimeNs > firstNs) {
+            const auto due = wallStart + std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(rec.recvTimeNs - firstNs) / _speed));
+            while (running) {
+                const auto now = Clock::now();
+                if (now >= due) break;
+                std::this_thread::sleep_for(std::min<Clock::duration>(due - now, std::chrono::milliseconds(100)));
+            }
+        }
+
+        // Publicación con el reloj grabado: todo lo anterior a cada segundo
+        // ya está aplicado cuando se emite ese tick
+        while (rec.recvTimeNs >= nextTickNs) {
+            if (onTick) {
+                onTick(static_cast<double>(nextTickNs) / kNsPerSec);
+            }
+            nextTickNs += kNsPerSec;
+        }
+
+        ++replayed;
+        const Target* target = targetOf(rec.streamId);
+        if (!target) {
+            continue;
+        }
+
+        switch (rec.type) {
+        case JournalRecordType::DepthFrame:
+            if (target->worker) {
+                target->worker->replayDepthFrame(rec.payload.data(), rec.payload.size());
+            }
+            break;
+
+        case JournalRecordType::TradeFrame:
+            if (target->trades) {
+                target->trades->injectFrame(rec.payload.data(), rec.payload.size());
+            }
+            break;
+
+        default:
+            // Snapshot que ningún worker pidió (ej: en vivo hubo un resync por
+            // cola llena que en el replay no ocurre): se ignora
+            break;
+        }
+    }
+
+    std::cerr << "[Replay] " << replayed << " registros reproducidos\n";
+}
+
+bool JournalReplay::nextRecord(JournalRecord& out) {
+    if (!_lookahead.empty()) {
+        out = std::move(_lookahead.front());
+        _lookahead.pop_front();
+        return true;
+    }
+    return _reader.next(out);
+}
+
+std::string JournalReplay::symbolOf(uint16_t streamId) const {
+    const std::string& name = _reader.streamName(streamId);
+    return name.substr(0, name.find('@'));
+}
+
+const JournalReplay::Target* JournalReplay::targetOf(uint16_t streamId) {
+    if (streamId >= _streamResolved.size()) {
+        _streamResolved.resize(static_cast<size_t>(streamId) + 1, false);
+        _targetByStream.resize(static_cast<size_t>(streamId) + 1, nullptr);
+    }
+
+    if (!_streamResolved[streamId]) {
+        auto it = _targets.find(symbolOf(streamId));
+        _targetByStream[streamId] = (it != _targets.end()) ? &it->second : nullptr;
+        _streamResolved[streamId] = true;
+    }
+    return _targetByStream[streamId];
+}
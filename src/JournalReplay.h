@@ -0,0 +1,89 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Journal.h"
+#include "SnapshotSource.h"
+
+class BookSyncWorker;
+class BinanceTradeStream;
+
+// -----------------------------------------------------------------------------
+// JournalReplay
+// -----------------------------------------------------------------------------
+// Reproduce un journal de captura (ver Journal.h) sin red: los depth frames
+// van a BookSyncWorker::replayDepthFrame, los trades a
+// BinanceTradeStream::injectFrame y los snapshots REST se sirven a los
+// workers como SnapshotSource. Todo corre en el hilo que llama a run(), así
+// que el resultado es determinístico.
+//
+// Snapshots: cuando un worker pide uno, se le entrega el próximo snapshot
+// grabado para su símbolo (igual que el GET en vivo, que devolvía el que se
+// grabó en ese momento). Los frames que se leen mientras se lo busca quedan
+// retenidos y se entregan después, en orden.
+//
+// Ejemplo:
+//   JournalReplay replay("capture.bin", 0.0);
+//   BookSyncWorker worker("btcusdt", book, &replay);
+//   replay.addSymbol("btcusdt", &worker, &tradeStream);
+//   worker.startReplay();
+//   replay.run(running, [&](double ts) { publisher.publishOnce(ts); });
+// -----------------------------------------------------------------------------
+class JournalReplay : public SnapshotSource {
+public:
+    using TickHandler = std::function<void(double ts)>;
+
+    // speed: 0 = lo más rápido posible; 1 = ritmo grabado; 2 = el doble, etc.
+    // Lanza std::runtime_error si el journal no se puede abrir.
+    JournalReplay(const std::string& path, double speed);
+
+    // Registra los consumidores de un símbolo (en minúsculas). Los frames de
+    // símbolos no registrados se ignoran. trades puede ser nullptr.
+    void addSymbol(const std::string& symbolLower,
+        BookSyncWorker* worker,
+        BinanceTradeStream* trades);
+
+    // SnapshotSource: próximo snapshot grabado del símbolo (ignora limit).
+    bool loadInitialBookSnapshot(const std::string& symbolLowerCase,
+        std::shared_ptr<OrderBook> orderBook,
+        int limit,
+        uint64_t& outLastUpdateId) override;
+
+    // Reproduce hasta el final del journal o hasta que running pase a false.
+    // onTick se llama cada segundo de tiempo grabado, con ese timestamp
+    // (reemplaza al reloj del Publisher).
+    void run(const std::atomic<bool>& running, const TickHandler& onTick);
+
+private:
+    struct Target {
+        BookSyncWorker* worker = nullptr;
+        BinanceTradeStream* trades = nullptr;
+    };
+
+    // Próximo registro: primero los retenidos, después el archivo
+    bool nextRecord(JournalRecord& out);
+
+    // Símbolo de un stream ("btcusdt@depth" -> "btcusdt")
+    std::string symbolOf(uint16_t streamId) const;
+
+    // Consumidores de un stream (nullptr si el símbolo no se reproduce)
+    const Target* targetOf(uint16_t streamId);
+
+    JournalReader _reader;
+    double _speed;
+
+    std::unordered_map<std::string, Target> _targets;
+
+    // Cache streamId -> Target (resuelto la primera vez que aparece)
+    std::vector<const Target*> _targetByStream;
+    std::vector<bool> _streamResolved;
+
+    // Registros leídos por adelantado mientras se buscaba un snapshot
+    std::deque<JournalRecord> _lookahead;
+};
@@ -0,0 +1,175 @@
+#include "LatencyStats.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+
+namespace {
+
+int highestBit(uint64_t v) {
+    int bit = 0;
+    while (v >>= 1) ++bit;
+    return bit;
+}
+
+// "850ns", "12.3us", "4.56ms", "1.20s"; las etapas en ms se pasan a ns antes
+std::string formatNs(int64_t ns) {
+    char buf[32];
+    if (ns < 1'000) std::snprintf(buf, sizeof(buf), "%lldns", static_cast<long long>(ns));
+    else if (ns < 1'000'000) std::snprintf(buf, sizeof(buf), "%.1fus", ns / 1e3);
+    else if (ns < 1'000'000'000) std::snprintf(buf, sizeof(buf), "%.2fms", ns / 1e6);
+    else std::snprintf(buf, sizeof(buf), "%.2fs", ns / 1e9);
+    return buf;
+}
+
+std::string formatValue(LatencyStage stage, int64_t value) {
+    switch (stage) {
+    case LatencyStage::QueueDepth:
+        return std::to_string(value);
+    case LatencyStage::ExchangeToRecv:
+    case LatencyStage::ExchangeToPublished:
+        return formatNs(value * 1'000'000); // registradas en ms
+    default:
+        return formatNs(value);
+    }
+}
+
+// Valor del percentil q (0..1) sobre cuentas por bucket
+int64_t percentile(const std::vector<uint64_t>& counts, uint64_t total, double q) {
+    // rank = ceil(q * total): el menor valor con al menos q de las muestras
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return LatencyHistogram::bucketValue(i);
+    }
+    return 0;
+}
+
+} // namespace
+
+const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::ExchangeToRecv:      return "exchange->recv";
+    case LatencyStage::RecvToParsed:        return "recv->parsed";
+    case LatencyStage::ParsedToEnqueued:    return "parsed->enqueued";
+    case LatencyStage::EnqueuedToApplied:   return "enqueued->applied";
+    case LatencyStage::AppliedToPublished:  return "applied->published";
+    case LatencyStage::RecvToPublished:     return "recv->published";
+    case LatencyStage::ExchangeToPublished: return "exchange->published";
+    case LatencyStage::QueueDepth:          return "queue depth";
+    default:                                return "?";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// LatencyHistogram
+// -----------------------------------------------------------------------------
+
+size_t LatencyHistogram::bucketOf(int64_t value) {
+    if (value <= 0) return 0;
+    const uint64_t v = static_cast<uint64_t>(value);
+    if (v < kSubCount) return static_cast<size_t>(v);
+
+    const int msb = highestBit(v);
+    if (msb >= kMaxBits) return kBucketCount - 1;
+
+    // grupo g (>= 1) = potencia de 2 por encima de kSubBits; dentro del grupo,
+    // los kSubBits bits siguientes al más alto eligen el sub-bucket
+    const int shift = msb - kSubBits;
+    const size_t group = static_cast<size_t>(shift) + 1;
+    return group * kSubCount + static_cast<size_t>((v >> shift) - kSubCount);
+}
+
+int64_t LatencyHistogram::bucketValue(size_t bucket) {
+    if (bucket < kSubCount) return static_cast<int64_t>(bucket);
+    const size_t group = bucket / kSubCount;
+    const size_t sub = bucket % kSubCount;
+    const int shift = static_cast<int>(group) - 1;
+    const uint64_t low = static_cast<uint64_t>(kSubCount + sub) << shift;
+    return static_cast<int64_t>(low + (uint64_t{ 1 } << shift) - 1);
+}
+
+void LatencyHistogram::snapshot(std::vector<uint64_t>& counts) const {
+    counts.resize(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = _counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// LatencyMonitor
+// -----------------------------------------------------------------------------
+
+SymbolLatency* LatencyMonitor::addSymbol(const std::string& symbol) {
+    if (SymbolLatency* existing = find(symbol)) {
+        return existing;
+    }
+    Entry entry;
+    entry.latency = std::make_unique<SymbolLatency>(symbol);
+    entry.previous.assign(static_cast<size_t>(LatencyStage::Count),
+        std::vector<uint64_t>(LatencyHistogram::kBucketCount, 0));
+    _entries.push_back(std::move(entry));
+    return _entries.back().latency.get();
+}
+
+SymbolLatency* LatencyMonitor::find(const std::string& symbol) const {
+    for (const auto& e : _entries) {
+        if (e.latency->symbol == symbol) return e.latency.get();
+    }
+    return nullptr;
+}
+
+void LatencyMonitor::report(std::ostream& out, bool cumulative) {
+    const int64_t now = latencyNowNs();
+    const double seconds = (now - (cumulative ? _startNs : _lastReportNs)) / 1e9;
+
+    for (auto& e : _entries) {
+        bool header = false;
+
+        for (size_t s = 0; s < static_cast<size_t>(LatencyStage::Count); ++s) {
+            const auto stage = static_cast<LatencyStage>(s);
+            e.latency->stages[s].snapshot(_counts);
+
+            // Intervalo = acumulado - lo visto en el report anterior. Así el
+            // escritor nunca tiene que resetear nada.
+            std::vector<uint64_t>& previous = e.previous[s];
+            uint64_t total = 0;
+            for (size_t i = 0; i < _counts.size(); ++i) {
+                const uint64_t current = _counts[i];
+                if (!cumulative) {
+                    _counts[i] = current - previous[i];
+                }
+                previous[i] = current;
+                total += _counts[i];
+            }
+            if (total == 0) continue;
+
+            if (!header) {
+                out << "[Latency] " << e.latency->symbol << " ("
+                    << std::fixed << std::setprecision(1) << seconds << "s"
+                    << (cumulative ? ", total" : "") << ")\n"
+                    << "  " << std::left << std::setw(22) << "etapa" << std::right
+                    << std::setw(10) << "n" << std::setw(10) << "p50" << std::setw(10) << "p99"
+                    << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+                header = true;
+            }
+
+            size_t maxBucket = 0;
+            for (size_t i = 0; i < _counts.size(); ++i) {
+                if (_counts[i] > 0) maxBucket = i;
+            }
+
+            out << "  " << std::left << std::setw(22) << latencyStageName(stage) << std::right
+                << std::setw(10) << total
+                << std::setw(10) << formatValue(stage, percentile(_counts, total, 0.50))
+                << std::setw(10) << formatValue(stage, percentile(_counts, total, 0.99))
+                << std::setw(10) << formatValue(stage, percentile(_counts, total, 0.999))
+                << std::setw(10) << formatValue(stage, LatencyHistogram::bucketValue(maxBucket))
+                << "\n";
+        }
+    }
+
+    _lastReportNs = now;
+}
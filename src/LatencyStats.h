@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Reloj monotónico de las etapas internas (ns, solo para restar entre sí)
+inline int64_t latencyNowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Reloj de pared en ms epoch: lo único comparable con el campo E de Binance
+inline int64_t wallNowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// -----------------------------------------------------------------------------
+// Etapas medidas por símbolo
+// -----------------------------------------------------------------------------
+// Un depth update pasa por: exchange (E) -> recepción en el callback del
+// WebSocket -> parseo -> cola SPSC -> aplicado al libro -> fila publicada.
+// Las transiciones internas usan latencyNowNs; las que parten de E usan el
+// reloj de pared y por lo tanto incluyen el desfase de reloj con Binance.
+// -----------------------------------------------------------------------------
+enum class LatencyStage : size_t {
+    ExchangeToRecv,      // E -> recepción (pared, ms)
+    RecvToParsed,        // parseo del frame
+    ParsedToEnqueued,    // publicación en la cola
+    EnqueuedToApplied,   // espera en la cola hasta que el worker lo aplica
+    AppliedToPublished,  // libro actualizado -> fila emitida por el Publisher
+    RecvToPublished,     // recepción -> fila emitida (punta a punta interno)
+    ExchangeToPublished, // E -> fila emitida (antigüedad de la fila, pared)
+    QueueDepth,          // updates en la cola justo después de encolar (sin unidad)
+    Count
+};
+
+const char* latencyStageName(LatencyStage stage);
+
+// -----------------------------------------------------------------------------
+// LatencyHistogram
+// -----------------------------------------------------------------------------
+// Histograma log-lineal al estilo HDR: valores exactos hasta 2^kSubBits y, por
+// encima, 2^kSubBits sub-buckets por potencia de 2 (error relativo < 3.2%).
+// Los valores negativos cuentan como 0 y los mayores a 2^kMaxBits (~68 s en
+// ns) se acumulan en el último bucket.
+//
+// record() es para un único hilo escritor por histograma (load + store, sin
+// instrucciones lock); snapshot() se puede llamar desde cualquier hilo.
+// -----------------------------------------------------------------------------
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr int kMaxBits = 36;
+    static constexpr size_t kSubCount = size_t{ 1 } << kSubBits;
+    static constexpr size_t kBucketCount = static_cast<size_t>(kMaxBits - kSubBits + 1) * kSubCount;
+
+    void record(int64_t value) {
+        auto& c = _counts[bucketOf(value)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Copia de las cuentas (acumuladas desde el arranque)
+    void snapshot(std::vector<uint64_t>& counts) const;
+
+    static size_t bucketOf(int64_t value);
+
+    // Mayor valor que cae en el bucket (lo que se reporta como percentil)
+    static int64_t bucketValue(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> _counts{};
+};
+
+// Histogramas de un símbolo, uno por etapa
+struct SymbolLatency {
+    explicit SymbolLatency(std::string sym) : symbol(std::move(sym)) {}
+
+    void record(LatencyStage stage, int64_t value) {
+        stages[static_cast<size_t>(stage)].record(value);
+    }
+
+    std::string symbol;
+    std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::Count)> stages;
+};
+
+// -----------------------------------------------------------------------------
+// LatencyMonitor
+// -----------------------------------------------------------------------------
+// Dueño de los histogramas por símbolo (--latency). Los productores reciben
+// su SymbolLatency* antes de arrancar (measureTo) y registran sin locks; el
+// hilo principal llama a report() periódicamente o con SIGUSR1.
+//
+// Ejemplo de salida:
+//   [Latency] btcusdt (10.0s)
+//     etapa                        n       p50       p99     p99.9       max
+//     exchange->recv             100     3.1ms     8.2ms     9.0ms     9.0ms
+//     recv->parsed               100     2.1us     6.0us     7.1us     7.1us
+// -----------------------------------------------------------------------------
+class LatencyMonitor {
+public:
+    // Alta de un símbolo. Llamar antes de arrancar a los productores.
+    SymbolLatency* addSymbol(const std::string& symbol);
+
+    // nullptr si el símbolo no está registrado
+    SymbolLatency* find(const std::string& symbol) const;
+
+    // Percentiles por símbolo y etapa. cumulative = false: solo lo registrado
+    // desde el último report; true: desde el arranque. Omite etapas sin datos.
+    // Desde un único hilo.
+    void report(std::ostream& out, bool cumulative = false);
+
+private:
+    struct Entry {
+        std::unique_ptr<SymbolLatency> latency;
+        // cuentas al último report, por etapa
+        std::vector<std::vector<uint64_t>> previous;
+    };
+
+    std::vector<Entry> _entries;
+    int64_t _startNs = latencyNowNs();
+    int64_t _lastReportNs = _startNs;
+    std::vector<uint64_t> _counts; // scratch de report
+};
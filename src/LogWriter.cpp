@@ -0,0 +1,445 @@
+#include "LogWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+int64_t steadyNowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- E/S de bajo nivel (descriptor de archivo) ------------------------------
+
+#ifdef _WIN32
+
+int openLogFd(const std::string& path, bool truncate) {
+    const int flags = _O_WRONLY | _O_CREAT | _O_BINARY | (truncate ? _O_TRUNC : _O_APPEND);
+    return _open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+}
+int stdoutFd() { return _fileno(stdout); }
+long long writeFd(int fd, const char* data, size_t len) {
+    return _write(fd, data, static_cast<unsigned>(std::min<size_t>(len, INT_MAX)));
+}
+uint64_t fdSize(int fd) {
+    const long long size = _lseeki64(fd, 0, SEEK_END);
+    return size > 0 ? static_cast<uint64_t>(size) : 0;
+}
+void syncFd(int fd) { _commit(fd); }
+void closeFd(int fd) { _close(fd); }
+
+#else
+
+int openLogFd(const std::string& path, bool truncate) {
+    const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND);
+    return ::open(path.c_str(), flags, 0644);
+}
+int stdoutFd() { return STDOUT_FILENO; }
+long long writeFd(int fd, const char* data, size_t len) {
+    return ::write(fd, data, len);
+}
+uint64_t fdSize(int fd) {
+    struct stat st {};
+    return ::fstat(fd, &st) == 0 && st.st_size > 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
+void syncFd(int fd) { ::fsync(fd); }
+void closeFd(int fd) { ::close(fd); }
+
+#endif
+
+// <path>.<YYYYmmdd-HHMMSS> (UTC); si ya existe, <...>.1, <...>.2, etc.
+std::string rotatedName(const std::string& path) {
+    const std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &utc);
+
+    const std::string base = path + "." + stamp;
+    std::string name = base;
+    for (int i = 1; std::ifstream(name).good(); ++i) {
+        name = base + "." + std::to_string(i);
+    }
+    return name;
+}
+
+} // namespace
+
+LogWriter::LogWriter(const std::string& path, const LogWriterConfig& config,
+    std::string preamble, bool fresh)
+    : _path(path)
+    , _config(config)
+    , _preamble(std::move(preamble))
+{
+    if (_config.slotBytes == 0) {
+        _config.slotBytes = 1;
+    }
+    const size_t count = std::max<size_t>(2, _config.bufferBytes / _config.slotBytes);
+
+    _slots.resize(count);
+    _free.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        _slots[i].reserve(_config.slotBytes);
+        _free.push_back(count - 1 - i);
+    }
+#ifndef _WIN32
+    _iov.reserve(count);
+#endif
+
+    if (fresh) {
+        moveAsideExisting();
+    }
+    openFile(/*truncate*/ fresh);
+    _thr = std::thread(&LogWriter::run, this);
+}
+
+LogWriter::~LogWriter() {
+    stop();
+}
+
+// -----------------------------------------------------------------------------
+// Productor
+// -----------------------------------------------------------------------------
+
+void LogWriter::append(const char* data, size_t len) {
+    if (_dropping) {
+        _droppedBytes.fetch_add(len, std::memory_order_relaxed);
+        return;
+    }
+
+    if (_current == kNone) {
+        _current = acquire();
+        if (_current == kNone) {
+            _dropping = true;
+            countDrop(len);
+            return;
+        }
+    }
+
+    // Lote lleno: se encola y la línea sigue en un buffer nuevo
+    std::string& buf = _slots[_current];
+    if (!buf.empty() && buf.size() + len > _config.slotBytes) {
+        commit();
+        append(data, len);
+        return;
+    }
+
+    buf.append(data, len);
+}
+
+void LogWriter::commit() {
+    _dropping = false;
+
+    if (_current == kNone || _slots[_current].empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _pending.push_back(_current);
+    }
+    _current = kNone;
+    _pendingCv.notify_one();
+}
+
+size_t LogWriter::acquire() {
+    std::unique_lock<std::mutex> lock(_mtx);
+
+    if (_free.empty()) {
+        switch (_config.overflow) {
+        case LogOverflow::Block:
+            _freeCv.wait(lock, [&] { return !_free.empty() || _stopping; });
+            break;
+
+        case LogOverflow::DropOldest:
+            // El lote más viejo que el writer todavía no tomó. Si todos están
+            // en escritura no hay nada que pisar: se pierde el nuevo.
+            if (!_pending.empty()) {
+                const size_t idx = _pending.front();
+                _pending.pop_front();
+                countDrop(_slots[idx].size());
+                _slots[idx].clear();
+                return idx;
+            }
+            return kNone;
+
+        case LogOverflow::Drop:
+            return kNone;
+        }
+        if (_free.empty()) {
+            return kNone;
+        }
+    }
+
+    const size_t idx = _free.back();
+    _free.pop_back();
+    _slots[idx].clear();
+    return idx;
+}
+
+void LogWriter::countDrop(size_t bytes) {
+    _droppedBatches.fetch_add(1, std::memory_order_relaxed);
+    _droppedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void LogWriter::stop() {
+    if (!_thr.joinable()) {
+        return;
+    }
+
+    commit();
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _stopping = true;
+    }
+    _pendingCv.notify_all();
+    _freeCv.notify_all();
+    _thr.join();
+
+    if (_config.fsync != LogFsync::None && _dirty) {
+        sync();
+    }
+    closeFile();
+
+    if (droppedBatches() > 0) {
+        std::cerr << "[LogWriter] " << droppedBatches() << " lotes descartados ("
+            << droppedBytes() << " bytes) por buffers llenos\n";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+
+void LogWriter::run() {
+    using namespace std::chrono_literals;
+
+    std::vector<size_t> batch;
+    batch.reserve(_slots.size());
+    int64_t lastReportMs = 0;
+
+    while (true) {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(_mtx);
+            _pendingCv.wait_for(lock, 100ms, [&] { return !_pending.empty() || _stopping; });
+            batch.assign(_pending.begin(), _pending.end());
+            _pending.clear();
+            stopping = _stopping;
+        }
+
+        if (!batch.empty()) {
+            writeBatch(batch);
+            {
+                std::lock_guard<std::mutex> lock(_mtx);
+                for (size_t idx : batch) {
+                    _free.push_back(idx);
+                }
+            }
+            _freeCv.notify_all();
+        }
+
+        const int64_t now = steadyNowMs();
+
+        if (_dirty) {
+            if (_config.fsync == LogFsync::Batch ||
+                (_config.fsync == LogFsync::Interval && now - _lastSyncMs >= _config.fsyncIntervalMs))
+            {
+                sync();
+            }
+        }
+
+        const bool hasData = _fileBytes > _preamble.size();
+        if (hasData &&
+            ((_config.rotateBytes > 0 && _fileBytes >= _config.rotateBytes) ||
+             (_config.rotateMs > 0 && now - _openedAtMs >= _config.rotateMs)))
+        {
+            rotate();
+        }
+
+        const uint64_t drops = droppedBatches();
+        if (drops != _reportedDrops && now - lastReportMs >= 1000) {
+            std::cerr << "[LogWriter] salida lenta: " << drops - _reportedDrops
+                << " lotes descartados\n";
+            _reportedDrops = drops;
+            lastReportMs = now;
+        }
+
+        if (stopping && batch.empty()) {
+            break;
+        }
+    }
+}
+
+void LogWriter::writeBatch(const std::vector<size_t>& batch) {
+#ifdef _WIN32
+    for (size_t idx : batch) {
+        writeAll(_slots[idx].data(), _slots[idx].size());
+    }
+#else
+    // Una sola llamada para toda la tanda (de a IOV_MAX buffers). _iov tiene
+    // capacidad para todos los buffers: en régimen no reserva memoria.
+    std::vector<iovec>& iov = _iov;
+    iov.clear();
+    for (size_t idx : batch) {
+        iov.push_back(iovec{ &_slots[idx][0], _slots[idx].size() });
+    }
+
+    size_t first = 0;
+    while (first < iov.size() && _fd >= 0) {
+        const int count = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+        const ssize_t written = ::writev(_fd, &iov[first], count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (!_writeError) {
+                std::cerr << "[LogWriter] error escribiendo " << (_path.empty() ? "stdout" : _path)
+                    << ": " << std::strerror(errno) << "\n";
+                _writeError = true;
+            }
+            return;
+        }
+        _fileBytes += static_cast<uint64_t>(written);
+        _dirty = true;
+
+        // Avanzar sobre lo escrito (writev puede escribir de a partes)
+        size_t left = static_cast<size_t>(written);
+        while (first < iov.size() && left >= iov[first].iov_len) {
+            left -= iov[first].iov_len;
+            ++first;
+        }
+        if (left > 0) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+        }
+    }
+#endif
+}
+
+void LogWriter::writeAll(const char* data, size_t len) {
+    while (len > 0 && _fd >= 0) {
+        const long long written = writeFd(_fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (!_writeError) {
+                std::cerr << "[LogWriter] error escribiendo " << (_path.empty() ? "stdout" : _path)
+                    << ": " << std::strerror(errno) << "\n";
+                _writeError = true;
+            }
+            return;
+        }
+        data += written;
+        len -= static_cast<size_t>(written);
+        _fileBytes += static_cast<uint64_t>(written);
+        _dirty = true;
+    }
+}
+
+void LogWriter::openFile(bool truncate) {
+    if (_path.empty()) {
+        _fd = stdoutFd();
+        _ownsFd = false;
+        _fileBytes = 0;
+    }
+    else {
+        _fd = openLogFd(_path, truncate);
+        if (_fd < 0) {
+            throw std::runtime_error("No se pudo abrir el log: " + _path);
+        }
+        _ownsFd = true;
+        _fileBytes = fdSize(_fd);
+    }
+
+    if (_fileBytes == 0 && !_preamble.empty()) {
+        writeAll(_preamble.data(), _preamble.size());
+    }
+    _openedAtMs = steadyNowMs();
+    _lastSyncMs = _openedAtMs;
+}
+
+void LogWriter::closeFile() {
+    if (_ownsFd && _fd >= 0) {
+        closeFd(_fd);
+    }
+    _fd = -1;
+    _ownsFd = false;
+}
+
+void LogWriter::rotate() {
+    if (_path.empty()) {
+        return; // stdout no rota
+    }
+
+    if (_config.fsync != LogFsync::None && _dirty) {
+        sync();
+    }
+    closeFile();
+
+    // Si el rename falla (en Windows, si otro proceso tiene el archivo
+    // abierto) el archivo sigue en _path: se reabre para agregar, no se
+    // trunca, y se reintenta en el próximo disparo
+    const std::string rotated = rotatedName(_path);
+    const bool renamed = std::rename(_path.c_str(), rotated.c_str()) == 0;
+    if (!renamed && !_rotateError) {
+        std::cerr << "[LogWriter] no se pudo rotar " << _path << " a " << rotated
+            << ": " << std::strerror(errno) << " (se sigue agregando)\n";
+    }
+    _rotateError = !renamed;
+
+    try {
+        openFile(/*truncate*/ renamed);
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "[LogWriter] " << ex.what() << "\n";
+    }
+}
+
+void LogWriter::moveAsideExisting() {
+    // Un reinicio con el mismo --log no pisa la captura anterior: se le da
+    // el nombre de una rotación
+    if (_path.empty()) {
+        return;
+    }
+    std::ifstream existing(_path, std::ios::binary | std::ios::ate);
+    if (!existing || existing.tellg() <= 0) {
+        return;
+    }
+    existing.close();
+
+    const std::string rotated = rotatedName(_path);
+    if (std::rename(_path.c_str(), rotated.c_str()) != 0) {
+        throw std::runtime_error("No se pudo mover el log anterior " + _path + " a " + rotated +
+            ": " + std::strerror(errno));
+    }
+    std::cerr << "[LogWriter] log anterior movido a " << rotated << "\n";
+}
+
+void LogWriter::sync() {
+    if (_ownsFd && _fd >= 0) {
+        syncFd(_fd);
+    }
+    _dirty = false;
+    _lastSyncMs = steadyNowMs();
+}
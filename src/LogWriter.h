@@ -0,0 +1,158 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Configuración de la salida del Publisher
+// -----------------------------------------------------------------------------
+
+// Qué hace el productor cuando todos los buffers están ocupados (disco lento)
+enum class LogOverflow {
+    Block,      // espera a que el writer libere un buffer (sin pérdida)
+    DropOldest, // reutiliza el buffer pendiente más viejo (se pierde ese lote)
+    Drop        // descarta el lote nuevo y lo cuenta
+};
+
+// "block" / "drop-oldest" / "drop" -> LogOverflow. Lanza std::runtime_error si no se reconoce.
+inline LogOverflow parseLogOverflow(const std::string& name) {
+    if (name == "block") return LogOverflow::Block;
+    if (name == "drop-oldest") return LogOverflow::DropOldest;
+    if (name == "drop") return LogOverflow::Drop;
+    throw std::runtime_error("Politica de overflow desconocida: " + name + " (usar block|drop-oldest|drop)");
+}
+
+enum class LogFsync {
+    None,     // el sistema operativo decide cuándo bajar a disco
+    Batch,    // fsync después de cada escritura agrupada
+    Interval  // fsync como mucho cada fsyncIntervalMs
+};
+
+struct LogWriterConfig {
+    size_t bufferBytes = 16u << 20; // memoria total de buffers (--log-buffer-mb=16)
+    size_t slotBytes = 256u << 10;  // tamaño de cada buffer del anillo
+    LogOverflow overflow = LogOverflow::Block; // --log-overflow=block|drop-oldest|drop
+    LogFsync fsync = LogFsync::None;           // --log-fsync=none|batch|<duración>
+    int64_t fsyncIntervalMs = 1000;
+    uint64_t rotateBytes = 0;  // --log-rotate-mb=N (0 = sin rotación por tamaño)
+    int64_t rotateMs = 0;      // --log-rotate-every=1h (0 = sin rotación por tiempo)
+};
+
+// -----------------------------------------------------------------------------
+// LogWriter
+// -----------------------------------------------------------------------------
+// Etapa de escritura asíncrona: el Publisher arma las líneas (o registros) en
+// buffers preasignados y los encola; un hilo propio los junta y los baja con
+// una sola llamada writev por tanda. Así un disco lento no estira el ciclo de
+// publicación.
+//
+// - La memoria es fija: bufferBytes / slotBytes buffers, reservados una vez.
+// - Cuando no queda buffer libre se aplica la política de overflow; los lotes
+//   perdidos se cuentan (droppedBatches) y se avisan por stderr.
+// - Rotación por tamaño y/o tiempo: el archivo actual se renombra a
+//   <path>.<YYYYmmdd-HHMMSS> (UTC) y se abre uno nuevo con el mismo preamble
+//   (la cabecera del formato binario). Los buffers nunca se parten entre
+//   archivos, así que cada archivo tiene líneas/registros completos. Si el
+//   rename falla se sigue agregando al mismo archivo y se reintenta en el
+//   próximo disparo.
+// - path vacío = stdout (sin rotación).
+//
+// Thread-safety:
+//   - append/commit desde un único hilo productor (el del Publisher).
+//   - El lock interno solo se toma para pasar buffers entre productor y writer,
+//     nunca durante la escritura a disco.
+//
+// Lanza std::runtime_error si no puede abrir el archivo (o mover el anterior).
+// -----------------------------------------------------------------------------
+class LogWriter {
+public:
+    // fresh = true: empieza un archivo nuevo (binario); si ya hay uno con
+    // datos se renombra antes como en una rotación, no se pisa.
+    // false: agrega al que haya (CSV).
+    LogWriter(const std::string& path, const LogWriterConfig& config,
+        std::string preamble = {}, bool fresh = false);
+    ~LogWriter();
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    // ---- productor ----------------------------------------------------------
+
+    // Agrega bytes al lote en armado. Si no entran en el buffer actual, el
+    // lote se encola y se sigue en uno nuevo.
+    void append(const char* data, size_t len);
+    void append(const std::string& s) { append(s.data(), s.size()); }
+
+    // Encola el lote en armado (fin de una pasada de publicación)
+    void commit();
+
+    // Encola lo pendiente, espera a que se escriba y cierra el archivo
+    void stop();
+
+    // ---- consultas ----------------------------------------------------------
+
+    uint64_t droppedBatches() const { return _droppedBatches.load(std::memory_order_relaxed); }
+    uint64_t droppedBytes() const { return _droppedBytes.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    // Buffer libre para el productor (según la política de overflow), o kNone
+    size_t acquire();
+    void countDrop(size_t bytes);
+
+    void run();
+    void writeBatch(const std::vector<size_t>& batch);
+    void writeAll(const char* data, size_t len);
+    void openFile(bool truncate);
+    void closeFile();
+    void rotate();
+    void moveAsideExisting();
+    void sync();
+
+    std::string _path;
+    LogWriterConfig _config;
+    std::string _preamble;
+
+    // buffers preasignados; _free y _pending guardan índices
+    std::vector<std::string> _slots;
+    std::vector<size_t> _free;
+    std::deque<size_t> _pending;
+    size_t _current = kNone;  // lote en armado (solo el productor)
+    bool _dropping = false;   // el lote actual se descarta hasta el commit
+
+    std::mutex _mtx;
+    std::condition_variable _pendingCv; // writer: hay lotes
+    std::condition_variable _freeCv;    // productor (Block): hay buffers libres
+    bool _stopping = false;
+
+    std::atomic<uint64_t> _droppedBatches{ 0 };
+    std::atomic<uint64_t> _droppedBytes{ 0 };
+    uint64_t _reportedDrops = 0; // solo el writer
+
+    // estado del archivo (solo el writer, salvo al abrir/cerrar)
+    int _fd = -1;
+    bool _ownsFd = false;
+    uint64_t _fileBytes = 0;
+    int64_t _openedAtMs = 0;
+    int64_t _lastSyncMs = 0;
+    bool _dirty = false;       // escrito desde el último fsync
+    bool _writeError = false;  // ya avisado por stderr
+    bool _rotateError = false; // falló el último rename de rotación (ya avisado)
+#ifndef _WIN32
+    std::vector<iovec> _iov;   // de writeBatch, reservado para todos los buffers
+#endif
+
+    std::thread _thr;
+};
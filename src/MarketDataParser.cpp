@@ -0,0 +1,263 @@
+#include "MarketDataParser.h"
+
+#include <cstring>
+
+namespace {
+
+// Cursor mínimo sobre el frame. Todas las funciones devuelven false ante
+// cualquier cosa inesperada; no hay excepciones ni memoria dinámica.
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    void skipWs() {
+        while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    }
+
+    bool consume(char c) {
+        skipWs();
+        if (p == end || *p != c) return false;
+        ++p;
+        return true;
+    }
+
+    // String JSON; devuelve el contenido crudo [first, last) sin procesar escapes.
+    bool string(const char*& first, const char*& last) {
+        if (!consume('"')) return false;
+        first = p;
+        while (p != end && *p != '"') {
+            if (*p == '\\') {
+                if (++p == end) return false;
+            }
+            ++p;
+        }
+        if (p == end) return false;
+        last = p++;
+        return true;
+    }
+
+    bool uint(uint64_t& out) {
+        skipWs();
+        if (p == end || *p < '0' || *p > '9') return false;
+        uint64_t v = 0;
+        while (p != end && *p >= '0' && *p <= '9') {
+            v = v * 10 + static_cast<uint64_t>(*p - '0');
+            ++p;
+        }
+        out = v;
+        return true;
+    }
+
+    bool boolean(bool& out) {
+        skipWs();
+        if (end - p >= 4 && std::memcmp(p, "true", 4) == 0) {
+            p += 4;
+            out = true;
+            return true;
+        }
+        if (end - p >= 5 && std::memcmp(p, "false", 5) == 0) {
+            p += 5;
+            out = false;
+            return true;
+        }
+        return false;
+    }
+
+    // Decimal entre comillas ("123.45") -> punto fijo
+    bool decimal(int decimals, int64_t& out) {
+        const char* first;
+        const char* last;
+        return string(first, last) && parseFixed(first, last, decimals, out);
+    }
+
+    // Saltea un valor JSON cualquiera (incluye objetos/arrays anidados).
+    bool skipValue() {
+        skipWs();
+        if (p == end) return false;
+
+        if (*p == '"') {
+            const char* a;
+            const char* b;
+            return string(a, b);
+        }
+
+        if (*p == '{' || *p == '[') {
+            int depth = 0;
+            while (p != end) {
+                char c = *p;
+                if (c == '"') {
+                    const char* a;
+                    const char* b;
+                    if (!string(a, b)) return false;
+                    continue;
+                }
+                ++p;
+                if (c == '{' || c == '[') ++depth;
+                else if (c == '}' || c == ']') {
+                    if (--depth == 0) return true;
+                }
+            }
+            return false;
+        }
+
+        // número / true / false / null
+        const char* start = p;
+        while (p != end && *p != ',' && *p != '}' && *p != ']' &&
+            *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+        {
+            ++p;
+        }
+        return p != start;
+    }
+
+    // Array de niveles [["px","qty"],...] -> vector de pares en punto fijo
+    bool levels(const SymbolScale& scale, std::vector<std::pair<Price, Qty>>& out) {
+        if (!consume('[')) return false;
+        if (consume(']')) return true;
+
+        do {
+            if (!consume('[')) return false;
+            Price px;
+            Qty qty;
+            if (!decimal(scale.priceDecimals, px)) return false;
+            if (!consume(',')) return false;
+            if (!decimal(scale.qtyDecimals, qty)) return false;
+            // Campos extra (formatos viejos de Binance): se ignoran
+            while (consume(',')) {
+                if (!skipValue()) return false;
+            }
+            if (!consume(']')) return false;
+            out.emplace_back(px, qty);
+        } while (consume(','));
+
+        return consume(']');
+    }
+};
+
+inline bool keyIs(const char* first, const char* last, const char* key) {
+    const size_t n = std::strlen(key);
+    return static_cast<size_t>(last - first) == n && std::memcmp(first, key, n) == 0;
+}
+
+// Recorre las claves del objeto raíz llamando a onField(keyFirst, keyLast, cursor).
+// onField consume el valor y devuelve false si falló.
+template <class OnField>
+bool forEachField(Cursor& cur, OnField onField) {
+    if (!cur.consume('{')) return false;
+    if (cur.consume('}')) return true;
+
+    do {
+        const char* kFirst;
+        const char* kLast;
+        if (!cur.string(kFirst, kLast)) return false;
+        if (!cur.consume(':')) return false;
+        if (!onField(kFirst, kLast, cur)) return false;
+    } while (cur.consume(','));
+
+    return cur.consume('}');
+}
+
+} // namespace
+
+bool parseDepthUpdate(const char* data, size_t len, const SymbolScale& scale, DepthUpdate& out) {
+    Cursor cur{ data, data + len };
+    bool hasFirst = false;
+    bool hasLast = false;
+
+    out.eventTimeMs = 0;
+    out.bids.clear();
+    out.asks.clear();
+
+    bool ok = forEachField(cur, [&](const char* k, const char* kEnd, Cursor& c) {
+        const size_t klen = static_cast<size_t>(kEnd - k);
+        if (klen == 1) {
+            switch (*k) {
+            case 'E': return c.uint(out.eventTimeMs);
+            case 'U': hasFirst = true; return c.uint(out.firstUpdateId);
+            case 'u': hasLast = true;  return c.uint(out.lastUpdateId);
+            case 'b': return c.levels(scale, out.bids);
+            case 'a': return c.levels(scale, out.asks);
+            case 'e': {
+                const char* v;
+                const char* vEnd;
+                return c.string(v, vEnd) && keyIs(v, vEnd, "depthUpdate");
+            }
+            default: break;
+            }
+        }
+        return c.skipValue();
+    });
+
+    return ok && hasFirst && hasLast;
+}
+
+bool parseDepthSnapshot(const char* data, size_t len, const SymbolScale& scale, DepthSnapshot& out) {
+    Cursor cur{ data, data + len };
+    bool hasLastUpdateId = false;
+
+    out.bids.clear();
+    out.asks.clear();
+
+    bool ok = forEachField(cur, [&](const char* k, const char* kEnd, Cursor& c) {
+        if (keyIs(k, kEnd, "lastUpdateId")) {
+            hasLastUpdateId = true;
+            return c.uint(out.lastUpdateId);
+        }
+        if (keyIs(k, kEnd, "bids")) return c.levels(scale, out.bids);
+        if (keyIs(k, kEnd, "asks")) return c.levels(scale, out.asks);
+        return c.skipValue();
+    });
+
+    return ok && hasLastUpdateId;
+}
+
+bool parseTrade(const char* data, size_t len, const SymbolScale& scale, TradeEvent& out) {
+    Cursor cur{ data, data + len };
+    bool hasPrice = false;
+    bool hasQty = false;
+    bool hasMaker = false;
+
+    bool ok = forEachField(cur, [&](const char* k, const char* kEnd, Cursor& c) {
+        const size_t klen = static_cast<size_t>(kEnd - k);
+        if (klen == 1) {
+            switch (*k) {
+            case 'p': hasPrice = true; return c.decimal(scale.priceDecimals, out.price);
+            case 'q': hasQty = true;   return c.decimal(scale.qtyDecimals, out.qty);
+            case 'm': hasMaker = true; return c.boolean(out.isBuyerMaker);
+            case 'E': return c.uint(out.eventTime);
+            case 'T': return c.uint(out.tradeTime);
+            case 't': return c.uint(out.tradeId);
+            case 'e': {
+                const char* v;
+                const char* vEnd;
+                return c.string(v, vEnd) && keyIs(v, vEnd, "trade");
+            }
+            default: break;
+            }
+        }
+        return c.skipValue();
+    });
+
+    return ok && hasPrice && hasQty && hasMaker;
+}
+
+bool parseCombinedEnvelope(const char* data, size_t len, CombinedEnvelope& out) {
+    Cursor cur{ data, data + len };
+    out = CombinedEnvelope{};
+
+    bool ok = forEachField(cur, [&](const char* k, const char* kEnd, Cursor& c) {
+        if (keyIs(k, kEnd, "stream")) {
+            return c.string(out.streamFirst, out.streamLast);
+        }
+        if (keyIs(k, kEnd, "data")) {
+            c.skipWs();
+            out.dataFirst = c.p;
+            if (!c.skipValue()) return false;
+            out.dataLast = c.p;
+            return true;
+        }
+        return c.skipValue();
+    });
+
+    return ok && out.streamFirst && out.dataFirst;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "FixedPoint.h"
+#include "OrderBook.h" // DepthUpdate
+
+// -----------------------------------------------------------------------------
+// Parser de payloads de Binance (WS depthUpdate / trade, snapshot REST)
+// -----------------------------------------------------------------------------
+// Parsers dedicados a los dos esquemas conocidos. Recorren el frame una sola
+// vez, sin construir un DOM, y escriben directamente sobre la estructura de
+// salida:
+//   - precios y cantidades se convierten con parseFixed sin pasar por
+//     std::string ni std::stod;
+//   - las claves desconocidas se saltean sin interpretarlas;
+//   - DepthUpdate::bids/asks se vacían con clear() y se rellenan, así que si
+//     la estructura se reutiliza (slots de SpscRing) no hay reservas de
+//     memoria en régimen.
+//
+// Devuelven false si el frame no tiene la forma esperada (otro tipo de evento,
+// campos obligatorios ausentes, JSON mal formado). En ese caso el llamador
+// cae al parseo genérico con nlohmann::json.
+// -----------------------------------------------------------------------------
+
+// Evento "trade" (<symbol>@trade)
+struct TradeEvent {
+    uint64_t eventTime = 0;  // E (ms epoch)
+    uint64_t tradeId = 0;    // t
+    uint64_t tradeTime = 0;  // T (ms epoch)
+    Price price = 0;         // p
+    Qty qty = 0;             // q
+    bool isBuyerMaker = false; // m
+};
+
+// {"e":"depthUpdate","E":...,"s":"BNBBTC","U":157,"u":160,"b":[["0.0024","10"]],"a":[...]}
+// Obligatorios: U y u. Si viene "e", tiene que ser "depthUpdate".
+bool parseDepthUpdate(const char* data, size_t len, const SymbolScale& scale, DepthUpdate& out);
+
+// {"lastUpdateId":1027024,"bids":[["4.00000000","431.00000000"],..],"asks":[..]}
+// Body de GET /api/v3/depth. Con limit=5000 son ~10000 niveles: se recorren
+// en streaming igual que un depth update, sin DOM ni strings intermedios, y
+// bids/asks reutilizan su capacidad. Obligatorio: lastUpdateId.
+bool parseDepthSnapshot(const char* data, size_t len, const SymbolScale& scale, DepthSnapshot& out);
+
+// {"e":"trade","E":...,"s":"BNBBTC","t":12345,"p":"0.001","q":"100","T":...,"m":true,"M":true}
+// Obligatorios: p, q y m. Si viene "e", tiene que ser "trade".
+bool parseTrade(const char* data, size_t len, const SymbolScale& scale, TradeEvent& out);
+
+// Sobre de los combined streams (/stream?streams=...):
+//   {"stream":"btcusdt@depth@100ms","data":{...}}
+// Devuelve el nombre del stream y el rango crudo del objeto "data", sin copiar,
+// para rutear el payload al consumidor correspondiente.
+struct CombinedEnvelope {
+    const char* streamFirst = nullptr;
+    const char* streamLast = nullptr;
+    const char* dataFirst = nullptr;
+    const char* dataLast = nullptr;
+};
+bool parseCombinedEnvelope(const char* data, size_t len, CombinedEnvelope& out);
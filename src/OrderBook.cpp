@@ -1,64 +1,76 @@
 #include "OrderBook.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-OrderBook::OrderBook(std::string sym)
+OrderBook::OrderBook(std::string sym, SymbolScale scale, BookEngine engine)
     : _symbol(std::move(sym))
+    , _scale(scale)
+    , _engine(engine)
+    , _bids(makeBookSide(engine, /*isBid*/ true, scale))
+    , _asks(makeBookSide(engine, /*isBid*/ false, scale))
 {
 }
 
-void OrderBook::applyBidLevel(double px, double qty) {
-    if (px <= 0.0 || qty < 0.0) return;
+void OrderBook::applyBidLevel(Price px, Qty qty) {
+    if (px <= 0 || qty < 0) return;
     std::lock_guard<std::mutex> lock(_mtx);
-    if (qty == 0.0) {
-        _bids.erase(px);
-    }
-    else {
-        _bids[px] = qty;
-    }
+    _bids->set(px, qty); // qty == 0 elimina el nivel
+    touchTopLocked(/*isBid*/ true, px, qty);
+    if (_sweepDepth > 0) _sweepBids.set(px, qty);
+    refreshTopLocked();
+    markChangedLocked();
 }
 
-void OrderBook::applyAskLevel(double px, double qty) {
-    if (px <= 0.0 || qty < 0.0) return;
+void OrderBook::applyAskLevel(Price px, Qty qty) {
+    if (px <= 0 || qty < 0) return;
     std::lock_guard<std::mutex> lock(_mtx);
-    if (qty == 0.0) {
-        _asks.erase(px);
-    }
-    else {
-        _asks[px] = qty;
-    }
+    _asks->set(px, qty); // qty == 0 elimina el nivel
+    touchTopLocked(/*isBid*/ false, px, qty);
+    if (_sweepDepth > 0) _sweepAsks.set(px, qty);
+    refreshTopLocked();
+    markChangedLocked();
 }
 
-void OrderBook::applyDepthDelta(const DepthUpdate& update) {
+void OrderBook::applyDepthDelta(const DepthUpdate& update, int64_t appliedNs) {
     std::lock_guard<std::mutex> lock(_mtx);
 
     // Actualizar niveles de compra (bids)
     for (const auto& [price, quantity] : update.bids) {
-        if (price <= 0.0 || quantity < 0.0)
+        if (price <= 0 || quantity < 0)
             continue; // entrada invlida, se ignora
 
-        if (quantity == 0.0)
-            _bids.erase(price); // eliminar nivel (sin oferta)
-        else
-            _bids[price] = quantity; // insertar o actualizar
+        // insertar o actualizar; quantity == 0 elimina el nivel (sin oferta)
+        _bids->set(price, quantity);
+        touchTopLocked(/*isBid*/ true, price, quantity);
+        if (_sweepDepth > 0) _sweepBids.set(price, quantity); // O(log n), sumas al da
     }
 
     // Actualizar niveles de venta (asks)
     for (const auto& [price, quantity] : update.asks) {
-        if (price <= 0.0 || quantity < 0.0)
+        if (price <= 0 || quantity < 0)
             continue;
 
-        if (quantity == 0.0)
-            _asks.erase(price);
-        else
-            _asks[price] = quantity;
+        _asks->set(price, quantity);
+        touchTopLocked(/*isBid*/ false, price, quantity);
+        if (_sweepDepth > 0) _sweepAsks.set(price, quantity);
     }
-    if (!_bids.empty() && !_asks.empty()) {
-        auto bb = _bids.begin()->first;
-        auto aa = _asks.begin()->first;
+
+    // Niveles que un update empuja ms all del tope
+    trimLocked();
+    refreshTopLocked();
+    _lastUpdate.eventTimeMs = update.eventTimeMs;
+    _lastUpdate.recvNs = update.recvNs;
+    _lastUpdate.appliedNs = appliedNs;
+    markChangedLocked();
+
+    if (!_bids->empty() && !_asks->empty()) {
+        auto bb = _bids->best().price;
+        auto aa = _asks->best().price;
         if (bb >= aa) {
             std::cerr << "[CROSS] " << _symbol
-                << " bestBid=" << bb
-                << " bestAsk=" << aa
+                << " bestBid=" << _scale.priceToDouble(static_cast<double>(bb))
+                << " bestAsk=" << _scale.priceToDouble(static_cast<double>(aa))
                 << " (bidsApplied=" << update.bids.size()
                 << ", asksApplied=" << update.asks.size() << ")\n";
             // opcional: volcar los 3 primeros niveles de cada lado
@@ -67,46 +79,261 @@ void OrderBook::applyDepthDelta(const DepthUpdate& update) {
 }
 
 BookSnapshot OrderBook::snapshot(int topN) {
+    BookSnapshot snap;
+    snapshotInto(topN, snap);
+    return snap;
+}
+
+void OrderBook::snapshotInto(int topN, BookSnapshot& out) {
     std::lock_guard<std::mutex> lock(_mtx);
 
-    BookSnapshot snap;
-    snap.symbol = _symbol;
+    out.symbol.assign(_symbol); // misma capacidad en cada llamada
+    out.scale = _scale;
+    out.bestBidPx = out.bestBidQty = 0;
+    out.bestAskPx = out.bestAskQty = 0;
 
-    if (!_bids.empty()) {
-        snap.bestBidPx = _bids.begin()->first;
-        snap.bestBidQty = _bids.begin()->second;
+    if (!_bids->empty()) {
+        Level best = _bids->best();
+        out.bestBidPx = best.price;
+        out.bestBidQty = best.qty;
     }
-    if (!_asks.empty()) {
-        snap.bestAskPx = _asks.begin()->first;
-        snap.bestAskQty = _asks.begin()->second;
+    if (!_asks->empty()) {
+        Level best = _asks->best();
+        out.bestAskPx = best.price;
+        out.bestAskQty = best.qty;
     }
 
-    int count = 0;
-    for (auto& kv : _bids) {
-        if (count++ >= topN) break;
-        snap.topBids.push_back(Level{ kv.first, kv.second });
+    out.topBids.clear();
+    out.topAsks.clear();
+    if (topN <= _topN) {
+        // Del cache: Level es trivialmente copiable, insert es un memcpy
+        const size_t n = static_cast<size_t>(std::max(topN, 0));
+        out.topBids.insert(out.topBids.end(), _topBids.begin(), _topBids.begin() + std::min(n, _topBids.size()));
+        out.topAsks.insert(out.topAsks.end(), _topAsks.begin(), _topAsks.begin() + std::min(n, _topAsks.size()));
+    }
+    else {
+        _bids->top(topN, out.topBids);
+        _asks->top(topN, out.topAsks);
     }
+    out.lastUpdate = _lastUpdate;
+}
+
+void OrderBook::topLevels(int n, std::vector<Level>& bids, std::vector<Level>& asks) {
+    std::lock_guard<std::mutex> lock(_mtx);
 
-    count = 0;
-    for (auto& kv : _asks) {
-        if (count++ >= topN) break;
-        snap.topAsks.push_back(Level{ kv.first, kv.second });
+    bids.clear();
+    asks.clear();
+    if (n <= _topN) {
+        const size_t count = static_cast<size_t>(std::max(n, 0));
+        bids.insert(bids.end(), _topBids.begin(), _topBids.begin() + std::min(count, _topBids.size()));
+        asks.insert(asks.end(), _topAsks.begin(), _topAsks.begin() + std::min(count, _topAsks.size()));
+        return;
     }
+    _bids->top(n, bids);
+    _asks->top(n, asks);
+}
 
-    return snap;
+void OrderBook::setTopN(int n) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _topN = std::max(n, 0);
+    _topBids.reserve(static_cast<size_t>(_topN));
+    _topAsks.reserve(static_cast<size_t>(_topN));
+    _topDirty = true;
+    refreshTopLocked();
+}
+
+void OrderBook::touchTopLocked(bool isBid, Price px, Qty qty) {
+    if (_topN == 0 || _topDirty) {
+        return;
+    }
+    std::vector<Level>& top = isBid ? _topBids : _topAsks;
+
+    // Con el cache lleno, un precio peor que su ltimo nivel no lo afecta
+    // (con el cache incompleto el lado entero est cacheado)
+    if (top.size() == static_cast<size_t>(_topN)) {
+        const Price worst = top.back().price;
+        if (isBid ? px < worst : px > worst) {
+            return;
+        }
+    }
+
+    // Nivel ya cacheado que sigue vivo: solo cambia la cantidad
+    auto it = std::lower_bound(top.begin(), top.end(), px, [isBid](const Level& lvl, Price p) {
+        return isBid ? lvl.price > p : lvl.price < p;
+    });
+    if (qty != 0 && it != top.end() && it->price == px) {
+        it->qty = qty;
+        return;
+    }
+
+    // Entra o sale un nivel dentro del top: se recalcula al final de la mutacin
+    _topDirty = true;
+}
+
+void OrderBook::refreshTopLocked() {
+    if (!_topDirty) {
+        return;
+    }
+    _topDirty = false;
+    _topBids.clear();
+    _topAsks.clear();
+    if (_topN > 0) {
+        _bids->top(_topN, _topBids); // capacidad reservada: sin reservas
+        _asks->top(_topN, _topAsks);
+    }
+}
+
+void OrderBook::trimLocked() {
+    if (_maxDepth == 0) {
+        return;
+    }
+    const size_t before = _bids->size() + _asks->size();
+    _bids->trimTo(_maxDepth);
+    _asks->trimTo(_maxDepth);
+    if (_sweepDepth > 0) {
+        // Mismos niveles que los lados: los recortados tambin salen de ac
+        _sweepBids.trimTo(_maxDepth);
+        _sweepAsks.trimTo(_maxDepth);
+    }
+    if (_maxDepth < static_cast<size_t>(_topN) && _bids->size() + _asks->size() != before) {
+        _topDirty = true;
+    }
+}
+
+void OrderBook::setSweepDepth(int n) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _sweepDepth = std::max(n, 0);
+    rebuildSweepLocked();
+}
+
+void OrderBook::rebuildSweepLocked() {
+    _sweepBids.clear();
+    _sweepAsks.clear();
+    if (_sweepDepth == 0) {
+        return;
+    }
+    std::vector<Level> levels;
+    for (const bool isBid : { true, false }) {
+        const BookSide& side = isBid ? *_bids : *_asks;
+        SweepDepth& depth = isBid ? _sweepBids : _sweepAsks;
+        levels.clear();
+        side.top(static_cast<int>(side.size()), levels);
+        depth.reserve(levels.size());
+        for (const Level& level : levels) {
+            depth.set(level.price, level.qty);
+        }
+    }
+}
+
+void OrderBook::finishSweep(Price worst, size_t levels, Qty filled, double notional,
+    bool complete, SweepResult& res) const
+{
+    const double priceUnit = static_cast<double>(pow10i(_scale.priceDecimals));
+    const double qtyUnit = static_cast<double>(pow10i(_scale.qtyDecimals));
+    res.filledQty = filled;
+    res.notional = notional / (priceUnit * qtyUnit);
+    res.avgPrice = filled > 0 ? notional / static_cast<double>(filled) / priceUnit : 0.0;
+    res.worstPrice = worst;
+    res.levels = static_cast<int>(levels);
+    res.complete = complete;
+}
+
+SweepResult OrderBook::sweepAllLocked(const SweepDepth& depth, size_t limit) const {
+    SweepResult res;
+    const SweepDepth::Prefix all = depth.prefix(limit);
+    if (all.levels > 0) {
+        finishSweep(depth.at(all.levels - 1).price, all.levels, all.qty, all.notional, false, res);
+    }
+    return res;
+}
+
+SweepResult OrderBook::sweepLocked(bool isBid, Qty qty) {
+    const SweepDepth& depth = isBid ? _sweepBids : _sweepAsks;
+    const size_t limit = static_cast<size_t>(_sweepDepth);
+    if (qty <= 0) {
+        SweepResult res;
+        res.complete = true;
+        return res;
+    }
+
+    // Primer nivel cuyo acumulado cubre qty, si est dentro de la profundidad
+    SweepDepth::Prefix before;
+    Level level{};
+    if (!depth.findQty(qty, before, level) || before.levels >= limit) {
+        return sweepAllLocked(depth, limit);
+    }
+
+    SweepResult res;
+    const double partial = static_cast<double>(qty - before.qty);
+    finishSweep(level.price, before.levels + 1, qty,
+        before.notional + static_cast<double>(level.price) * partial, true, res);
+    return res;
+}
+
+SweepResult OrderBook::sweepQuoteLocked(bool isBid, double notional) {
+    const SweepDepth& depth = isBid ? _sweepBids : _sweepAsks;
+    const size_t limit = static_cast<size_t>(_sweepDepth);
+    SweepResult res;
+    if (notional <= 0.0) {
+        res.complete = true;
+        return res;
+    }
+
+    SweepDepth::Prefix before;
+    Level level{};
+    if (!depth.findNotional(notional, before, level) || before.levels >= limit) {
+        return sweepAllLocked(depth, limit);
+    }
+
+    // En ese nivel entra lo que alcance del resto, en lotes enteros (con
+    // tolerancia al error del double: 3 lotes no deben quedar en 2.9999)
+    const double price = static_cast<double>(level.price);
+    const Qty partial = std::min(level.qty,
+        static_cast<Qty>(std::floor((notional - before.notional) / price * (1.0 + 1e-12))));
+    res.complete = true;
+    if (partial <= 0) {
+        // No alcanza ni para un lote del nivel: termina en el anterior
+        if (before.levels > 0) {
+            finishSweep(depth.at(before.levels - 1).price, before.levels, before.qty, before.notional, true, res);
+        }
+        return res;
+    }
+    finishSweep(level.price, before.levels + 1, before.qty + partial,
+        before.notional + price * static_cast<double>(partial), true, res);
+    return res;
+}
+
+SweepResult OrderBook::sweep(SweepSide side, Qty qty) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return sweepLocked(side == SweepSide::Sell, qty);
+}
+
+SweepResult OrderBook::sweepQuote(SweepSide side, double quote) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    // quote en decimal -> unidades de precio * cantidad en punto fijo
+    const double unit = static_cast<double>(pow10i(_scale.priceDecimals)) * static_cast<double>(pow10i(_scale.qtyDecimals));
+    return sweepQuoteLocked(side == SweepSide::Sell, quote * unit);
+}
+
+void OrderBook::sweepBatch(SweepSide side, const Qty* qty, size_t count, SweepResult* out) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    const bool isBid = side == SweepSide::Sell;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = sweepLocked(isBid, qty[i]);
+    }
 }
 
 bool OrderBook::isSane() const {
     std::lock_guard<std::mutex> lock(_mtx);
 
-    if (_bids.empty() || _asks.empty())
+    if (_bids->empty() || _asks->empty())
         return true; // libro vaco = sin datos, no necesariamente invlido
 
-    double bestBidPrice = _bids.begin()->first;
-    double bestAskPrice = _asks.begin()->first;
+    Price bestBidPrice = _bids->best().price;
+    Price bestAskPrice = _asks->best().price;
 
     // validacin bsica de integridad
-    if (bestBidPrice <= 0.0 || bestAskPrice <= 0.0)
+    if (bestBidPrice <= 0 || bestAskPrice <= 0)
         return false;
 
     //// bid nunca puede ser igual o mayor al ask
@@ -118,6 +345,66 @@ bool OrderBook::isSane() const {
 
 void OrderBook::clearAll() {
     std::lock_guard<std::mutex> lock(_mtx);
-    _bids.clear();
-    _asks.clear();
+    _bids->clear();
+    _asks->clear();
+    _sweepBids.clear();
+    _sweepAsks.clear();
+    _topDirty = true;
+    refreshTopLocked();
+    markChangedLocked();
+}
+
+void OrderBook::loadSnapshot(const DepthSnapshot& snap) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _bids->clear();
+    _asks->clear();
+    _sweepBids.clear();
+    _sweepAsks.clear();
+
+    for (const auto& [price, quantity] : snap.bids) {
+        if (price <= 0 || quantity <= 0) continue;
+        _bids->set(price, quantity);
+        if (_sweepDepth > 0) _sweepBids.set(price, quantity);
+    }
+    for (const auto& [price, quantity] : snap.asks) {
+        if (price <= 0 || quantity <= 0) continue;
+        _asks->set(price, quantity);
+        if (_sweepDepth > 0) _sweepAsks.set(price, quantity);
+    }
+
+    trimLocked();
+    _topDirty = true;
+    refreshTopLocked();
+    _lastUpdate = UpdateStamp{};
+    markChangedLocked();
+}
+
+void OrderBook::swapLevels(OrderBook& other) {
+    if (&other == this) return;
+    std::scoped_lock lock(_mtx, other._mtx);
+    std::swap(_bids, other._bids);
+    std::swap(_asks, other._asks);
+    std::swap(_lastUpdate, other._lastUpdate);
+
+    // Las copias de barrido van con sus niveles; si solo uno de los dos las
+    // lleva, se rehacen
+    std::swap(_sweepBids, other._sweepBids);
+    std::swap(_sweepAsks, other._sweepAsks);
+    if ((_sweepDepth > 0) != (other._sweepDepth > 0)) {
+        rebuildSweepLocked();
+        other.rebuildSweepLocked();
+    }
+
+    // Cada libro conserva su tamao de cache: se recalculan con los niveles nuevos
+    _topDirty = other._topDirty = true;
+    refreshTopLocked();
+    other.refreshTopLocked();
+    markChangedLocked();
+}
+
+void OrderBook::markChangedLocked() {
+    _version.store(_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if (IdleWaiter* waiter = _changeWaiter.load(std::memory_order_acquire)) {
+        waiter->notify();
+    }
 }
\ No newline at end of file
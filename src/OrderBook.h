@@ -1,54 +1,201 @@
 #pragma once
-#include <map>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
-#include <functional>
+#include <cstdint>
 
-struct Level {
-    double price;
-    double qty;
+#include "FixedPoint.h"
+#include "BookSide.h"
+#include "SweepDepth.h"
+#include "IdleStrategy.h"
+
+// Marcas del último depth update aplicado (--latency; 0 = sin medir)
+struct UpdateStamp {
+    uint64_t eventTimeMs = 0; // E del exchange
+    int64_t recvNs = 0;       // latencyNowNs() al recibir el frame
+    int64_t appliedNs = 0;    // latencyNowNs() al aplicarlo al libro
 };
 
 struct BookSnapshot {
     std::string symbol;
-    double bestBidPx = 0.0;
-    double bestBidQty = 0.0;
-    double bestAskPx = 0.0;
-    double bestAskQty = 0.0;
+    SymbolScale scale;   // para convertir a decimal al publicar
+    Price bestBidPx = 0;
+    Qty bestBidQty = 0;
+    Price bestAskPx = 0;
+    Qty bestAskQty = 0;
     std::vector<Level> topBids;
     std::vector<Level> topAsks;
+    UpdateStamp lastUpdate;
 };
 
 struct DepthUpdate {
     uint64_t firstUpdateId; // U
     uint64_t lastUpdateId;  // u
-    std::vector<std::pair<double, double>> bids; // price, qty
-    std::vector<std::pair<double, double>> asks; // price, qty
+    uint64_t eventTimeMs = 0; // E (ms epoch; 0 si el frame no lo trae)
+    // Marcas de latencyNowNs() en el camino del update (--latency; 0 = sin medir)
+    int64_t recvNs = 0;
+    int64_t parsedNs = 0;
+    int64_t enqueuedNs = 0;
+    std::vector<std::pair<Price, Qty>> bids; // price, qty
+    std::vector<std::pair<Price, Qty>> asks; // price, qty
+};
+
+// Lado del libro que consume un barrido (OrderBook::sweep)
+enum class SweepSide {
+    Buy, // compra: consume asks desde el mejor
+    Sell // venta: consume bids desde el mejor
+};
+
+// Resultado de barrer el libro con una orden a mercado
+struct SweepResult {
+    Qty filledQty = 0;      // base ejecutada (unidades de qty)
+    double notional = 0.0;  // quote pagada / recibida, en decimal
+    double avgPrice = 0.0;  // precio promedio de ejecución, en decimal (0 = nada)
+    Price worstPrice = 0;   // precio del último nivel tocado (0 = nada)
+    int levels = 0;         // niveles consumidos (el último puede ser parcial)
+    bool complete = false;  // false: la profundidad de barrido no alcanzó
+};
+
+// Snapshot REST de /api/v3/depth ya en punto fijo (ver parseDepthSnapshot)
+struct DepthSnapshot {
+    uint64_t lastUpdateId = 0;
+    std::vector<std::pair<Price, Qty>> bids; // price, qty
+    std::vector<std::pair<Price, Qty>> asks; // price, qty
 };
 
 class OrderBook {
 public:
-    explicit OrderBook(std::string sym);
+    // engine elige el almacenamiento de niveles (std::map o escalera por tick)
+    explicit OrderBook(std::string sym, SymbolScale scale = {}, BookEngine engine = BookEngine::Map);
 
-    void applyBidLevel(double px, double qty);
-    void applyAskLevel(double px, double qty);
+    void applyBidLevel(Price px, Qty qty);
+    void applyAskLevel(Price px, Qty qty);
 
     // aplica un update incremental (bids/asks)
-    void applyDepthDelta(const DepthUpdate& up);
+    // appliedNs: marca de aplicación para UpdateStamp (0 = sin medir)
+    void applyDepthDelta(const DepthUpdate& up, int64_t appliedNs = 0);
 
     BookSnapshot snapshot(int topN);
+
+    // Como snapshot() pero sobre un BookSnapshot del llamador: symbol y los
+    // vectores conservan su capacidad, así que en régimen no reserva memoria.
+    // Con topN <= topN() copia el cache (un memcpy por lado) sin recorrer el libro.
+    void snapshotInto(int topN, BookSnapshot& out);
+
+    // Hasta n niveles por lado (del mejor al peor) en vectores del llamador,
+    // que conservan su capacidad entre llamadas (publicación en memoria compartida)
+    void topLevels(int n, std::vector<Level>& bids, std::vector<Level>& asks);
+
+    // Tamaño del cache de top-N (0 = sin cache). El libro mantiene los n
+    // mejores niveles de cada lado en arrays de capacidad fija: un update que
+    // cambia la cantidad de un nivel cacheado lo corrige en el lugar, uno que
+    // agrega o quita un nivel dentro del top lo recalcula y uno que cae más
+    // abajo no lo toca. Llamar antes de publicar (cualquier hilo).
+    void setTopN(int n);
+    int topN() const { return _topN; }
+
+    // Niveles por lado que puede consumir un barrido (0 = sin barridos).
+    // Independiente del cache de top-N: con n > 0 el libro lleva una copia de
+    // cada lado con sumas de cantidad y notional (SweepDepth) que cada update
+    // corrige en O(log n) por nivel. Llamar antes de cargar el libro.
+    void setSweepDepth(int n);
+    int sweepDepth() const { return _sweepDepth; }
+
+    // Costo de barrer un lado con una orden a mercado de qty (base) o de
+    // quote (monto en decimal de la moneda quote), sobre los sweepDepth()
+    // mejores niveles: si no alcanzan, el resultado queda incompleto.
+    // O(log n) por consulta, sin copiar niveles ni recalcular nada.
+    SweepResult sweep(SweepSide side, Qty qty);
+    SweepResult sweepQuote(SweepSide side, double quote);
+
+    // Muchos tamaños de una vez (un solo lock): out[i] para qty[i]
+    void sweepBatch(SweepSide side, const Qty* qty, size_t count, SweepResult* out);
+
     bool isSane() const;
     void clearAll();
 
+    // Reemplaza todo el contenido por el del snapshot en una sola sección
+    // crítica (un solo aviso al publicador) y recorta a maxDepth().
+    void loadSnapshot(const DepthSnapshot& snap);
+
+    // Reemplaza los niveles por los de other (mismo símbolo, escala y motor)
+    // en una sola sección crítica: los lectores ven el libro viejo o el nuevo,
+    // nunca uno vacío o a medio cargar (resync de BookSyncWorker). other se
+    // queda con los niveles viejos.
+    void swapLevels(OrderBook& other);
+
+    // Escala de precio/cantidad del símbolo (inmutable)
+    const SymbolScale& scale() const { return _scale; }
+
+    // Motor de niveles con el que se creó (para armar un libro gemelo)
+    BookEngine engine() const { return _engine; }
+
+    // Tope de niveles por lado (0 = sin tope): después de cada snapshot y
+    // de cada update se descartan los peores que lo excedan. Con el tope en
+    // la profundidad del snapshot no quedan niveles lejanos que solo conocen
+    // los deltas (huecos falsos). Llamar antes de cargar el libro.
+    void setMaxDepth(size_t levels) { _maxDepth = levels; }
+    size_t maxDepth() const { return _maxDepth; }
+
+    // Contador de cambios: sube en cada mutación. El Publisher (--publish=changes)
+    // lo compara con el último publicado para saber si el símbolo está sucio.
+    uint64_t version() const { return _version.load(std::memory_order_acquire); }
+
+    // A quién despertar en cada mutación (nullptr = nadie)
+    void setChangeWaiter(IdleWaiter* waiter) { _changeWaiter.store(waiter, std::memory_order_release); }
+
 private:
+    // Con _mtx tomado: marca el cambio y avisa al publicador
+    void markChangedLocked();
+
+    // Con _mtx tomado, después de set(px, qty) en un lado: corrige el cache
+    // en el lugar o lo marca para recalcular (_topDirty)
+    void touchTopLocked(bool isBid, Price px, Qty qty);
+    // Con _mtx tomado: recalcula el cache si quedó marcado
+    void refreshTopLocked();
+    // Con _mtx tomado: aplica _maxDepth (marca el cache si recortó dentro del top)
+    void trimLocked();
+
+    // Con _mtx tomado: rehace las copias de barrido desde los lados
+    // (vacías si sweepDepth() == 0)
+    void rebuildSweepLocked();
+    SweepResult sweepLocked(bool isBid, Qty qty);
+    SweepResult sweepQuoteLocked(bool isBid, double notional);
+    // Resultado incompleto: todo lo que hay hasta sweepDepth() niveles
+    SweepResult sweepAllLocked(const SweepDepth& depth, size_t limit) const;
+    // Completa res con lo ejecutado hasta el nivel worst (levels niveles)
+    void finishSweep(Price worst, size_t levels, Qty filled, double notional,
+        bool complete, SweepResult& res) const;
+
     std::string _symbol;
+    SymbolScale _scale;
+    BookEngine _engine;
+    size_t _maxDepth = 0;
 
     // price -> qty
-    std::map<double, double, std::greater<double>> _bids; // descendente: begin() = best bid
-    std::map<double, double> _asks;                       // ascendente:  begin() = best ask
+    std::unique_ptr<BookSide> _bids; // best() = best bid (precio más alto)
+    std::unique_ptr<BookSide> _asks; // best() = best ask (precio más bajo)
 
 
 
     mutable std::mutex _mtx;
+
+    UpdateStamp _lastUpdate;
+
+    // Cache de top-N (capacidad _topN, del mejor al peor). Fuera de _mtx
+    // siempre está al día; _topDirty solo vale durante una mutación.
+    int _topN = 0;
+    std::vector<Level> _topBids;
+    std::vector<Level> _topAsks;
+    bool _topDirty = false;
+
+    // Copias de los lados para los barridos (solo con _sweepDepth > 0)
+    int _sweepDepth = 0;
+    SweepDepth _sweepBids{ /*isBid*/ true };
+    SweepDepth _sweepAsks{ /*isBid*/ false };
+
+    std::atomic<uint64_t> _version{ 0 };
+    std::atomic<IdleWaiter*> _changeWaiter{ nullptr };
 };
\ No newline at end of file
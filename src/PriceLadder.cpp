@@ -0,0 +1,275 @@
+#include "PriceLadder.h"
+
+#include <iterator>
+#include <numeric>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Índice del bit menos / más significativo en 1. Precondición: v != 0.
+inline int lowestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return static_cast<int>(i);
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+inline int highestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return static_cast<int>(i);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+} // namespace
+
+PriceLadder::PriceLadder(bool isBid, Price tickHint, size_t window)
+    : _isBid(isBid)
+    , _tick(tickHint > 0 ? tickHint : 0)
+    , _window(static_cast<int64_t>(window < 64 ? 64 : (window + 63) / 64 * 64))
+    , _qty(static_cast<size_t>(_window), 0)
+    , _bits(static_cast<size_t>(_window / 64), 0)
+{
+}
+
+void PriceLadder::set(Price px, Qty qty) {
+    if (px <= 0) return;
+
+    if (_tick == 0) {
+        if (qty == 0) return; // borrar algo que nunca existió
+        _tick = px;
+    }
+    else if (px % _tick != 0) {
+        // Un precio que no es múltiplo del tick actual no puede estar en el libro
+        if (qty == 0) return;
+        retick(std::gcd(_tick, px));
+    }
+
+    setIndexed(px, qty);
+}
+
+void PriceLadder::setIndexed(Price px, Qty qty) {
+    const int64_t idx = px / _tick;
+
+    if (!_anchored) {
+        if (qty == 0) {
+            _sparse.erase(px);
+            return;
+        }
+        recenter(idx);
+    }
+
+    int64_t slot = idx - _base;
+    if (slot < 0 || slot >= _window) {
+        // Nivel mejor que toda la ventana (o ventana vacía): pasa a ser el
+        // mejor precio, recentramos
+        const bool betterSide = _isBid ? (slot >= _window) : (slot < 0);
+        if (qty != 0 && (betterSide || _windowCount == 0)) {
+            recenter(idx);
+            slot = idx - _base;
+        }
+        else {
+            if (qty == 0)
+                _sparse.erase(px);
+            else
+                _sparse[px] = qty;
+            return;
+        }
+    }
+
+    setSlot(slot, qty);
+}
+
+void PriceLadder::setSlot(int64_t slot, Qty qty) {
+    const size_t s = static_cast<size_t>(slot);
+    const bool had = _qty[s] != 0;
+    _qty[s] = qty;
+
+    if (qty != 0) {
+        if (!had) {
+            _bits[s >> 6] |= (1ULL << (s & 63));
+            ++_windowCount;
+        }
+        if (_bestSlot < 0 || betterSlot(slot, _bestSlot)) {
+            _bestSlot = slot;
+        }
+    }
+    else if (had) {
+        _bits[s >> 6] &= ~(1ULL << (s & 63));
+        --_windowCount;
+        if (slot == _bestSlot) {
+            _bestSlot = nextWorseSlot(slot);
+        }
+        if (_windowCount == 0 && !_sparse.empty()) {
+            // Ventana vacía: la traemos al mejor nivel del disperso
+            Price bestPx = _isBid ? _sparse.rbegin()->first : _sparse.begin()->first;
+            recenter(bestPx / _tick);
+            return;
+        }
+    }
+
+    // Si el mejor precio se acerca al borde "peor" de la ventana, recentramos
+    // para que los niveles nuevos alrededor del mejor sigan cayendo en el array.
+    if (_bestSlot >= 0) {
+        const int64_t margin = _window / 8;
+        const bool nearEdge = _isBid ? (_bestSlot < margin) : (_bestSlot >= _window - margin);
+        if (nearEdge) {
+            recenter(_base + _bestSlot);
+        }
+    }
+}
+
+int64_t PriceLadder::scanDown(int64_t s) const {
+    if (s < 0) return -1;
+    if (s >= _window) s = _window - 1;
+
+    int64_t word = s >> 6;
+    const int bit = static_cast<int>(s & 63);
+    uint64_t mask = _bits[static_cast<size_t>(word)] & (bit == 63 ? ~0ULL : ((1ULL << (bit + 1)) - 1));
+    while (true) {
+        if (mask) return (word << 6) + highestBit(mask);
+        if (--word < 0) return -1;
+        mask = _bits[static_cast<size_t>(word)];
+    }
+}
+
+int64_t PriceLadder::scanUp(int64_t s) const {
+    if (s >= _window) return -1;
+    if (s < 0) s = 0;
+
+    const int64_t words = _window >> 6;
+    int64_t word = s >> 6;
+    uint64_t mask = _bits[static_cast<size_t>(word)] & (~0ULL << (s & 63));
+    while (true) {
+        if (mask) return (word << 6) + lowestBit(mask);
+        if (++word >= words) return -1;
+        mask = _bits[static_cast<size_t>(word)];
+    }
+}
+
+int64_t PriceLadder::nextWorseSlot(int64_t from) const {
+    return _isBid ? scanDown(from - 1) : scanUp(from + 1);
+}
+
+int64_t PriceLadder::findBestSlot() const {
+    return _isBid ? scanDown(_window - 1) : scanUp(0);
+}
+
+void PriceLadder::recenter(int64_t centerIdx) {
+    // 1) Volcar la ventana actual al disperso (recorriendo solo slots ocupados)
+    if (_anchored) {
+        for (size_t w = 0; w < _bits.size(); ++w) {
+            uint64_t mask = _bits[w];
+            while (mask) {
+                const size_t s = (w << 6) + static_cast<size_t>(lowestBit(mask));
+                mask &= mask - 1;
+                _sparse[(_base + static_cast<int64_t>(s)) * _tick] = _qty[s];
+                _qty[s] = 0;
+            }
+            _bits[w] = 0;
+        }
+    }
+    _windowCount = 0;
+
+    // 2) Nueva ventana centrada en centerIdx
+    _base = centerIdx - _window / 2;
+    _anchored = true;
+
+    // 3) Traer del disperso lo que ahora cae dentro de la ventana
+    auto first = _sparse.lower_bound(_base * _tick);
+    auto last = _sparse.lower_bound((_base + _window) * _tick);
+    for (auto it = first; it != last; ++it) {
+        const size_t s = static_cast<size_t>(it->first / _tick - _base);
+        _qty[s] = it->second;
+        _bits[s >> 6] |= (1ULL << (s & 63));
+        ++_windowCount;
+    }
+    _sparse.erase(first, last);
+
+    _bestSlot = findBestSlot();
+}
+
+void PriceLadder::retick(Price newTick) {
+    std::vector<Level> all;
+    all.reserve(size());
+    top(static_cast<int>(size()), all);
+
+    clear();
+    _tick = newTick;
+    for (const auto& lvl : all) {
+        setIndexed(lvl.price, lvl.qty);
+    }
+}
+
+void PriceLadder::clear() {
+    for (size_t w = 0; w < _bits.size(); ++w) {
+        uint64_t mask = _bits[w];
+        while (mask) {
+            _qty[(w << 6) + static_cast<size_t>(lowestBit(mask))] = 0;
+            mask &= mask - 1;
+        }
+        _bits[w] = 0;
+    }
+    _windowCount = 0;
+    _bestSlot = -1;
+    _anchored = false;
+    _sparse.clear();
+}
+
+bool PriceLadder::empty() const {
+    return _windowCount == 0 && _sparse.empty();
+}
+
+size_t PriceLadder::size() const {
+    return _windowCount + _sparse.size();
+}
+
+Level PriceLadder::best() const {
+    if (_bestSlot >= 0) {
+        return Level{ (_base + _bestSlot) * _tick, _qty[static_cast<size_t>(_bestSlot)] };
+    }
+    auto& kv = _isBid ? *_sparse.rbegin() : *_sparse.begin();
+    return Level{ kv.first, kv.second };
+}
+
+void PriceLadder::trimTo(size_t maxLevels) {
+    while (size() > maxLevels) {
+        // Los peores están en el disperso; si está vacío, en el borde peor de la ventana
+        if (!_sparse.empty()) {
+            _sparse.erase(_isBid ? _sparse.begin() : std::prev(_sparse.end()));
+            continue;
+        }
+        setSlot(_isBid ? scanUp(0) : scanDown(_window - 1), 0);
+    }
+}
+
+void PriceLadder::top(int n, std::vector<Level>& out) const {
+    int count = 0;
+
+    // Primero la ventana, del mejor slot hacia el peor
+    for (int64_t slot = _bestSlot; slot >= 0 && count < n; slot = nextWorseSlot(slot)) {
+        out.push_back(Level{ (_base + slot) * _tick, _qty[static_cast<size_t>(slot)] });
+        ++count;
+    }
+
+    // Después el disperso: todos sus niveles son peores que la ventana
+    if (_isBid) {
+        for (auto it = _sparse.rbegin(); it != _sparse.rend() && count < n; ++it, ++count) {
+            out.push_back(Level{ it->first, it->second });
+        }
+    }
+    else {
+        for (auto it = _sparse.begin(); it != _sparse.end() && count < n; ++it, ++count) {
+            out.push_back(Level{ it->first, it->second });
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "BookSide.h"
+
+// -----------------------------------------------------------------------------
+// PriceLadder
+// -----------------------------------------------------------------------------
+// Lado del libro implementado como escalera de precios contigua indexada por
+// tick, alternativa a std::map (--book=ladder).
+//
+// - Ventana de `window` ticks centrada en el mejor precio: un array de
+//   cantidades + un bitmap de niveles ocupados. set() es O(1) y el mejor
+//   precio se mantiene escaneando el bitmap de a 64 niveles por palabra.
+// - Los niveles fuera de la ventana (lejos del mejor precio) van a un
+//   std::map disperso. Invariante: el disperso solo tiene niveles del lado
+//   "peor" de la ventana, así que nunca compite por el mejor precio.
+// - Si llega un nivel mejor que la ventana, o el mejor precio se acerca al
+//   borde peor, la ventana se recentra (O(niveles en ventana)).
+// - El tick se toma de SymbolScale::tickSize; si es desconocido (o los precios
+//   no son múltiplos de él) se deduce como el MCD de los precios vistos y la
+//   escalera se reconstruye. Esto solo pasa en los primeros updates.
+//
+// No es thread-safe: OrderBook lo protege con su propio mutex.
+// -----------------------------------------------------------------------------
+class PriceLadder : public BookSide {
+public:
+    static constexpr size_t kDefaultWindow = 4096; // potencia de 2
+
+    PriceLadder(bool isBid, Price tickHint, size_t window = kDefaultWindow);
+
+    void set(Price px, Qty qty) override;
+    void clear() override;
+    bool empty() const override;
+    size_t size() const override;
+    Level best() const override;
+    void top(int n, std::vector<Level>& out) const override;
+    void trimTo(size_t maxLevels) override;
+
+private:
+    // slot a es mejor que slot b (bids: más alto, asks: más bajo)
+    bool betterSlot(int64_t a, int64_t b) const { return _isBid ? a > b : a < b; }
+
+    void setIndexed(Price px, Qty qty);
+    void setSlot(int64_t slot, Qty qty);
+
+    // Próximo slot ocupado peor que `from` (exclusivo), -1 si no hay.
+    int64_t nextWorseSlot(int64_t from) const;
+    // Mejor slot ocupado de la ventana, -1 si está vacía.
+    int64_t findBestSlot() const;
+
+    // Mayor slot ocupado <= s / menor slot ocupado >= s; -1 si no hay.
+    int64_t scanDown(int64_t s) const;
+    int64_t scanUp(int64_t s) const;
+
+    // Vuelca la ventana al disperso y la re-ubica centrada en centerIdx.
+    void recenter(int64_t centerIdx);
+    // Cambia el tick y reconstruye toda la escalera.
+    void retick(Price newTick);
+
+    bool _isBid;
+    Price _tick;          // unidades de precio por slot (0 = todavía desconocido)
+    int64_t _window;      // cantidad de slots de la ventana
+    int64_t _base = 0;    // índice de tick (px / _tick) del slot 0
+    bool _anchored = false;
+
+    std::vector<Qty> _qty;       // cantidad por slot (0 = vacío)
+    std::vector<uint64_t> _bits; // bit por slot ocupado
+    size_t _windowCount = 0;
+    int64_t _bestSlot = -1;
+
+    std::map<Price, Qty> _sparse; // niveles fuera de la ventana (ascendente)
+};
@@ -1,131 +1,328 @@
 #include "Publisher.h"
 #include "Utils.h"
+#include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <chrono>
+#include <climits>
 #include <thread>
-#include <iomanip>
 
 Publisher::Publisher(
     std::unordered_map<std::string, std::shared_ptr<OrderBook>> books,
     std::unordered_map<std::string, std::shared_ptr<TradeStats>> trades,
     int topN,
-    const std::string& logPath
+    const std::string& logPath,
+    OutputFormat format,
+    const LogWriterConfig& logConfig,
+    const PublishConfig& publishConfig,
+    std::vector<std::shared_ptr<SyntheticBook>> synthetic
 )
-    : _books(std::move(books))
-    , _trades(std::move(trades))
-    , _topN(topN)
+    : _topN(topN)
+    , _snapshotLevels(topN)
     , _logPath(logPath)
+    , _format(format)
+    , _logConfig(logConfig)
+    , _publishConfig(publishConfig)
+    , _synthetic(std::move(synthetic))
 {
+    // Los implcitos entran a la tabla como un smbolo ms
+    for (const auto& syn : _synthetic) {
+        books[syn->name()] = syn->book();
+    }
+
+    // ids estables entre corridas con los mismos smbolos
+    for (const auto& kv : books) {
+        _symbols.push_back(SnapshotSymbol{ kv.first, kv.second->scale() });
+    }
+    std::sort(_symbols.begin(), _symbols.end(),
+        [](const SnapshotSymbol& a, const SnapshotSymbol& b) { return a.name < b.name; });
+
+    _state.resize(_symbols.size());
+    for (size_t i = 0; i < _symbols.size(); ++i) {
+        _state[i].book = books[_symbols[i].name];
+        auto it = trades.find(_symbols[i].name);
+        if (it != trades.end()) {
+            _state[i].trades = it->second;
+        }
+    }
 }
 
-void Publisher::start() {
-    if (!_logPath.empty()) {
-        _file.open(_logPath, std::ios::out | std::ios::app);
+void Publisher::start(bool periodic) {
+    if (_format == OutputFormat::Binary) {
+        // parseArgs exige --log con --format=binary; cada archivo (tambin
+        // los rotados) empieza con la cabecera. Si ya hay una captura en
+        // --log (reinicio) se mueve aparte en lugar de truncarla.
+        _encoder = std::make_unique<SnapshotRecordEncoder>(_topN, _symbols,
+            _analytics ? _analytics->bands() : std::vector<int>{}, _horizonsMs);
+        _out = std::make_unique<LogWriter>(_logPath, _logConfig, _encoder->header(), /*fresh*/ true);
+    }
+    else {
+        // vaco = stdout
+        _out = std::make_unique<LogWriter>(_logPath, _logConfig);
     }
     _running = true;
-    _thr = std::thread(&Publisher::run, this);
+    if (periodic) {
+        if (_publishConfig.mode == PublishMode::Changes) {
+            setChangeWaiters(&_changes);
+        }
+        _thr = std::thread(&Publisher::run, this);
+    }
 }
 
 void Publisher::stop() {
     _running = false;
+    _changes.wakeAll();
     if (_thr.joinable()) {
         _thr.join();
     }
-    if (_file.is_open()) {
-        _file.close();
+    setChangeWaiters(nullptr);
+    if (_out) {
+        _out->stop();
+    }
+}
+
+void Publisher::measureTo(const LatencyMonitor* monitor) {
+    for (size_t i = 0; i < _state.size(); ++i) {
+        _state[i].latency = monitor ? monitor->find(_symbols[i].name) : nullptr;
+    }
+}
+
+void Publisher::analyzeDepth(const AnalyticsConfig& config) {
+    if (config.bandsBps.empty()) {
+        return;
+    }
+    _analytics = std::make_unique<BookAnalytics>(config);
+    _snapshotLevels = std::max(_topN, _analytics->levels());
+    _row.analytics = true;
+}
+
+void Publisher::publishHorizons(const std::vector<int64_t>& horizonsMs) {
+    if (horizonsMs.empty()) {
+        return;
+    }
+    _horizonsMs = horizonsMs;
+    _row.tradeHorizons = true;
+    _row.horizons.resize(_horizonsMs.size());
+}
+
+void Publisher::setChangeWaiters(IdleWaiter* waiter) {
+    for (auto& s : _state) {
+        s.book->setChangeWaiter(waiter);
+        if (s.trades) {
+            s.trades->setChangeWaiter(waiter);
+        }
     }
 }
 
 void Publisher::run() {
+    if (_publishConfig.mode == PublishMode::Changes) {
+        runChanges();
+    }
+    else {
+        runHeartbeat();
+    }
+}
+
+void Publisher::runHeartbeat() {
+    while (_running) {
+        publishOnce(nowUnixSeconds());
+        std::this_thread::sleep_for(std::chrono::milliseconds(_publishConfig.heartbeatMs));
+    }
+}
+
+void Publisher::runChanges() {
     using namespace std::chrono_literals;
 
     while (_running) {
+        bool throttled = false;
+        const int64_t waitMs = publishChanged(nowUnixSeconds(), throttled);
 
-        for (auto& kv : _books) {
-            const std::string& sym = kv.first;
-            auto& bookPtr = kv.second;
+        // Nunca ms de 100ms sin mirar _running
+        const auto timeout = waitMs < 0
+            ? 100ms
+            : std::chrono::milliseconds(std::min<int64_t>(std::max<int64_t>(waitMs, 1), 100));
 
-            // Snapshot consistente del libro (topN niveles, best bid/ask, etc.)
-            auto snapBook = bookPtr->snapshot(_topN);
+        if (throttled) {
+            // Ya hay cambios esperando su intervalo: lo que llegue mientras
+            // tanto se junta en la misma fila
+            std::this_thread::sleep_for(timeout);
+        }
+        else {
+            _changes.idle([this] { return anyDirty() || !_running; }, timeout);
+        }
+    }
+}
 
-            // Snapshot consistente de trade metrics (ltimo trade, VWAP sesin)
-            TradeSnapshot snapTrade;
-            if (_trades.count(sym)) {
-                snapTrade = _trades[sym]->snapshot();
-            }
+void Publisher::publishTick(double ts) {
+    if (_publishConfig.mode == PublishMode::Changes) {
+        bool throttled = false;
+        publishChanged(ts, throttled);
+    }
+    else {
+        publishOnce(ts);
+    }
+}
 
-            // mid y spread
-            double mid = (snapBook.bestBidPx > 0.0 && snapBook.bestAskPx > 0.0)
-                ? (snapBook.bestBidPx + snapBook.bestAskPx) / 2.0
-                : 0.0;
+void Publisher::refreshSynthetic() {
+    for (const auto& syn : _synthetic) {
+        syn->refresh();
+    }
+}
 
-            double spread = (snapBook.bestBidPx > 0.0 && snapBook.bestAskPx > 0.0)
-                ? (snapBook.bestAskPx - snapBook.bestBidPx)
-                : 0.0;
+void Publisher::publishOnce(double ts) {
+    refreshSynthetic();
+    for (size_t i = 0; i < _state.size(); ++i) {
+        emit(i, ts);
+    }
 
-            // imbalance (profundidad relativa de bids vs asks en topN)
-            double bidDepthSum = 0.0;
-            for (auto& lvl : snapBook.topBids) bidDepthSum += lvl.qty;
-            double askDepthSum = 0.0;
-            for (auto& lvl : snapBook.topAsks) askDepthSum += lvl.qty;
+    // Una pasada = un lote para el writer (sin syscalls en este hilo)
+    _out->commit();
+}
 
-            double imb = 0.0;
-            if (bidDepthSum + askDepthSum > 0.0) {
-                imb = bidDepthSum / (bidDepthSum + askDepthSum);
-            }
+int64_t Publisher::publishChanged(double ts, bool& throttled) {
+    const int64_t nowMs = static_cast<int64_t>(ts * 1000.0);
+    const int64_t heartbeatMs = _publishConfig.heartbeatMs;
+    int64_t nextDueMs = LLONG_MAX;
+    bool wrote = false;
+    throttled = false;
 
-            // timestamp epoch con decimales
-            double ts = nowUnixSeconds();
-
-            // helper para serializar niveles: "price:qty|price:qty|..."
-            auto vecToStr = [](const std::vector<Level>& v) {
-                std::ostringstream oss;
-                oss << std::fixed << std::setprecision(6);
-                for (size_t i = 0; i < v.size(); ++i) {
-                    oss << v[i].price << ":" << v[i].qty;
-                    if (i + 1 < v.size()) oss << "|";
-                }
-                return oss.str();
-                };
-
-            // armar CSV
-            std::ostringstream line;
-            line << std::fixed << std::setprecision(6);
-
-            line
-                << ts << ","
-                << sym << ","
-                << mid << ","
-                << spread << ","
-                << snapBook.bestBidPx << ","
-                << snapBook.bestBidQty << ","
-                << snapBook.bestAskPx << ","
-                << snapBook.bestAskQty << ","
-                << vecToStr(snapBook.topBids) << ","
-                << vecToStr(snapBook.topAsks) << ","
-                << snapTrade.last.price << ","
-                << snapTrade.last.qty << ","
-                << (snapTrade.last.side.empty() ? "none" : snapTrade.last.side) << ","
-                << snapTrade.vwapWindow << ","
-                << snapTrade.vwapSession << ","
-                << imb;
-
-             //validacin bsica del libro (best_bid < best_ask, etc.)
-            if (!bookPtr->isSane()) {
-                std::cerr << "[WARN] book inconsistente para " << sym << "\n";
-            }
+    refreshSynthetic();
 
-            std::string outLine = line.str();
+    for (size_t i = 0; i < _state.size(); ++i) {
+        const SymbolState& s = _state[i];
 
-            if (_file.is_open()) {
-                _file << outLine << "\n";
-                _file.flush();
+        int64_t dueMs = LLONG_MAX;
+        bool dirty = false;
+        if (isDirty(s)) {
+            dirty = true;
+            dueMs = s.emitted ? s.lastEmitMs + _publishConfig.minIntervalMs : nowMs;
+        }
+        else if (heartbeatMs > 0) {
+            dueMs = s.emitted ? s.lastEmitMs + heartbeatMs : nowMs;
+        }
+
+        if (dueMs <= nowMs) {
+            emit(i, ts);
+            wrote = true;
+            if (heartbeatMs > 0) {
+                nextDueMs = std::min(nextDueMs, nowMs + heartbeatMs);
             }
-            else {
-                std::cout << outLine << "\n";
+        }
+        else if (dueMs != LLONG_MAX) {
+            nextDueMs = std::min(nextDueMs, dueMs);
+            throttled = throttled || dirty;
+        }
+    }
+
+    if (wrote) {
+        _out->commit();
+    }
+    return nextDueMs == LLONG_MAX ? -1 : nextDueMs - nowMs;
+}
+
+bool Publisher::isDirty(const SymbolState& s) const {
+    return s.book->version() != s.bookVersion
+        || (s.trades && s.trades->version() != s.tradeVersion);
+}
+
+bool Publisher::anyDirty() const {
+    for (const auto& s : _state) {
+        if (isDirty(s)) return true;
+    }
+    // Una leg que ya sali en esta pasada pero cambi despus del refresh
+    for (const auto& syn : _synthetic) {
+        if (syn->stale()) return true;
+    }
+    return false;
+}
+
+void Publisher::emit(size_t symbolId, double ts) {
+    SymbolState& state = _state[symbolId];
+    const std::string& sym = _symbols[symbolId].name;
+    auto& bookPtr = state.book;
+
+    // Versiones antes del snapshot: un cambio que entre durante la copia deja
+    // el smbolo sucio para la prxima pasada (nunca se pierde)
+    state.bookVersion = bookPtr->version();
+    state.tradeVersion = state.trades ? state.trades->version() : 0;
+    state.lastEmitMs = static_cast<int64_t>(ts * 1000.0);
+    state.emitted = true;
+
+    // Snapshot consistente del libro (topN niveles, best bid/ask, etc.)
+    BookSnapshot& snapBook = _book;
+    bookPtr->snapshotInto(_snapshotLevels, snapBook);
+
+    // Mtricas sobre todos los niveles del snapshot; despus se publican
+    // solo los topN (resize no libera la capacidad)
+    if (_analytics) {
+        _analytics->compute(snapBook.topBids, snapBook.topAsks, snapBook.scale, _row.metrics);
+        if (snapBook.topBids.size() > static_cast<size_t>(_topN)) snapBook.topBids.resize(static_cast<size_t>(_topN));
+        if (snapBook.topAsks.size() > static_cast<size_t>(_topN)) snapBook.topAsks.resize(static_cast<size_t>(_topN));
+    }
+
+    // ltimo trade y VWAPs: snapshotTop es O(1) y no reserva memoria. Con
+    // --horizon-stats, las mtricas por horizonte van directo al vector de la
+    // fila (mismo lock); un smbolo sin trades (implcito) las lleva en 0.
+    TradeSnapshot snapTrade;
+    if (_row.tradeHorizons) {
+        if (state.trades) {
+            snapTrade = state.trades->snapshotTop(ts, _row.horizons);
+        }
+        else {
+            for (size_t i = 0; i < _horizonsMs.size(); ++i) {
+                _row.horizons[i] = HorizonStats{};
+                _row.horizons[i].horizonMs = _horizonsMs[i];
             }
         }
-        std::this_thread::sleep_for(1000ms);
     }
-}
\ No newline at end of file
+    else if (state.trades) {
+        snapTrade = state.trades->snapshotTop(ts);
+    }
+
+    // Fila en punto fijo: la misma para CSV y binario
+    _row.ts = ts;
+    _row.symbolId = static_cast<uint16_t>(symbolId);
+    _row.bestBidPx = snapBook.bestBidPx;
+    _row.bestBidQty = snapBook.bestBidQty;
+    _row.bestAskPx = snapBook.bestAskPx;
+    _row.bestAskQty = snapBook.bestAskQty;
+    _row.lastPx = snapTrade.last.price;
+    _row.lastQty = snapTrade.last.qty;
+    _row.lastSide = snapTrade.last.side == "buy" ? TradeSide::Buy
+        : snapTrade.last.side == "sell" ? TradeSide::Sell
+        : TradeSide::None;
+    _row.vwapWindow = snapTrade.vwapWindow;
+    _row.vwapSession = snapTrade.vwapSession;
+    _row.bids.swap(snapBook.topBids);
+    _row.asks.swap(snapBook.topAsks);
+
+     //validacin bsica del libro (best_bid < best_ask, etc.)
+    if (!bookPtr->isSane()) {
+        std::cerr << "[WARN] book inconsistente para " << sym << "\n";
+    }
+
+    _line.clear();
+    if (_encoder) {
+        _encoder->append(_line, _row);
+    }
+    else {
+        // Book y trades vienen en punto fijo: el CSV (y solo el CSV) pasa a decimal
+        appendCsvLine(_line, _symbols[symbolId], _row);
+        _line.push_back('\n');
+    }
+    _out->append(_line);
+
+    // Latencia del update ms nuevo que refleja la fila (una vez por update:
+    // un heartbeat que repite el mismo libro no vuelve a contarlo)
+    const UpdateStamp& stamp = snapBook.lastUpdate;
+    if (state.latency && stamp.appliedNs != 0 && stamp.appliedNs != state.measuredAppliedNs) {
+        const int64_t publishedNs = latencyNowNs();
+        state.latency->record(LatencyStage::AppliedToPublished, publishedNs - stamp.appliedNs);
+        state.latency->record(LatencyStage::RecvToPublished, publishedNs - stamp.recvNs);
+        if (stamp.eventTimeMs > 0) {
+            // ts es el reloj de la fila (en replay, el grabado): comparable con E
+            state.latency->record(LatencyStage::ExchangeToPublished,
+                static_cast<int64_t>(ts * 1000.0) - static_cast<int64_t>(stamp.eventTimeMs));
+        }
+        state.measuredAppliedNs = stamp.appliedNs;
+    }
+}
@@ -5,30 +5,163 @@
 #include <thread>
 #include <atomic>
 #include <memory>
-#include <fstream>
+#include <cstdint>
+#include <stdexcept>
 
 #include "OrderBook.h"
 #include "TradeStats.h"
+#include "SnapshotRecord.h"
+#include "LogWriter.h"
+#include "IdleStrategy.h"
+#include "LatencyStats.h"
+#include "SyntheticBook.h"
+#include "BookAnalytics.h"
 
+// -----------------------------------------------------------------------------
+// Cuándo publica el Publisher
+// -----------------------------------------------------------------------------
+enum class PublishMode {
+    Heartbeat, // todos los símbolos cada heartbeatMs, cambien o no (original)
+    Changes    // solo los símbolos que cambiaron, como mucho cada minIntervalMs
+};
+
+// "heartbeat" / "changes" -> PublishMode. Lanza std::runtime_error si no se reconoce.
+inline PublishMode parsePublishMode(const std::string& name) {
+    if (name == "heartbeat") return PublishMode::Heartbeat;
+    if (name == "changes") return PublishMode::Changes;
+    throw std::runtime_error("Modo de publicacion desconocido: " + name + " (usar heartbeat|changes)");
+}
+
+struct PublishConfig {
+    PublishMode mode = PublishMode::Heartbeat; // --publish=heartbeat|changes
+    int64_t minIntervalMs = 10;  // --publish-interval=10ms: mínimo entre filas del mismo símbolo (changes)
+    int64_t heartbeatMs = 1000;  // --heartbeat=1s: período (heartbeat) o silencio máximo por símbolo (changes, 0 = nunca)
+};
+
+// -----------------------------------------------------------------------------
+// Publisher
+// -----------------------------------------------------------------------------
+// Arma una fila por símbolo (libro topN + métricas de trades) y la entrega al
+// LogWriter en CSV o binario.
+//
+// Con PublishMode::Changes, OrderBook y TradeStats llevan un contador de
+// versión que sube en cada mutación y despiertan al Publisher (IdleWaiter).
+// Cada pasada emite solo los símbolos cuya versión cambió desde la última
+// fila publicada; si la anterior salió hace menos de minIntervalMs, espera,
+// así los cambios intermedios se funden en una sola fila. Un símbolo quieto
+// no genera salida salvo el heartbeat opcional.
+//
+// Los libros implícitos (SyntheticBook, --cross) se publican como un símbolo
+// más. Se refrescan en este hilo al principio de cada pasada: solo hacen algo
+// si cambió alguna de sus legs, y su versión sube solo si cambió su top.
+//
+// Con analyzeDepth (--analytics) cada fila lleva además las métricas de
+// profundidad de BookAnalytics, calculadas sobre config.levels niveles por
+// lado en el mismo snapshot que los topN publicados.
+//
+// Con publishHorizons (--horizon-stats) cada fila lleva además las métricas
+// de trades de cada horizonte (volumen, split comprador/vendedor, count,
+// VWAP, high/low), leídas bajo el mismo lock que el último trade.
+// -----------------------------------------------------------------------------
 class Publisher {
 public:
     Publisher(std::unordered_map<std::string, std::shared_ptr<OrderBook>> books,
         std::unordered_map<std::string, std::shared_ptr<TradeStats>> trades,
         int topN,
-        const std::string& logPath);
+        const std::string& logPath,
+        OutputFormat format = OutputFormat::Csv,
+        const LogWriterConfig& logConfig = {},
+        const PublishConfig& publishConfig = {},
+        std::vector<std::shared_ptr<SyntheticBook>> synthetic = {});
 
-    void start();
+    // periodic = false: solo abre la salida; el que llama decide cuándo
+    // publicar con publishOnce / publishTick (replay con el reloj del journal).
+    void start(bool periodic = true);
     void stop();
 
+    // Registra applied/recv/exchange -> published de cada símbolo en los
+    // histogramas del monitor (--latency). Llamar antes de start().
+    void measureTo(const LatencyMonitor* monitor);
+
+    // Agrega a cada fila las métricas de profundidad (ver BookAnalytics).
+    // Los libros deberían cachear config.levels niveles (OrderBook::setTopN)
+    // para que el snapshot no recorra el libro. Llamar antes de start().
+    void analyzeDepth(const AnalyticsConfig& config);
+
+    // Agrega a cada fila las métricas de trades por horizonte. horizonsMs:
+    // los de TradeWindowConfig, en su orden (vacío = no se agregan). Llamar
+    // antes de start().
+    void publishHorizons(const std::vector<int64_t>& horizonsMs);
+
+    // Publica una línea (o un registro binario) por símbolo con el timestamp indicado
+    void publishOnce(double ts);
+
+    // Una pasada según el modo: publishOnce (heartbeat) o solo los símbolos
+    // sucios cuyo intervalo ya venció (changes)
+    void publishTick(double ts);
+
 private:
+    // Estado de publicación por símbolo (índice = symbolId)
+    struct SymbolState {
+        std::shared_ptr<OrderBook> book;
+        std::shared_ptr<TradeStats> trades; // puede ser null
+        uint64_t bookVersion = 0;  // versiones de la última fila emitida
+        uint64_t tradeVersion = 0;
+        int64_t lastEmitMs = 0;
+        bool emitted = false;
+        SymbolLatency* latency = nullptr;  // nullptr = sin medir
+        int64_t measuredAppliedNs = 0;     // UpdateStamp ya registrado (no se cuenta dos veces)
+    };
+
     void run();
+    void runHeartbeat();
+    void runChanges();
+
+    // Emite los símbolos sucios con el intervalo vencido (y los heartbeats).
+    // Devuelve los ms hasta el próximo vencimiento (-1 = ninguno) y en
+    // throttled si quedó algún símbolo sucio esperando su intervalo.
+    int64_t publishChanged(double ts, bool& throttled);
+
+    // Pone al día los libros implícitos con lo que cambió en sus legs
+    void refreshSynthetic();
+
+    bool isDirty(const SymbolState& s) const;
+    bool anyDirty() const;
+    void emit(size_t symbolId, double ts);
+    void setChangeWaiters(IdleWaiter* waiter);
 
-    std::unordered_map<std::string, std::shared_ptr<OrderBook>> _books;
-    std::unordered_map<std::string, std::shared_ptr<TradeStats>> _trades;
     int _topN;
+    int _snapshotLevels; // niveles por lado del snapshot: max(topN, analytics)
     std::string _logPath;
+    OutputFormat _format;
+    LogWriterConfig _logConfig;
+    PublishConfig _publishConfig;
+
+    // Tabla de símbolos (orden alfabético): el índice es el symbolId binario
+    std::vector<SnapshotSymbol> _symbols;
+    std::vector<SymbolState> _state;
+
+    // Libros implícitos (sus OrderBook también están en _state)
+    std::vector<std::shared_ptr<SyntheticBook>> _synthetic;
+
+    // Snapshot del libro, fila y línea en armado, reutilizados entre
+    // publicaciones (OrderBook::snapshotInto no reserva memoria en régimen)
+    BookSnapshot _book;
+    SnapshotRow _row;
+    std::string _line;
+
+    // Métricas de profundidad (--analytics); null = sin métricas
+    std::unique_ptr<BookAnalytics> _analytics;
+
+    // Horizontes de --horizon-stats (vacío = sin métricas por horizonte)
+    std::vector<int64_t> _horizonsMs;
+
+    // Despertador del hilo en modo changes (lo avisan libros y trades)
+    IdleWaiter _changes{ IdleStrategy::Block };
 
     std::atomic<bool> _running{ false };
     std::thread _thr;
-    std::ofstream _file;
+    // Salida asíncrona: el ciclo de publicación solo arma buffers y los encola
+    std::unique_ptr<LogWriter> _out;
+    std::unique_ptr<SnapshotRecordEncoder> _encoder; // solo con OutputFormat::Binary
 };
\ No newline at end of file
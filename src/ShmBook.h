@@ -0,0 +1,257 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// ShmBook: libros publicados en memoria compartida
+// -----------------------------------------------------------------------------
+// Segmento POSIX (shm_open + mmap) con un slot de tamaño fijo por símbolo.
+// Lo escribe BinanceOrderBook (--shm=/nombre, ver ShmBookWriter) y lo leen
+// procesos del mismo host con ShmBookReader, sin syscalls ni parseo.
+//
+// Este header es el cliente completo: no depende de nada más del repo.
+//
+// Layout (endianness y alineación nativas del host):
+//   Header (64 bytes)
+//   Slot[slotCount], cada uno de slotSize bytes (múltiplo de 64):
+//     SlotHead                  símbolo y escala (constantes)
+//                               + sección trade (seqlock propio)
+//                               + sección libro (seqlock propio)
+//     Level bids[levels]        parte de la sección libro
+//     Level asks[levels]
+//
+// Cada sección tiene un único escritor (el libro lo escribe el BookSyncWorker
+// del símbolo y el trade su BinanceTradeStream), por eso tienen seqlocks
+// separados. Seqlock: el escritor pone la secuencia impar, copia y la pone par;
+// el lector reintenta si la vio impar o si cambió durante la copia.
+//
+// Precios en unidades de 10^-priceDecimals y cantidades en 10^-qtyDecimals.
+// -----------------------------------------------------------------------------
+namespace shmbook {
+
+constexpr uint32_t kMagic = 0x4B4F4253; // "SBOK"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kSymbolLen = 32;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+    "el seqlock en memoria compartida necesita atomics de 64 bits sin lock");
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t levels;       // niveles por lado en cada slot
+    uint64_t slotSize;
+    uint64_t slotsOffset;  // offset del primer slot desde el inicio
+    uint64_t createdNs;    // epoch ns de creación (cambia si el escritor reinicia)
+    uint8_t reserved[24];
+};
+static_assert(sizeof(Header) == 64, "Header debe medir 64 bytes");
+
+struct Level {
+    int64_t price;
+    int64_t qty;
+};
+
+struct Trade {
+    int64_t lastPx;
+    int64_t lastQty;
+    uint8_t lastSide;      // 0 = sin trades, 1 = buy, 2 = sell
+    uint8_t pad[7];
+    double vwapWindow;     // en ticks (con fracción)
+    double vwapSession;    // en ticks (con fracción)
+    uint64_t tradeTimeMs;  // campo T del último trade
+    uint64_t updateNs;     // epoch ns de la escritura
+};
+
+struct BookTop {
+    int64_t bestBidPx;
+    int64_t bestBidQty;
+    int64_t bestAskPx;
+    int64_t bestAskQty;
+    uint32_t bidCount;     // niveles válidos en bids[]
+    uint32_t askCount;
+    uint64_t lastUpdateId; // último depthUpdate aplicado
+    uint64_t updateNs;     // epoch ns de la escritura
+    uint8_t synced;        // 1 = libro enganchado con el stream
+    uint8_t pad[7];
+};
+
+struct alignas(64) SlotHead {
+    char symbol[kSymbolLen]; // "" = slot sin asignar
+    int32_t priceDecimals;
+    int32_t qtyDecimals;
+    int64_t tickSize;
+
+    alignas(64) std::atomic<uint64_t> tradeSeq;
+    Trade trade;
+
+    alignas(64) std::atomic<uint64_t> bookSeq;
+    BookTop book;
+};
+
+inline size_t slotSizeFor(uint32_t levels) {
+    const size_t raw = sizeof(SlotHead) + 2 * static_cast<size_t>(levels) * sizeof(Level);
+    return (raw + 63) & ~static_cast<size_t>(63);
+}
+
+inline size_t segmentSizeFor(uint32_t slotCount, uint32_t levels) {
+    return sizeof(Header) + static_cast<size_t>(slotCount) * slotSizeFor(levels);
+}
+
+inline Level* slotBids(SlotHead* slot) {
+    return reinterpret_cast<Level*>(reinterpret_cast<char*>(slot) + sizeof(SlotHead));
+}
+inline const Level* slotBids(const SlotHead* slot) {
+    return reinterpret_cast<const Level*>(reinterpret_cast<const char*>(slot) + sizeof(SlotHead));
+}
+
+// ---- seqlock ----------------------------------------------------------------
+
+inline void seqBeginWrite(std::atomic<uint64_t>& seq) {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void seqEndWrite(std::atomic<uint64_t>& seq) {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Copia consistente de una sección: copyFn se reintenta hasta que la
+// secuencia sea par y no cambie. false si no lo logra en maxTries.
+template <class CopyFn>
+bool seqRead(const std::atomic<uint64_t>& seq, CopyFn copyFn, int maxTries = 1000) {
+    for (int i = 0; i < maxTries; ++i) {
+        const uint64_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        copyFn();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// ShmBookReader
+// -----------------------------------------------------------------------------
+// Cliente de solo lectura. Lanza std::runtime_error si el segmento no existe
+// o no tiene el formato esperado. Los read* no toman locks ni hacen syscalls.
+//
+// Ejemplo:
+//   shmbook::ShmBookReader reader("/binance_ob");
+//   int slot = reader.findSymbol("btcusdt");
+//   shmbook::BookView book;
+//   if (slot >= 0 && reader.readBook(slot, book)) usar(book.top.bestBidPx);
+// -----------------------------------------------------------------------------
+struct BookView {
+    BookTop top{};
+    std::vector<Level> bids; // top.bidCount niveles (se reutiliza la capacidad)
+    std::vector<Level> asks;
+};
+
+class ShmBookReader {
+public:
+    explicit ShmBookReader(const std::string& name) {
+#ifdef _WIN32
+        (void)name;
+        throw std::runtime_error("ShmBookReader: memoria compartida POSIX no disponible en Windows");
+#else
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::runtime_error("ShmBookReader: no existe el segmento " + name);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("ShmBookReader: segmento invalido " + name);
+        }
+        _size = static_cast<size_t>(st.st_size);
+        void* p = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("ShmBookReader: mmap fallido para " + name);
+        }
+        _base = static_cast<const char*>(p);
+
+        const Header* h = header();
+        if (h->magic != kMagic || h->version != kVersion ||
+            h->slotSize != slotSizeFor(h->levels) ||
+            _size < h->slotsOffset + h->slotCount * h->slotSize)
+        {
+            ::munmap(const_cast<char*>(_base), _size);
+            throw std::runtime_error("ShmBookReader: formato o version desconocidos en " + name);
+        }
+#endif
+    }
+
+    ~ShmBookReader() {
+#ifndef _WIN32
+        if (_base) ::munmap(const_cast<char*>(_base), _size);
+#endif
+    }
+
+    ShmBookReader(const ShmBookReader&) = delete;
+    ShmBookReader& operator=(const ShmBookReader&) = delete;
+
+    uint32_t slotCount() const { return header()->slotCount; }
+    uint32_t levels() const { return header()->levels; }
+    uint64_t createdNs() const { return header()->createdNs; }
+
+    const SlotHead* slot(uint32_t index) const {
+        return reinterpret_cast<const SlotHead*>(_base + header()->slotsOffset + index * header()->slotSize);
+    }
+
+    // Slot del símbolo (minúsculas, ej "btcusdt"), o -1
+    int findSymbol(const std::string& symbol) const {
+        for (uint32_t i = 0; i < slotCount(); ++i) {
+            if (std::strncmp(slot(i)->symbol, symbol.c_str(), kSymbolLen) == 0) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    bool readBook(uint32_t index, BookView& out) const {
+        const SlotHead* s = slot(index);
+        const uint32_t maxLevels = levels();
+        out.bids.resize(maxLevels);
+        out.asks.resize(maxLevels);
+
+        const bool ok = seqRead(s->bookSeq, [&] {
+            std::memcpy(&out.top, &s->book, sizeof(BookTop));
+            const Level* bids = slotBids(s);
+            std::memcpy(out.bids.data(), bids, maxLevels * sizeof(Level));
+            std::memcpy(out.asks.data(), bids + maxLevels, maxLevels * sizeof(Level));
+        });
+        if (!ok) return false;
+
+        out.bids.resize(out.top.bidCount < maxLevels ? out.top.bidCount : maxLevels);
+        out.asks.resize(out.top.askCount < maxLevels ? out.top.askCount : maxLevels);
+        return true;
+    }
+
+    bool readTrade(uint32_t index, Trade& out) const {
+        const SlotHead* s = slot(index);
+        return seqRead(s->tradeSeq, [&] { std::memcpy(&out, &s->trade, sizeof(Trade)); });
+    }
+
+private:
+    const Header* header() const { return reinterpret_cast<const Header*>(_base); }
+
+    const char* _base = nullptr;
+    size_t _size = 0;
+};
+
+} // namespace shmbook
@@ -0,0 +1,140 @@
+#include "ShmBookWriter.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "OrderBook.h"
+#include "TradeStats.h"
+#include "Journal.h"
+
+ShmBookWriter::ShmBookWriter(const std::string& name, uint32_t slotCount, int levels)
+    : _name(name)
+    , _slotCount(slotCount)
+    , _levels(static_cast<uint32_t>(std::max(levels, 1)))
+    , _scratch(slotCount)
+{
+#ifdef _WIN32
+    throw std::runtime_error("--shm: memoria compartida POSIX no disponible en Windows");
+#else
+    _size = shmbook::segmentSizeFor(_slotCount, _levels);
+
+    // Si quedó un segmento de una corrida anterior, se reemplaza: los
+    // lectores que lo tenían mapeado ven createdNs distinto al reabrir
+    ::shm_unlink(_name.c_str());
+    const int fd = ::shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("No se pudo crear el segmento de memoria compartida: " + _name);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(_size)) != 0) {
+        ::close(fd);
+        ::shm_unlink(_name.c_str());
+        throw std::runtime_error("No se pudo dimensionar el segmento: " + _name);
+    }
+    void* p = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        ::shm_unlink(_name.c_str());
+        throw std::runtime_error("mmap fallido para el segmento: " + _name);
+    }
+    _base = static_cast<char*>(p);
+
+    // ftruncate deja el segmento en ceros: secuencias en 0 y slots sin símbolo
+    auto* header = reinterpret_cast<shmbook::Header*>(_base);
+    header->slotCount = _slotCount;
+    header->levels = _levels;
+    header->slotSize = shmbook::slotSizeFor(_levels);
+    header->slotsOffset = sizeof(shmbook::Header);
+    header->createdNs = journalNowNs();
+    header->version = shmbook::kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = shmbook::kMagic; // último: los lectores validan con esto
+
+    for (auto& s : _scratch) {
+        s.bids.reserve(_levels);
+        s.asks.reserve(_levels);
+    }
+#endif
+}
+
+ShmBookWriter::~ShmBookWriter() {
+#ifndef _WIN32
+    if (_base) {
+        ::munmap(_base, _size);
+        ::shm_unlink(_name.c_str());
+    }
+#endif
+}
+
+shmbook::SlotHead* ShmBookWriter::slotAt(uint32_t index) {
+    return reinterpret_cast<shmbook::SlotHead*>(
+        _base + sizeof(shmbook::Header) + index * shmbook::slotSizeFor(_levels));
+}
+
+uint32_t ShmBookWriter::addSymbol(const std::string& symbol, const SymbolScale& scale) {
+    if (_used >= _slotCount) {
+        throw std::runtime_error("ShmBookWriter: no quedan slots para " + symbol);
+    }
+    if (symbol.size() >= shmbook::kSymbolLen) {
+        throw std::runtime_error("ShmBookWriter: simbolo demasiado largo " + symbol);
+    }
+
+    const uint32_t index = _used++;
+    shmbook::SlotHead* slot = slotAt(index);
+    slot->priceDecimals = scale.priceDecimals;
+    slot->qtyDecimals = scale.qtyDecimals;
+    slot->tickSize = scale.tickSize;
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot->symbol, symbol.c_str(), symbol.size() + 1);
+    return index;
+}
+
+void ShmBookWriter::writeBook(uint32_t index, OrderBook& book, uint64_t lastUpdateId, bool synced) {
+    Scratch& scratch = _scratch[index];
+    book.topLevels(static_cast<int>(_levels), scratch.bids, scratch.asks);
+
+    shmbook::SlotHead* slot = slotAt(index);
+    shmbook::Level* bids = shmbook::slotBids(slot);
+    shmbook::Level* asks = bids + _levels;
+
+    const uint32_t bidCount = static_cast<uint32_t>(std::min<size_t>(scratch.bids.size(), _levels));
+    const uint32_t askCount = static_cast<uint32_t>(std::min<size_t>(scratch.asks.size(), _levels));
+
+    shmbook::seqBeginWrite(slot->bookSeq);
+
+    shmbook::BookTop& top = slot->book;
+    top.bestBidPx = bidCount > 0 ? scratch.bids[0].price : 0;
+    top.bestBidQty = bidCount > 0 ? scratch.bids[0].qty : 0;
+    top.bestAskPx = askCount > 0 ? scratch.asks[0].price : 0;
+    top.bestAskQty = askCount > 0 ? scratch.asks[0].qty : 0;
+    top.bidCount = bidCount;
+    top.askCount = askCount;
+    top.lastUpdateId = lastUpdateId;
+    top.updateNs = journalNowNs();
+    top.synced = synced ? 1 : 0;
+
+    for (uint32_t i = 0; i < bidCount; ++i) {
+        bids[i] = shmbook::Level{ scratch.bids[i].price, scratch.bids[i].qty };
+    }
+    for (uint32_t i = 0; i < askCount; ++i) {
+        asks[i] = shmbook::Level{ scratch.asks[i].price, scratch.asks[i].qty };
+    }
+
+    shmbook::seqEndWrite(slot->bookSeq);
+}
+
+void ShmBookWriter::writeTrade(uint32_t index, const TradeSnapshot& trade, uint64_t tradeTimeMs) {
+    shmbook::SlotHead* slot = slotAt(index);
+
+    shmbook::seqBeginWrite(slot->tradeSeq);
+
+    shmbook::Trade& t = slot->trade;
+    t.lastPx = trade.last.price;
+    t.lastQty = trade.last.qty;
+    t.lastSide = trade.last.side == "buy" ? 1 : trade.last.side == "sell" ? 2 : 0;
+    t.vwapWindow = trade.vwapWindow;
+    t.vwapSession = trade.vwapSession;
+    t.tradeTimeMs = tradeTimeMs;
+    t.updateNs = journalNowNs();
+
+    shmbook::seqEndWrite(slot->tradeSeq);
+}
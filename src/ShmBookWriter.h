@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FixedPoint.h"
+#include "BookSide.h"
+#include "ShmBook.h"
+
+class OrderBook;
+struct TradeSnapshot;
+
+// -----------------------------------------------------------------------------
+// ShmBookWriter
+// -----------------------------------------------------------------------------
+// Crea el segmento de memoria compartida (--shm=/nombre) y escribe en él el
+// estado de cada símbolo. Layout y cliente de lectura en ShmBook.h.
+//
+// - addSymbol asigna un slot por símbolo (antes de arrancar los workers).
+// - writeBook lo llama el BookSyncWorker del símbolo después de aplicar
+//   updates; writeTrade lo llama su BinanceTradeStream en cada trade.
+// - Cada slot tiene dos secciones con seqlock propio, así el hilo del libro
+//   y el de trades escriben sin coordinarse. Distintos slots se pueden
+//   escribir en paralelo.
+//
+// Al destruirse desmapea y borra el segmento (shm_unlink).
+// Lanza std::runtime_error si no puede crearlo (o en Windows).
+// -----------------------------------------------------------------------------
+class ShmBookWriter {
+public:
+    ShmBookWriter(const std::string& name, uint32_t slotCount, int levels);
+    ~ShmBookWriter();
+
+    ShmBookWriter(const ShmBookWriter&) = delete;
+    ShmBookWriter& operator=(const ShmBookWriter&) = delete;
+
+    // Asigna el próximo slot libre al símbolo y devuelve su índice
+    uint32_t addSymbol(const std::string& symbol, const SymbolScale& scale);
+
+    // Copia best bid/ask y los primeros `levels` niveles del libro
+    void writeBook(uint32_t slot, OrderBook& book, uint64_t lastUpdateId, bool synced);
+
+    void writeTrade(uint32_t slot, const TradeSnapshot& trade, uint64_t tradeTimeMs);
+
+    const std::string& name() const { return _name; }
+
+private:
+    shmbook::SlotHead* slotAt(uint32_t index);
+
+    // Niveles leídos del libro, uno por slot: cada slot tiene un solo
+    // escritor de libro, así que no hace falta lock
+    struct Scratch {
+        std::vector<Level> bids;
+        std::vector<Level> asks;
+    };
+
+    std::string _name;
+    uint32_t _slotCount;
+    uint32_t _levels;
+    uint32_t _used = 0;
+    size_t _size = 0;
+    char* _base = nullptr;
+    std::vector<Scratch> _scratch;
+};
@@ -0,0 +1,430 @@
+#include "SnapshotRecord.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+constexpr char kMagic[4] = { 'B', 'O', 'B', 'S' };
+constexpr uint32_t kVersion = 1;          // sin métricas
+constexpr uint32_t kVersionAnalytics = 2; // con bandas y métricas de --analytics
+constexpr uint32_t kVersionHorizons = 3;  // con horizontes de --horizon-stats (y bandas, si hay)
+constexpr size_t kFixedHeaderSize = 4 + 4 * 5;
+constexpr size_t kSymbolEntrySize = 1 + 1 + 1 + 8; // + nombre
+constexpr size_t kFileBufferSize = 1 << 20;
+
+template <class T>
+void putLE(char* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+}
+
+template <class T>
+T getLE(const char* in) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return static_cast<T>(v);
+}
+
+void putF64(char* out, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putLE<uint64_t>(out, bits);
+}
+
+double getF64(const char* in) {
+    const uint64_t bits = getLE<uint64_t>(in);
+    double value = 0.0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// CSV
+// -----------------------------------------------------------------------------
+
+void appendCsvLine(std::string& out, const SnapshotSymbol& symbol, const SnapshotRow& row) {
+    const SymbolScale& scale = symbol.scale;
+    auto px = [&scale](double ticks) { return scale.priceToDouble(ticks); };
+    auto qty = [&scale](double lots) { return scale.qtyToDouble(lots); };
+
+    const bool twoSided = row.bestBidPx > 0 && row.bestAskPx > 0;
+
+    // mid y spread
+    const double mid = twoSided
+        ? px((static_cast<double>(row.bestBidPx) + static_cast<double>(row.bestAskPx)) / 2.0)
+        : 0.0;
+    const double spread = twoSided
+        ? px(static_cast<double>(row.bestAskPx - row.bestBidPx))
+        : 0.0;
+
+    // imbalance (profundidad relativa de bids vs asks en topN)
+    Qty bidDepthSum = 0;
+    for (const auto& lvl : row.bids) bidDepthSum += lvl.qty;
+    Qty askDepthSum = 0;
+    for (const auto& lvl : row.asks) askDepthSum += lvl.qty;
+
+    double imb = 0.0;
+    if (bidDepthSum + askDepthSum > 0) {
+        imb = static_cast<double>(bidDepthSum) / static_cast<double>(bidDepthSum + askDepthSum);
+    }
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(6);
+
+    // niveles: "price:qty|price:qty|..."
+    auto levels = [&](const std::vector<Level>& v) {
+        for (size_t i = 0; i < v.size(); ++i) {
+            line << px(static_cast<double>(v[i].price)) << ":" << qty(static_cast<double>(v[i].qty));
+            if (i + 1 < v.size()) line << "|";
+        }
+    };
+
+    const char* side = "none";
+    if (row.lastSide == TradeSide::Buy) side = "buy";
+    else if (row.lastSide == TradeSide::Sell) side = "sell";
+
+    line
+        << row.ts << ","
+        << symbol.name << ","
+        << mid << ","
+        << spread << ","
+        << px(static_cast<double>(row.bestBidPx)) << ","
+        << qty(static_cast<double>(row.bestBidQty)) << ","
+        << px(static_cast<double>(row.bestAskPx)) << ","
+        << qty(static_cast<double>(row.bestAskQty)) << ",";
+    levels(row.bids);
+    line << ",";
+    levels(row.asks);
+    line
+        << ","
+        << px(static_cast<double>(row.lastPx)) << ","
+        << qty(static_cast<double>(row.lastQty)) << ","
+        << side << ","
+        << px(row.vwapWindow) << ","
+        << px(row.vwapSession) << ","
+        << imb;
+
+    if (row.analytics) {
+        const DepthMetrics& m = row.metrics;
+        line
+            << "," << px(m.microprice)
+            << "," << m.weightedImbalance
+            << "," << m.bidSlope
+            << "," << m.askSlope;
+        const size_t bands = std::min(m.bidNotional.size(), m.askNotional.size());
+        for (size_t i = 0; i < bands; ++i) {
+            line << "," << m.bidNotional[i] << "," << m.askNotional[i];
+        }
+    }
+
+    if (row.tradeHorizons) {
+        for (const HorizonStats& h : row.horizons) {
+            line
+                << "," << qty(static_cast<double>(h.volume))
+                << "," << qty(static_cast<double>(h.buyVolume))
+                << "," << qty(static_cast<double>(h.sellVolume))
+                << "," << h.count
+                << "," << px(h.vwap)
+                << "," << px(static_cast<double>(h.high))
+                << "," << px(static_cast<double>(h.low));
+        }
+    }
+
+    out += line.str();
+}
+
+// -----------------------------------------------------------------------------
+// SnapshotRecordEncoder
+// -----------------------------------------------------------------------------
+
+SnapshotRecordEncoder::SnapshotRecordEncoder(int topN, const std::vector<SnapshotSymbol>& symbols,
+    const std::vector<int>& bandsBps, const std::vector<int64_t>& horizonsMs)
+    : _topN(topN)
+    , _bandCount(bandsBps.size())
+    , _horizonCount(horizonsMs.size())
+    , _recordSize(snapshotRecordSize(topN, bandsBps.size(), horizonsMs.size()))
+{
+    if (symbols.size() > 0xFFFF) {
+        throw std::runtime_error("Demasiados simbolos para el formato binario (max 65535)");
+    }
+
+    // La version 2 agrega la tabla de bandas entre la cabecera fija y los
+    // símbolos; la 3, la de bandas (aunque esté vacía) y la de horizontes
+    const uint32_t version = _horizonCount > 0 ? kVersionHorizons
+        : _bandCount > 0 ? kVersionAnalytics
+        : kVersion;
+    const size_t bandTableSize = version == kVersion ? 0 : 4 + 4 * _bandCount;
+    const size_t horizonTableSize = version == kVersionHorizons ? 4 + 4 * _horizonCount : 0;
+    size_t headerSize = kFixedHeaderSize + bandTableSize + horizonTableSize;
+    for (const auto& s : symbols) {
+        if (s.name.size() > 0xFF) {
+            throw std::runtime_error("Nombre de simbolo demasiado largo: " + s.name);
+        }
+        headerSize += kSymbolEntrySize + s.name.size();
+    }
+    headerSize = (headerSize + 7) & ~static_cast<size_t>(7);
+
+    _header.assign(headerSize, '\0');
+    char* h = &_header[0];
+    std::memcpy(h, kMagic, 4);
+    putLE<uint32_t>(h + 4, version);
+    putLE<uint32_t>(h + 8, static_cast<uint32_t>(headerSize));
+    putLE<uint32_t>(h + 12, static_cast<uint32_t>(topN));
+    putLE<uint32_t>(h + 16, static_cast<uint32_t>(_recordSize));
+    putLE<uint32_t>(h + 20, static_cast<uint32_t>(symbols.size()));
+
+    char* p = h + kFixedHeaderSize;
+    if (bandTableSize > 0) {
+        putLE<uint32_t>(p, static_cast<uint32_t>(_bandCount));
+        for (size_t i = 0; i < _bandCount; ++i) {
+            putLE<uint32_t>(p + 4 + 4 * i, static_cast<uint32_t>(bandsBps[i]));
+        }
+        p += bandTableSize;
+    }
+    if (horizonTableSize > 0) {
+        // parseArgs acota los horizontes a 1e6 buckets de a lo sumo 1 s: entran en u32
+        putLE<uint32_t>(p, static_cast<uint32_t>(_horizonCount));
+        for (size_t i = 0; i < _horizonCount; ++i) {
+            putLE<uint32_t>(p + 4 + 4 * i, static_cast<uint32_t>(horizonsMs[i]));
+        }
+        p += horizonTableSize;
+    }
+    for (const auto& s : symbols) {
+        p[0] = static_cast<char>(s.scale.priceDecimals);
+        p[1] = static_cast<char>(s.scale.qtyDecimals);
+        p[2] = static_cast<char>(s.name.size());
+        putLE<int64_t>(p + 3, s.scale.tickSize);
+        std::memcpy(p + kSymbolEntrySize, s.name.data(), s.name.size());
+        p += kSymbolEntrySize + s.name.size();
+    }
+}
+
+void SnapshotRecordEncoder::append(std::string& out, const SnapshotRow& row) const {
+    const size_t offset = out.size();
+    out.resize(offset + _recordSize, '\0');
+    char* r = &out[offset];
+
+    const size_t bidCount = std::min(row.bids.size(), static_cast<size_t>(_topN));
+    const size_t askCount = std::min(row.asks.size(), static_cast<size_t>(_topN));
+
+    putF64(r + 0, row.ts);
+    putLE<uint16_t>(r + 8, row.symbolId);
+    putLE<uint16_t>(r + 10, static_cast<uint16_t>(bidCount));
+    putLE<uint16_t>(r + 12, static_cast<uint16_t>(askCount));
+    r[14] = static_cast<char>(row.lastSide);
+    putLE<int64_t>(r + 16, row.bestBidPx);
+    putLE<int64_t>(r + 24, row.bestBidQty);
+    putLE<int64_t>(r + 32, row.bestAskPx);
+    putLE<int64_t>(r + 40, row.bestAskQty);
+    putLE<int64_t>(r + 48, row.lastPx);
+    putLE<int64_t>(r + 56, row.lastQty);
+    putF64(r + 64, row.vwapWindow);
+    putF64(r + 72, row.vwapSession);
+
+    char* bids = r + kSnapshotRecordFixedSize;
+    char* asks = bids + kSnapshotLevelSize * static_cast<size_t>(_topN);
+    for (size_t i = 0; i < bidCount; ++i) {
+        putLE<int64_t>(bids + i * kSnapshotLevelSize, row.bids[i].price);
+        putLE<int64_t>(bids + i * kSnapshotLevelSize + 8, row.bids[i].qty);
+    }
+    for (size_t i = 0; i < askCount; ++i) {
+        putLE<int64_t>(asks + i * kSnapshotLevelSize, row.asks[i].price);
+        putLE<int64_t>(asks + i * kSnapshotLevelSize + 8, row.asks[i].qty);
+    }
+
+    char* metrics = asks + kSnapshotLevelSize * static_cast<size_t>(_topN);
+    if (_bandCount > 0 && row.analytics) {
+        const DepthMetrics& m = row.metrics;
+        putF64(metrics + 0, m.microprice);
+        putF64(metrics + 8, m.weightedImbalance);
+        putF64(metrics + 16, m.bidSlope);
+        putF64(metrics + 24, m.askSlope);
+        char* bands = metrics + kSnapshotMetricsFixedSize;
+        for (size_t i = 0; i < _bandCount; ++i) {
+            putF64(bands + 8 * i, i < m.bidNotional.size() ? m.bidNotional[i] : 0.0);
+            putF64(bands + 8 * (_bandCount + i), i < m.askNotional.size() ? m.askNotional[i] : 0.0);
+        }
+    }
+
+    if (_horizonCount > 0 && row.tradeHorizons) {
+        char* horizons = metrics + (_bandCount == 0 ? 0 : kSnapshotMetricsFixedSize + 16 * _bandCount);
+        const size_t count = std::min(row.horizons.size(), _horizonCount);
+        for (size_t i = 0; i < count; ++i) {
+            const HorizonStats& hs = row.horizons[i];
+            char* out = horizons + kSnapshotHorizonSize * i;
+            putLE<int64_t>(out + 0, hs.volume);
+            putLE<int64_t>(out + 8, hs.buyVolume);
+            putLE<int64_t>(out + 16, hs.sellVolume);
+            putLE<uint64_t>(out + 24, hs.count);
+            putF64(out + 32, hs.vwap);
+            putLE<int64_t>(out + 40, hs.high);
+            putLE<int64_t>(out + 48, hs.low);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// SnapshotRecordReader
+// -----------------------------------------------------------------------------
+
+SnapshotRecordReader::SnapshotRecordReader(const std::string& path)
+    : _buffer(kFileBufferSize)
+{
+    _file.rdbuf()->pubsetbuf(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    _file.open(path, std::ios::in | std::ios::binary);
+    if (!_file) {
+        throw std::runtime_error("No se pudo abrir el archivo de snapshots: " + path);
+    }
+
+    char fixed[kFixedHeaderSize];
+    uint32_t version = 0;
+    if (!_file.read(fixed, sizeof(fixed)) ||
+        std::memcmp(fixed, kMagic, 4) != 0 ||
+        ((version = getLE<uint32_t>(fixed + 4)) != kVersion && version != kVersionAnalytics &&
+            version != kVersionHorizons))
+    {
+        throw std::runtime_error("Archivo de snapshots invalido o de otra version: " + path);
+    }
+
+    const uint32_t headerSize = getLE<uint32_t>(fixed + 8);
+    _topN = static_cast<int>(getLE<uint32_t>(fixed + 12));
+    _recordSize = getLE<uint32_t>(fixed + 16);
+    const uint32_t symbolCount = getLE<uint32_t>(fixed + 20);
+
+    if (headerSize < kFixedHeaderSize) {
+        throw std::runtime_error("Cabecera de snapshots inconsistente: " + path);
+    }
+
+    std::vector<char> rest(headerSize - kFixedHeaderSize);
+    if (!rest.empty() && !_file.read(rest.data(), static_cast<std::streamsize>(rest.size()))) {
+        throw std::runtime_error("Cabecera de snapshots truncada: " + path);
+    }
+
+    size_t pos = 0;
+    if (version != kVersion) {
+        // En la version 3 la tabla de bandas puede estar vacía
+        const size_t bandCount = rest.size() >= 4 ? getLE<uint32_t>(rest.data()) : 0;
+        if ((bandCount == 0 && version == kVersionAnalytics) || 4 + 4 * bandCount > rest.size()) {
+            throw std::runtime_error("Tabla de bandas invalida: " + path);
+        }
+        for (size_t i = 0; i < bandCount; ++i) {
+            _bands.push_back(static_cast<int>(getLE<uint32_t>(rest.data() + 4 + 4 * i)));
+        }
+        pos = 4 + 4 * bandCount;
+    }
+    if (version == kVersionHorizons) {
+        const size_t horizonCount = pos + 4 <= rest.size() ? getLE<uint32_t>(rest.data() + pos) : 0;
+        if (horizonCount == 0 || pos + 4 + 4 * horizonCount > rest.size()) {
+            throw std::runtime_error("Tabla de horizontes invalida: " + path);
+        }
+        for (size_t i = 0; i < horizonCount; ++i) {
+            _horizonsMs.push_back(getLE<uint32_t>(rest.data() + pos + 4 + 4 * i));
+        }
+        pos += 4 + 4 * horizonCount;
+    }
+    if (_recordSize != snapshotRecordSize(_topN, _bands.size(), _horizonsMs.size())) {
+        throw std::runtime_error("Cabecera de snapshots inconsistente: " + path);
+    }
+
+    _symbols.reserve(symbolCount);
+    for (uint32_t i = 0; i < symbolCount; ++i) {
+        if (pos + kSymbolEntrySize > rest.size()) {
+            throw std::runtime_error("Tabla de simbolos truncada: " + path);
+        }
+        const char* p = rest.data() + pos;
+        const size_t nameLen = static_cast<unsigned char>(p[2]);
+        if (pos + kSymbolEntrySize + nameLen > rest.size()) {
+            throw std::runtime_error("Tabla de simbolos truncada: " + path);
+        }
+
+        SnapshotSymbol s;
+        s.scale.priceDecimals = static_cast<unsigned char>(p[0]);
+        s.scale.qtyDecimals = static_cast<unsigned char>(p[1]);
+        s.scale.tickSize = getLE<int64_t>(p + 3);
+        s.name.assign(p + kSymbolEntrySize, nameLen);
+        _symbols.push_back(std::move(s));
+
+        pos += kSymbolEntrySize + nameLen;
+    }
+
+    _record.resize(_recordSize);
+}
+
+bool SnapshotRecordReader::next(SnapshotRow& out) {
+    if (!_file.read(_record.data(), static_cast<std::streamsize>(_record.size()))) {
+        return false; // fin o registro truncado
+    }
+    const char* r = _record.data();
+
+    out.ts = getF64(r + 0);
+    out.symbolId = getLE<uint16_t>(r + 8);
+    const size_t bidCount = std::min<size_t>(getLE<uint16_t>(r + 10), static_cast<size_t>(_topN));
+    const size_t askCount = std::min<size_t>(getLE<uint16_t>(r + 12), static_cast<size_t>(_topN));
+    out.lastSide = static_cast<TradeSide>(static_cast<unsigned char>(r[14]));
+    out.bestBidPx = getLE<int64_t>(r + 16);
+    out.bestBidQty = getLE<int64_t>(r + 24);
+    out.bestAskPx = getLE<int64_t>(r + 32);
+    out.bestAskQty = getLE<int64_t>(r + 40);
+    out.lastPx = getLE<int64_t>(r + 48);
+    out.lastQty = getLE<int64_t>(r + 56);
+    out.vwapWindow = getF64(r + 64);
+    out.vwapSession = getF64(r + 72);
+
+    const char* bids = r + kSnapshotRecordFixedSize;
+    const char* asks = bids + kSnapshotLevelSize * static_cast<size_t>(_topN);
+    out.bids.resize(bidCount);
+    for (size_t i = 0; i < bidCount; ++i) {
+        out.bids[i].price = getLE<int64_t>(bids + i * kSnapshotLevelSize);
+        out.bids[i].qty = getLE<int64_t>(bids + i * kSnapshotLevelSize + 8);
+    }
+    out.asks.resize(askCount);
+    for (size_t i = 0; i < askCount; ++i) {
+        out.asks[i].price = getLE<int64_t>(asks + i * kSnapshotLevelSize);
+        out.asks[i].qty = getLE<int64_t>(asks + i * kSnapshotLevelSize + 8);
+    }
+
+    const size_t bandCount = _bands.size();
+    const char* metrics = asks + kSnapshotLevelSize * static_cast<size_t>(_topN);
+    out.analytics = bandCount > 0;
+    if (out.analytics) {
+        DepthMetrics& m = out.metrics;
+        m.microprice = getF64(metrics + 0);
+        m.weightedImbalance = getF64(metrics + 8);
+        m.bidSlope = getF64(metrics + 16);
+        m.askSlope = getF64(metrics + 24);
+        const char* bands = metrics + kSnapshotMetricsFixedSize;
+        m.bidNotional.resize(bandCount);
+        m.askNotional.resize(bandCount);
+        for (size_t i = 0; i < bandCount; ++i) {
+            m.bidNotional[i] = getF64(bands + 8 * i);
+            m.askNotional[i] = getF64(bands + 8 * (bandCount + i));
+        }
+    }
+
+    const size_t horizonCount = _horizonsMs.size();
+    out.tradeHorizons = horizonCount > 0;
+    out.horizons.resize(horizonCount);
+    const char* horizons = metrics + (bandCount == 0 ? 0 : kSnapshotMetricsFixedSize + 16 * bandCount);
+    for (size_t i = 0; i < horizonCount; ++i) {
+        const char* in = horizons + kSnapshotHorizonSize * i;
+        HorizonStats& hs = out.horizons[i];
+        hs.horizonMs = _horizonsMs[i];
+        hs.volume = getLE<int64_t>(in + 0);
+        hs.buyVolume = getLE<int64_t>(in + 8);
+        hs.sellVolume = getLE<int64_t>(in + 16);
+        hs.count = getLE<uint64_t>(in + 24);
+        hs.vwap = getF64(in + 32);
+        hs.high = getLE<int64_t>(in + 40);
+        hs.low = getLE<int64_t>(in + 48);
+        hs.notional = hs.vwap * static_cast<double>(hs.volume);
+    }
+    return true;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "FixedPoint.h"
+#include "BookSide.h"
+#include "TradeWindow.h"
+
+// -----------------------------------------------------------------------------
+// Formato de salida del Publisher
+// -----------------------------------------------------------------------------
+enum class OutputFormat {
+    Csv,    // una línea de texto por símbolo (formato original)
+    Binary  // registros de tamaño fijo (ver SnapshotRecordEncoder)
+};
+
+// "csv" / "binary" -> OutputFormat. Lanza std::runtime_error si no se reconoce.
+inline OutputFormat parseOutputFormat(const std::string& name) {
+    if (name == "csv") return OutputFormat::Csv;
+    if (name == "binary") return OutputFormat::Binary;
+    throw std::runtime_error("Formato de salida desconocido: " + name + " (usar csv|binary)");
+}
+
+// -----------------------------------------------------------------------------
+// SnapshotRow
+// -----------------------------------------------------------------------------
+// Una fila publicada, en punto fijo (como sale del libro y de TradeStats).
+// Es lo que se escribe como registro binario y lo que se formatea como CSV,
+// así las dos salidas tienen exactamente los mismos datos.
+// -----------------------------------------------------------------------------
+enum class TradeSide : uint8_t {
+    None = 0,
+    Buy = 1,
+    Sell = 2
+};
+
+// Métricas de profundidad (--analytics, ver BookAnalytics), sobre los
+// niveles analizados del libro y no solo los topN publicados
+struct DepthMetrics {
+    double microprice = 0.0;        // en ticks (con fracción), como los VWAP
+    double weightedImbalance = 0.0; // bids / (bids + asks) con peso 1/(nivel+1)
+    double bidSlope = 0.0;          // cantidad por bp de distancia al mid
+    double askSlope = 0.0;
+    std::vector<double> bidNotional; // por banda, notional en quote dentro de mid -N bps
+    std::vector<double> askNotional; // por banda, dentro de mid +N bps
+};
+
+struct SnapshotRow {
+    double ts = 0.0;          // epoch seconds
+    uint16_t symbolId = 0;    // índice en la tabla de símbolos del archivo
+    Price bestBidPx = 0;
+    Qty bestBidQty = 0;
+    Price bestAskPx = 0;
+    Qty bestAskQty = 0;
+    Price lastPx = 0;
+    Qty lastQty = 0;
+    TradeSide lastSide = TradeSide::None;
+    double vwapWindow = 0.0;  // en ticks (con fracción)
+    double vwapSession = 0.0; // en ticks (con fracción)
+    std::vector<Level> bids;  // hasta topN niveles
+    std::vector<Level> asks;
+    bool analytics = false;   // con metrics (--analytics)
+    DepthMetrics metrics;
+    bool tradeHorizons = false; // con horizons (--horizon-stats)
+    std::vector<HorizonStats> horizons; // uno por horizonte, en el orden de la cabecera
+};
+
+// Símbolo de la tabla de la cabecera
+struct SnapshotSymbol {
+    std::string name;
+    SymbolScale scale;
+};
+
+// Agrega a out la línea CSV de la fila (sin '\n'), con el mismo formato que
+// publicaba el Publisher: precios y cantidades en decimal con 6 decimales.
+// Con row.analytics agrega al final microprice, wImbalance, bidSlope,
+// askSlope y un par bidNotional,askNotional por banda. Con row.tradeHorizons
+// agrega después, por horizonte: volume, buyVolume, sellVolume, count, vwap,
+// high y low.
+void appendCsvLine(std::string& out, const SnapshotSymbol& symbol, const SnapshotRow& row);
+
+// -----------------------------------------------------------------------------
+// Archivo de snapshots binario
+// -----------------------------------------------------------------------------
+// Pensado para que el consumidor cargue un día entero con un solo read/memcpy:
+// todos los registros miden lo mismo y los campos están en offsets fijos.
+//
+// Formato (little-endian):
+//   Cabecera:
+//     "BOBS" (4 bytes) | version u32 | headerSize u32 | topN u32
+//     | recordSize u32 | symbolCount u32
+//     solo version 2: bandCount u32 | bandBps u32[bandCount]
+//     solo version 3: bandCount u32 | bandBps u32[bandCount]
+//                     | horizonCount u32 | horizonMs u32[horizonCount]
+//     por símbolo: priceDecimals u8 | qtyDecimals u8 | nameLen u8
+//                  | tickSize i64 | name[nameLen]
+//     relleno con ceros hasta headerSize (múltiplo de 8)
+//
+//   Registro (recordSize = 80 + 32 * topN bytes, alineado a 8):
+//     off  0  ts f64 (epoch seconds)
+//     off  8  symbolId u16 | bidCount u16 | askCount u16 | lastSide u8 | 0 u8
+//     off 16  bestBidPx i64 | bestBidQty i64 | bestAskPx i64 | bestAskQty i64
+//     off 48  lastPx i64 | lastQty i64
+//     off 64  vwapWindow f64 | vwapSession f64    (en ticks)
+//     off 80  bids[topN] { price i64, qty i64 } | asks[topN] { price i64, qty i64 }
+//     si bandCount > 0, a continuación de los niveles:
+//             microprice f64 (en ticks) | weightedImbalance f64
+//             | bidSlope f64 | askSlope f64
+//             | bidNotional f64[bandCount] | askNotional f64[bandCount]
+//     solo version 3, a continuación (56 bytes por horizonte):
+//             horizons[horizonCount] { volume i64 | buyVolume i64
+//             | sellVolume i64 | count u64 | vwap f64 (en ticks)
+//             | high i64 | low i64 }
+//
+// Sin --analytics ni --horizon-stats se escribe la version 1 (sin bandas ni
+// métricas); solo con --analytics, la 2 y recordSize suma 32 + 16 * bandCount;
+// con --horizon-stats, la 3 (bandCount puede ser 0) y recordSize suma además
+// 56 * horizonCount. El lector acepta las tres.
+//
+// Precios en unidades de 10^-priceDecimals y cantidades en 10^-qtyDecimals
+// del símbolo. Los niveles sin usar (más allá de bidCount/askCount) van en 0.
+// lastSide: 0 = sin trades, 1 = buy, 2 = sell.
+// -----------------------------------------------------------------------------
+constexpr size_t kSnapshotRecordFixedSize = 80;
+constexpr size_t kSnapshotLevelSize = 16;
+
+constexpr size_t kSnapshotMetricsFixedSize = 32;
+constexpr size_t kSnapshotHorizonSize = 56;
+
+inline size_t snapshotRecordSize(int topN, size_t bandCount = 0, size_t horizonCount = 0) {
+    const size_t metrics = bandCount == 0 ? 0 : kSnapshotMetricsFixedSize + 16 * bandCount;
+    return kSnapshotRecordFixedSize + 2 * kSnapshotLevelSize * static_cast<size_t>(topN) + metrics
+        + kSnapshotHorizonSize * horizonCount;
+}
+
+// -----------------------------------------------------------------------------
+// SnapshotRecordEncoder
+// -----------------------------------------------------------------------------
+// Arma la cabecera y los registros en memoria; la escritura a disco la hace
+// LogWriter, que repite la cabecera al principio de cada archivo rotado.
+// Lanza std::runtime_error si la tabla de símbolos no entra en el formato.
+// -----------------------------------------------------------------------------
+class SnapshotRecordEncoder {
+public:
+    // bandsBps: bandas de --analytics; horizonsMs: horizontes de
+    // --horizon-stats (los dos vacíos = version 1, sin métricas)
+    SnapshotRecordEncoder(int topN, const std::vector<SnapshotSymbol>& symbols,
+        const std::vector<int>& bandsBps = {}, const std::vector<int64_t>& horizonsMs = {});
+
+    // Cabecera completa (con relleno hasta headerSize)
+    const std::string& header() const { return _header; }
+
+    // Agrega a out el registro de la fila. Niveles de más de topN se descartan.
+    void append(std::string& out, const SnapshotRow& row) const;
+
+    size_t recordSize() const { return _recordSize; }
+
+private:
+    std::string _header;
+    int _topN;
+    size_t _bandCount;
+    size_t _horizonCount;
+    size_t _recordSize;
+};
+
+// -----------------------------------------------------------------------------
+// SnapshotRecordReader
+// -----------------------------------------------------------------------------
+// Lectura secuencial. next() devuelve false al llegar al final o ante un
+// registro truncado.
+// Lanza std::runtime_error si el archivo no existe o la cabecera no es válida.
+// -----------------------------------------------------------------------------
+class SnapshotRecordReader {
+public:
+    explicit SnapshotRecordReader(const std::string& path);
+
+    bool next(SnapshotRow& out);
+
+    int topN() const { return _topN; }
+    size_t recordSize() const { return _recordSize; }
+    const std::vector<SnapshotSymbol>& symbols() const { return _symbols; }
+    // Bandas de --analytics en bps (vacío = archivo sin métricas)
+    const std::vector<int>& bands() const { return _bands; }
+    // Horizontes de --horizon-stats en ms (vacío = archivo sin ellos)
+    const std::vector<int64_t>& horizonsMs() const { return _horizonsMs; }
+
+private:
+    std::ifstream _file;
+    std::vector<char> _buffer;
+    std::vector<char> _record;
+    std::vector<SnapshotSymbol> _symbols;
+    std::vector<int> _bands;
+    std::vector<int64_t> _horizonsMs;
+    int _topN = 0;
+    size_t _recordSize = 0;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+
+class OrderBook;
+
+// -----------------------------------------------------------------------------
+// SnapshotSource
+// -----------------------------------------------------------------------------
+// De dónde saca el BookSyncWorker los snapshots del libro (inicial y resync).
+//   - BinanceRestClient: GET /api/v3/depth en vivo.
+//   - JournalReplay: el body grabado en un journal de captura.
+// -----------------------------------------------------------------------------
+class SnapshotSource {
+public:
+    virtual ~SnapshotSource() = default;
+
+    // Carga un snapshot completo en orderBook (lo vacía antes) y devuelve su
+    // lastUpdateId. Retorna false si no se pudo obtener o parsear.
+    virtual bool loadInitialBookSnapshot(const std::string& symbolLowerCase,
+        std::shared_ptr<OrderBook> orderBook,
+        int limit,
+        uint64_t& outLastUpdateId) = 0;
+};
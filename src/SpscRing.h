@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// -----------------------------------------------------------------------------
+// SpscRing
+// -----------------------------------------------------------------------------
+// Cola circular acotada y sin locks para exactamente un productor y un
+// consumidor. Los slots se reservan una sola vez en el constructor y se
+// reutilizan: el productor escribe directamente sobre el slot libre
+// (beginPush/commitPush) y el consumidor lee en el lugar (front/pop), así que
+// los vectores internos de T conservan su capacidad entre mensajes.
+//
+// Ejemplo (productor):
+//   if (T* slot = ring.beginPush()) { llenar(*slot); ring.commitPush(); }
+// Ejemplo (consumidor):
+//   while (T* item = ring.front()) { usar(*item); ring.pop(); }
+//
+// Thread-safety:
+//   - beginPush/commitPush solo desde el hilo productor.
+//   - front/pop solo desde el hilo consumidor.
+//   - empty/size se pueden consultar desde cualquiera (valor aproximado).
+// -----------------------------------------------------------------------------
+template <class T>
+class SpscRing {
+public:
+    // capacity se redondea a la potencia de 2 siguiente
+    explicit SpscRing(size_t capacity)
+        : _slots(roundUpPow2(capacity))
+        , _mask(_slots.size() - 1)
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // ---- productor ----------------------------------------------------------
+
+    // Slot libre para escribir, o nullptr si la cola está llena.
+    // El elemento no es visible para el consumidor hasta commitPush().
+    T* beginPush() {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead > _mask) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead > _mask) return nullptr;
+        }
+        return &_slots[tail & _mask];
+    }
+
+    // Publica el slot obtenido con beginPush().
+    void commitPush() {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ---- consumidor ---------------------------------------------------------
+
+    // Primer elemento pendiente, o nullptr si la cola está vacía.
+    T* front() {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail) return nullptr;
+        }
+        return &_slots[head & _mask];
+    }
+
+    // Libera el slot devuelto por front() para que el productor lo reutilice.
+    void pop() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ---- consultas ----------------------------------------------------------
+
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return _slots.size(); }
+
+private:
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> _slots;
+    const size_t _mask;
+
+    // Índices monotónicos (se enmascaran al indexar). Cada uno en su propia
+    // línea de caché para que productor y consumidor no se pisen.
+    alignas(64) std::atomic<size_t> _head{ 0 }; // escrito por el consumidor
+    size_t _cachedTail = 0;                     // copia local del consumidor
+
+    alignas(64) std::atomic<size_t> _tail{ 0 }; // escrito por el productor
+    size_t _cachedHead = 0;                     // copia local del productor
+};
@@ -0,0 +1,261 @@
+#include "SweepDepth.h"
+
+SweepDepth::SweepDepth(bool isBid)
+    : _isBid(isBid)
+{
+}
+
+int32_t SweepDepth::newNode(int64_t key, Qty qty) {
+    // xorshift32: prioridades pseudoaleatorias, árbol balanceado en promedio
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+
+    int32_t t;
+    if (!_free.empty()) {
+        t = _free.back();
+        _free.pop_back();
+    }
+    else {
+        t = static_cast<int32_t>(_nodes.size());
+        _nodes.emplace_back();
+    }
+    Node& n = _nodes[static_cast<size_t>(t)];
+    n.key = key;
+    n.qty = qty;
+    n.priority = _rng;
+    n.left = -1;
+    n.right = -1;
+    pull(t);
+    return t;
+}
+
+void SweepDepth::freeNode(int32_t t) {
+    _free.push_back(t);
+}
+
+void SweepDepth::pull(int32_t t) {
+    Node& n = _nodes[static_cast<size_t>(t)];
+    n.sumQty = n.qty;
+    n.sumNotional = static_cast<double>(priceOf(n)) * static_cast<double>(n.qty);
+    n.count = 1;
+    if (n.left >= 0) {
+        const Node& l = _nodes[static_cast<size_t>(n.left)];
+        n.sumQty += l.sumQty;
+        n.sumNotional = l.sumNotional + n.sumNotional;
+        n.count += l.count;
+    }
+    if (n.right >= 0) {
+        const Node& r = _nodes[static_cast<size_t>(n.right)];
+        n.sumQty += r.sumQty;
+        n.sumNotional += r.sumNotional;
+        n.count += r.count;
+    }
+}
+
+int32_t SweepDepth::merge(int32_t a, int32_t b) {
+    // Todas las claves de a son menores que las de b
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (_nodes[static_cast<size_t>(a)].priority > _nodes[static_cast<size_t>(b)].priority) {
+        const int32_t right = merge(_nodes[static_cast<size_t>(a)].right, b);
+        _nodes[static_cast<size_t>(a)].right = right;
+        pull(a);
+        return a;
+    }
+    const int32_t left = merge(a, _nodes[static_cast<size_t>(b)].left);
+    _nodes[static_cast<size_t>(b)].left = left;
+    pull(b);
+    return b;
+}
+
+void SweepDepth::split(int32_t t, int64_t key, int32_t& less, int32_t& greater) {
+    // key no está en el subárbol
+    if (t < 0) {
+        less = greater = -1;
+        return;
+    }
+    Node& n = _nodes[static_cast<size_t>(t)];
+    if (n.key < key) {
+        split(n.right, key, n.right, greater);
+        less = t;
+    }
+    else {
+        split(n.left, key, less, n.left);
+        greater = t;
+    }
+    pull(t);
+}
+
+int32_t SweepDepth::eraseWorst(int32_t t) {
+    // El peor nivel es el de clave mayor: el de más a la derecha
+    Node& n = _nodes[static_cast<size_t>(t)];
+    if (n.right < 0) {
+        freeNode(t);
+        return n.left;
+    }
+    n.right = eraseWorst(n.right);
+    pull(t);
+    return t;
+}
+
+void SweepDepth::set(Price px, Qty qty) {
+    const int64_t key = _isBid ? -px : px;
+
+    // Una sola bajada anotando el camino; después se rehacen las sumas del
+    // camino de abajo hacia arriba
+    _path.clear();
+    int32_t t = _root;
+    while (t >= 0) {
+        const Node& n = _nodes[static_cast<size_t>(t)];
+        if (key == n.key) {
+            break;
+        }
+        _path.push_back(t);
+        t = key < n.key ? n.left : n.right;
+    }
+
+    if (t >= 0) {
+        Node& n = _nodes[static_cast<size_t>(t)];
+        if (qty != 0) {
+            // Nivel que ya existe (lo más común): solo cambia la cantidad
+            n.qty = qty;
+            pull(t);
+        }
+        else {
+            // Se borra: sus dos subárboles se unen en su lugar
+            freeNode(t);
+            link(key, merge(n.left, n.right));
+        }
+    }
+    else if (qty != 0) {
+        // Nivel nuevo: entra en el primer nodo del camino con menos
+        // prioridad, que se parte alrededor de key
+        const int32_t x = newNode(key, qty);
+        const uint32_t priority = _nodes[static_cast<size_t>(x)].priority;
+        size_t at = 0;
+        while (at < _path.size() && _nodes[static_cast<size_t>(_path[at])].priority >= priority) {
+            ++at;
+        }
+        const int32_t below = at < _path.size() ? _path[at] : -1;
+        _path.resize(at);
+        Node& nx = _nodes[static_cast<size_t>(x)];
+        split(below, key, nx.left, nx.right);
+        pull(x);
+        link(key, x);
+    }
+
+    for (size_t i = _path.size(); i-- > 0;) {
+        pull(_path[i]);
+    }
+}
+
+void SweepDepth::link(int64_t key, int32_t child) {
+    // child reemplaza al subárbol que colgaba del último nodo del camino
+    // (o a la raíz) del lado de key
+    if (_path.empty()) {
+        _root = child;
+        return;
+    }
+    Node& parent = _nodes[static_cast<size_t>(_path.back())];
+    (key < parent.key ? parent.left : parent.right) = child;
+}
+
+void SweepDepth::clear() {
+    _nodes.clear(); // conserva la capacidad
+    _free.clear();
+    _root = -1;
+}
+
+void SweepDepth::trimTo(size_t maxLevels) {
+    while (size() > maxLevels) {
+        _root = eraseWorst(_root);
+    }
+}
+
+SweepDepth::Prefix SweepDepth::prefix(size_t n) const {
+    Prefix acc;
+    int32_t t = _root;
+    while (t >= 0 && acc.levels < n) {
+        const Node& node = _nodes[static_cast<size_t>(t)];
+        const size_t leftCount = node.left < 0 ? 0 : _nodes[static_cast<size_t>(node.left)].count;
+        if (n - acc.levels <= leftCount) {
+            t = node.left;
+            continue;
+        }
+        // Entra el subárbol izquierdo entero y el nodo
+        if (node.left >= 0) {
+            const Node& l = _nodes[static_cast<size_t>(node.left)];
+            acc.qty += l.sumQty;
+            acc.notional += l.sumNotional;
+        }
+        acc.qty += node.qty;
+        acc.notional += static_cast<double>(priceOf(node)) * static_cast<double>(node.qty);
+        acc.levels += leftCount + 1;
+        t = node.right;
+    }
+    return acc;
+}
+
+Level SweepDepth::at(size_t k) const {
+    int32_t t = _root;
+    for (;;) {
+        const Node& node = _nodes[static_cast<size_t>(t)];
+        const size_t leftCount = node.left < 0 ? 0 : _nodes[static_cast<size_t>(node.left)].count;
+        if (k < leftCount) {
+            t = node.left;
+        }
+        else if (k == leftCount) {
+            return Level{ priceOf(node), node.qty };
+        }
+        else {
+            k -= leftCount + 1;
+            t = node.right;
+        }
+    }
+}
+
+template <class SubtreeSum, class NodeSum, class T>
+bool SweepDepth::find(T target, SubtreeSum subtree, NodeSum own, Prefix& before, Level& level) const {
+    Prefix acc;
+    int32_t t = _root;
+    while (t >= 0) {
+        const Node& node = _nodes[static_cast<size_t>(t)];
+        if (node.left >= 0) {
+            const Node& l = _nodes[static_cast<size_t>(node.left)];
+            if (subtree(acc, l) >= target) {
+                t = node.left;
+                continue;
+            }
+            acc.qty += l.sumQty;
+            acc.notional += l.sumNotional;
+            acc.levels += l.count;
+        }
+        const double notional = static_cast<double>(priceOf(node)) * static_cast<double>(node.qty);
+        if (own(acc, node, notional) >= target) {
+            before = acc;
+            level = Level{ priceOf(node), node.qty };
+            return true;
+        }
+        acc.qty += node.qty;
+        acc.notional += notional;
+        acc.levels += 1;
+        t = node.right;
+    }
+    before = acc;
+    return false;
+}
+
+bool SweepDepth::findQty(Qty target, Prefix& before, Level& level) const {
+    return find(target,
+        [](const Prefix& acc, const Node& sub) { return acc.qty + sub.sumQty; },
+        [](const Prefix& acc, const Node& node, double) { return acc.qty + node.qty; },
+        before, level);
+}
+
+bool SweepDepth::findNotional(double target, Prefix& before, Level& level) const {
+    return find(target,
+        [](const Prefix& acc, const Node& sub) { return acc.notional + sub.sumNotional; },
+        [](const Prefix& acc, const Node&, double notional) { return acc.notional + notional; },
+        before, level);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "FixedPoint.h"
+#include "BookSide.h"
+
+// -----------------------------------------------------------------------------
+// SweepDepth
+// -----------------------------------------------------------------------------
+// Copia de un lado del libro para los barridos (OrderBook::sweep): los mismos
+// niveles que el BookSide, en un árbol ordenado del mejor al peor precio
+// (treap) donde cada nodo guarda cantidad, notional (precio * cantidad) y
+// cantidad de niveles de su subárbol.
+//
+// - set() y trimTo() corrigen las sumas del camino al nodo: O(log n) por
+//   nivel, en cada delta, sin recalcular nada en la consulta.
+// - Las consultas bajan una sola vez por el árbol: primer nivel cuyo
+//   acumulado (cantidad o notional) llega a un objetivo, suma de los primeros
+//   n niveles o nivel k-ésimo. O(log n), sin copiar niveles.
+// - Las sumas se rehacen con las de los hijos en cada cambio (no se
+//   acumulan deltas): el notional no deriva con las horas.
+//
+// A diferencia de un Fenwick, no necesita un rango fijo de índices: los
+// precios entran y salen en cualquier lugar del lado.
+//
+// Los nodos viven en un vector con lista de libres: en régimen no reserva
+// memoria. No es thread-safe: OrderBook lo protege con su propio mutex.
+// -----------------------------------------------------------------------------
+class SweepDepth {
+public:
+    // Acumulado de un prefijo del lado (los `levels` mejores niveles)
+    struct Prefix {
+        Qty qty = 0;
+        double notional = 0.0; // precio * cantidad, en unidades de punto fijo
+        size_t levels = 0;
+    };
+
+    explicit SweepDepth(bool isBid);
+
+    // Inserta/actualiza el nivel; qty == 0 lo elimina (como BookSide::set)
+    void set(Price px, Qty qty);
+
+    void clear();
+    size_t size() const { return _root < 0 ? 0 : _nodes[static_cast<size_t>(_root)].count; }
+
+    // Elimina los peores niveles hasta dejar a lo sumo maxLevels
+    void trimTo(size_t maxLevels);
+
+    // Reserva nodos para levels niveles
+    void reserve(size_t levels) { _nodes.reserve(levels); }
+
+    // Suma de los primeros n niveles (n se acota a size())
+    Prefix prefix(size_t n) const;
+
+    // Nivel k (0 = el mejor). Precondición: k < size().
+    Level at(size_t k) const;
+
+    // Primer nivel cuyo acumulado de cantidad (o de notional) llega a target.
+    // Devuelve false si ni el lado entero llega; si no, level es ese nivel y
+    // before el acumulado de los anteriores (before.levels = su posición).
+    bool findQty(Qty target, Prefix& before, Level& level) const;
+    bool findNotional(double target, Prefix& before, Level& level) const;
+
+private:
+    struct Node {
+        int64_t key;        // precio, negado en bids: la clave menor es el mejor nivel
+        Qty qty;
+        Qty sumQty;         // del subárbol
+        double sumNotional; // del subárbol
+        uint32_t count;     // niveles del subárbol
+        uint32_t priority;
+        int32_t left;
+        int32_t right;
+    };
+
+    Price priceOf(const Node& n) const { return _isBid ? -n.key : n.key; }
+
+    int32_t newNode(int64_t key, Qty qty);
+    void freeNode(int32_t t);
+    void pull(int32_t t);
+    // Une dos subárboles (las claves de a, menores que las de b)
+    int32_t merge(int32_t a, int32_t b);
+    // Parte el subárbol t en claves < key y > key
+    void split(int32_t t, int64_t key, int32_t& less, int32_t& greater);
+    // Cuelga child del último nodo de _path (o lo pone de raíz)
+    void link(int64_t key, int32_t child);
+    int32_t eraseWorst(int32_t t);
+
+    // Bajada común de findQty / findNotional: subtree y own dan el acumulado
+    // hasta el final de un subárbol / de un nodo en la magnitud buscada
+    template <class SubtreeSum, class NodeSum, class T>
+    bool find(T target, SubtreeSum subtree, NodeSum own, Prefix& before, Level& level) const;
+
+    bool _isBid;
+    int32_t _root = -1;
+    std::vector<Node> _nodes;
+    std::vector<int32_t> _free;
+    std::vector<int32_t> _path; // camino de la última bajada de set()
+    uint32_t _rng = 0x9E3779B9u; // xorshift para las prioridades
+};
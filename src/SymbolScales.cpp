@@ -0,0 +1,75 @@
+#include "SymbolScales.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <cctype>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+std::string toLower(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) out.push_back(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+} // namespace
+
+std::unordered_map<std::string, SymbolScale> loadSymbolScales(const std::string& path) {
+    using nlohmann::json;
+
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("No se pudo abrir archivo de escalas: " + path);
+    }
+
+    json root;
+    try {
+        in >> root;
+    }
+    catch (const std::exception& ex) {
+        throw std::runtime_error("JSON de escalas invalido (" + path + "): " + ex.what());
+    }
+
+    std::unordered_map<std::string, SymbolScale> scales;
+
+    // Formato exchangeInfo
+    if (root.contains("symbols") && root["symbols"].is_array()) {
+        for (auto& entry : root["symbols"]) {
+            if (!entry.contains("symbol")) continue;
+
+            SymbolScale scale;
+            if (entry.contains("filters")) {
+                for (auto& filter : entry["filters"]) {
+                    std::string type = filter.value("filterType", "");
+                    if (type == "PRICE_FILTER" && filter.contains("tickSize")) {
+                        std::string tick = filter["tickSize"].get<std::string>();
+                        scale.priceDecimals = decimalsFromStep(tick);
+                        scale.tickSize = parseFixed(tick, scale.priceDecimals);
+                    }
+                    else if (type == "LOT_SIZE" && filter.contains("stepSize")) {
+                        scale.qtyDecimals = decimalsFromStep(filter["stepSize"].get<std::string>());
+                    }
+                }
+            }
+            scales[toLower(entry["symbol"].get<std::string>())] = scale;
+        }
+        return scales;
+    }
+
+    // Formato plano { "btcusdt": { "tickSize": ..., "stepSize": ... } }
+    for (auto& [symbol, cfg] : root.items()) {
+        SymbolScale scale;
+        if (cfg.contains("tickSize")) {
+            std::string tick = cfg["tickSize"].get<std::string>();
+            scale.priceDecimals = decimalsFromStep(tick);
+            scale.tickSize = parseFixed(tick, scale.priceDecimals);
+        }
+        if (cfg.contains("stepSize")) {
+            scale.qtyDecimals = decimalsFromStep(cfg["stepSize"].get<std::string>());
+        }
+        scales[toLower(symbol)] = scale;
+    }
+    return scales;
+}
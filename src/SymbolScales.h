@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "FixedPoint.h"
+
+// -----------------------------------------------------------------------------
+// loadSymbolScales
+// -----------------------------------------------------------------------------
+// Carga las escalas de precio/cantidad por símbolo desde un archivo JSON.
+// Acepta dos formatos:
+//
+//  1. El mismo shape que GET /api/v3/exchangeInfo:
+//       { "symbols": [ { "symbol": "BTCUSDT",
+//                        "filters": [ { "filterType": "PRICE_FILTER", "tickSize": "0.01000000" },
+//                                     { "filterType": "LOT_SIZE",     "stepSize": "0.00001000" } ] } ] }
+//
+//  2. Un config plano:
+//       { "btcusdt": { "tickSize": "0.01", "stepSize": "0.00001" } }
+//
+// Las claves del mapa resultante quedan en minúsculas (ej: "btcusdt").
+// Lanza std::runtime_error si el archivo no existe o no es JSON válido.
+// -----------------------------------------------------------------------------
+std::unordered_map<std::string, SymbolScale> loadSymbolScales(const std::string& path);
@@ -0,0 +1,346 @@
+#include "SyntheticBook.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// "eth/usdt" -> {eth, usdt}
+CurrencyPair parsePair(const std::string& text) {
+    const size_t slash = text.find('/');
+    if (slash == std::string::npos || slash == 0 || slash + 1 == text.size() ||
+        text.find('/', slash + 1) != std::string::npos)
+    {
+        throw std::runtime_error("Par invalido en --cross: " + text + " (usar base/quote)");
+    }
+    CurrencyPair pair;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i])));
+        if (i < slash) pair.base.push_back(c);
+        else if (i > slash) pair.quote.push_back(c);
+    }
+    if (pair.base == pair.quote) {
+        throw std::runtime_error("Par invalido en --cross: " + text);
+    }
+    return pair;
+}
+
+bool hasCurrency(const CurrencyPair& pair, const std::string& currency) {
+    return pair.base == currency || pair.quote == currency;
+}
+
+// La moneda del par que no es `currency`
+const std::string& otherCurrency(const CurrencyPair& pair, const std::string& currency) {
+    return pair.base == currency ? pair.quote : pair.base;
+}
+
+// Redondeos a la escala del target con tolerancia al error del double
+// (0.05 * 2000 no debe quedar en 99.99999 ticks)
+int64_t floorUnits(double value) {
+    const double units = std::floor(value * (1.0 + 1e-12));
+    return units > 9e18 ? 0 : static_cast<int64_t>(units);
+}
+
+int64_t ceilUnits(double value) {
+    const double units = std::ceil(value * (1.0 - 1e-12));
+    return units > 9e18 ? 0 : static_cast<int64_t>(units);
+}
+
+} // namespace
+
+std::string CrossSpec::name() const {
+    return target.symbol() + ":" + legs[0].symbol() + ":" + legs[1].symbol();
+}
+
+CrossSpec parseCrossSpec(const std::string& text) {
+    const size_t first = text.find(':');
+    const size_t second = first == std::string::npos ? first : text.find(':', first + 1);
+    if (second == std::string::npos || text.find(':', second + 1) != std::string::npos) {
+        throw std::runtime_error("--cross invalido: " + text + " (usar target:leg:leg, ej eth/usdt:eth/btc:btc/usdt)");
+    }
+
+    CrossSpec spec;
+    spec.target = parsePair(text.substr(0, first));
+    spec.legs[0] = parsePair(text.substr(first + 1, second - first - 1));
+    spec.legs[1] = parsePair(text.substr(second + 1));
+
+    // Cada moneda del target en una leg distinta y las legs unidas por una
+    // tercera moneda
+    const CurrencyPair& t = spec.target;
+    const int baseLeg = hasCurrency(spec.legs[0], t.base) ? 0 : 1;
+    const int quoteLeg = 1 - baseLeg;
+    const bool valid = hasCurrency(spec.legs[baseLeg], t.base)
+        && hasCurrency(spec.legs[quoteLeg], t.quote)
+        && !hasCurrency(spec.legs[baseLeg], t.quote)
+        && !hasCurrency(spec.legs[quoteLeg], t.base)
+        && otherCurrency(spec.legs[baseLeg], t.base) == otherCurrency(spec.legs[quoteLeg], t.quote);
+    if (!valid) {
+        throw std::runtime_error("--cross invalido: " + text + " (las legs deben unir " + t.base +
+            " y " + t.quote + " a traves de una misma moneda)");
+    }
+    return spec;
+}
+
+SyntheticBook::SyntheticBook(const CrossSpec& spec,
+    std::shared_ptr<OrderBook> leg0,
+    std::shared_ptr<OrderBook> leg1,
+    SymbolScale scale,
+    int levels)
+    : _name(spec.name())
+    , _legs{ std::move(leg0), std::move(leg1) }
+    , _book(std::make_shared<OrderBook>(spec.name(), scale))
+    , _levels(std::max(levels, 1))
+    , _priceUnit(static_cast<double>(pow10i(scale.priceDecimals)))
+    , _qtyUnit(static_cast<double>(pow10i(scale.qtyDecimals)))
+{
+    _book->setTopN(_levels);
+    for (int l = 0; l < 2; ++l) {
+        _legPriceUnit[l] = static_cast<double>(pow10i(_legs[l]->scale().priceDecimals));
+        _legQtyUnit[l] = static_cast<double>(pow10i(_legs[l]->scale().qtyDecimals));
+    }
+
+    // Un salto vende su moneda de entrada: si es la quote de la leg, compra
+    // la base (asks, tasa 1/p)
+    const CurrencyPair& t = spec.target;
+    const int baseLeg = hasCurrency(spec.legs[0], t.base) ? 0 : 1;
+    const int quoteLeg = 1 - baseLeg;
+    const std::string& common = otherCurrency(spec.legs[baseLeg], t.base);
+
+    // bid: base -> común -> quote
+    _bidPath.first = Hop{ baseLeg, spec.legs[baseLeg].quote == t.base };
+    _bidPath.second = Hop{ quoteLeg, spec.legs[quoteLeg].quote == common };
+
+    // ask: quote -> común -> base
+    _askPath.isAsk = true;
+    _askPath.first = Hop{ quoteLeg, spec.legs[quoteLeg].quote == t.quote };
+    _askPath.second = Hop{ baseLeg, spec.legs[baseLeg].quote == common };
+}
+
+const std::vector<Level>& SyntheticBook::hopLevels(const Hop& hop) const {
+    return hop.inverted ? _asks[hop.leg] : _bids[hop.leg];
+}
+
+size_t SyntheticBook::hopChanged(const Hop& hop) const {
+    if (!_legRead[hop.leg]) {
+        return SIZE_MAX; // la leg no cambió: no se volvió a leer
+    }
+    const std::vector<Level>& now = hopLevels(hop);
+    const std::vector<Level>& prev = hop.inverted ? _prevAsks[hop.leg] : _prevBids[hop.leg];
+
+    const size_t common = std::min(now.size(), prev.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (now[i].price != prev[i].price || now[i].qty != prev[i].qty) {
+            return i;
+        }
+    }
+    return now.size() == prev.size() ? SIZE_MAX : common;
+}
+
+void SyntheticBook::updateLadder(const Hop& hop, size_t from, std::vector<double>& rate, std::vector<double>& cap) const {
+    // Un escalón por nivel de la leg (los índices del recorrido son los de
+    // la leg); un nivel inválido queda con tasa y capacidad 0: da un paso
+    // vacío con precio 0, que no se publica
+    const std::vector<Level>& levels = hopLevels(hop);
+    rate.resize(levels.size());
+    cap.resize(levels.size());
+    for (size_t k = from; k < levels.size(); ++k) {
+        const double p = static_cast<double>(levels[k].price) / _legPriceUnit[hop.leg];
+        const double q = static_cast<double>(levels[k].qty) / _legQtyUnit[hop.leg];
+        if (p <= 0.0 || q <= 0.0) {
+            rate[k] = 0.0;
+            cap[k] = 0.0;
+            continue;
+        }
+        // vender base: p de quote por unidad, hasta q de base;
+        // comprar base: 1/p por unidad de quote, hasta p*q de quote
+        rate[k] = hop.inverted ? 1.0 / p : p;
+        cap[k] = hop.inverted ? p * q : q;
+    }
+}
+
+bool SyntheticBook::refresh() {
+    const uint64_t versions[2] = { _legs[0]->version(), _legs[1]->version() };
+    if (!_first && versions[0] == _legVersion[0] && versions[1] == _legVersion[1]) {
+        return false;
+    }
+
+    // Versiones antes de leer: un cambio durante la lectura se ve en la próxima.
+    // Una leg que no cambió no se vuelve a leer.
+    for (int l = 0; l < 2; ++l) {
+        _legRead[l] = _first || versions[l] != _legVersion[l];
+        if (!_legRead[l]) {
+            continue;
+        }
+        _legVersion[l] = versions[l];
+        _bids[l].swap(_prevBids[l]);
+        _asks[l].swap(_prevAsks[l]);
+        _legs[l]->topLevels(_levels, _bids[l], _asks[l]);
+    }
+
+    _delta.bids.clear();
+    _delta.asks.clear();
+
+    for (Path* path : { &_bidPath, &_askPath }) {
+        const size_t changedA = _first ? 0 : hopChanged(path->first);
+        const size_t changedB = _first ? 0 : hopChanged(path->second);
+        if (changedA == SIZE_MAX && changedB == SIZE_MAX) {
+            continue; // este lado del implícito no usa lo que cambió
+        }
+
+        updateLadder(path->first, changedA, path->rateA, path->capA);
+        updateLadder(path->second, changedB, path->rateB, path->capB);
+
+        // Primer paso que tocó un nivel modificado (los índices del
+        // recorrido solo avanzan); si ninguno, se sigue desde el final
+        size_t fromStep = path->steps.size();
+        for (size_t k = 0; k < path->steps.size(); ++k) {
+            const WalkState& s = path->steps[k].before;
+            if (s.i >= changedA || s.j >= changedB) {
+                fromStep = k;
+                break;
+            }
+        }
+
+        walk(*path, fromStep, changedA, changedB);
+        rebuildLevels(*path, fromStep, path->isAsk ? _delta.asks : _delta.bids);
+    }
+    _first = false;
+
+    if (_delta.bids.empty() && _delta.asks.empty()) {
+        return false;
+    }
+    _book->applyDepthDelta(_delta);
+    return true;
+}
+
+void SyntheticBook::walk(Path& path, size_t fromStep, size_t changedA, size_t changedB) {
+    WalkState s = fromStep < path.steps.size() ? path.steps[fromStep].before : path.end;
+    path.steps.resize(std::min(fromStep, path.steps.size()));
+
+    // Un nivel modificado se toma entero: nunca se había tocado antes de
+    // fromStep (salvo al terminar, donde puede haber quedado a medias)
+    if (s.i >= changedA) s.remA = -1.0;
+    if (s.j >= changedB) s.remB = -1.0;
+
+    const size_t nA = path.rateA.size();
+    const size_t nB = path.rateB.size();
+    while (s.i < nA && s.j < nB) {
+        const double capA = s.remA < 0.0 ? path.capA[s.i] : s.remA;
+        const double capB = s.remB < 0.0 ? path.capB[s.j] : s.remB;
+        const double rateA = path.rateA[s.i];
+
+        Step step{ s, rateA * path.rateB[s.j], 0.0 };
+
+        // Lo que el nivel i entrega en moneda común contra lo que el nivel j acepta
+        const double commonA = capA * rateA;
+        if (commonA < capB) {
+            step.input = capA;
+            s.remB = capB - commonA;
+            ++s.i;
+            s.remA = -1.0;
+        }
+        else if (commonA > capB) {
+            step.input = capB / rateA;
+            s.remA = capA - step.input;
+            ++s.j;
+            s.remB = -1.0;
+        }
+        else {
+            step.input = capA;
+            ++s.i;
+            ++s.j;
+            s.remA = -1.0;
+            s.remB = -1.0;
+        }
+        convertStep(path, step);
+        path.steps.push_back(step);
+    }
+    path.end = s;
+}
+
+void SyntheticBook::convertStep(const Path& path, Step& step) const {
+    if (path.isAsk) {
+        step.px = ceilUnits(_priceUnit / step.rate);
+        step.qty = floorUnits(step.input * step.rate * _qtyUnit);
+    }
+    else {
+        step.px = floorUnits(step.rate * _priceUnit);
+        step.qty = floorUnits(step.input * _qtyUnit);
+    }
+}
+
+void SyntheticBook::rebuildLevels(Path& path, size_t fromStep, std::vector<std::pair<Price, Qty>>& delta) {
+    // Los pasos anteriores a fromStep no cambiaron: se rearma desde el nivel
+    // del último de ellos que se publicaba (los nuevos pueden sumarse a su
+    // precio), o desde el principio si no hay ninguno
+    size_t first = 0;
+    size_t step = 0;
+    for (size_t k = fromStep; k-- > 0;) {
+        const size_t level = path.steps[k].level;
+        if (level != SIZE_MAX) {
+            first = level;
+            step = path.raw[level].firstStep;
+            break;
+        }
+    }
+    const size_t published = first < path.raw.size() ? path.raw[first].publishedBefore : path.levels.size();
+
+    // Pasos -> niveles, agregando los que redondean al mismo precio
+    path.raw.resize(first);
+    for (; step < path.steps.size(); ++step) {
+        Step& st = path.steps[step];
+        st.level = SIZE_MAX;
+        if (st.px <= 0) {
+            continue;
+        }
+        if (!path.raw.empty() && path.raw.back().px == st.px) {
+            path.raw.back().qty += st.qty;
+            st.level = path.raw.size() - 1;
+            continue;
+        }
+        if (path.raw.size() == static_cast<size_t>(_levels)) {
+            break;
+        }
+        path.raw.push_back(RawLevel{ st.px, st.qty, step, 0 });
+        st.level = path.raw.size() - 1;
+    }
+
+    // Lo que se publica desde ahí: los niveles con cantidad
+    std::vector<std::pair<Price, Qty>>& levels = _scratch;
+    levels.clear();
+    for (size_t k = first; k < path.raw.size(); ++k) {
+        RawLevel& raw = path.raw[k];
+        raw.publishedBefore = published + levels.size();
+        if (raw.qty > 0) {
+            levels.emplace_back(raw.px, raw.qty);
+        }
+    }
+
+    // Delta contra lo publicado (los dos del mejor al peor): niveles que ya
+    // no están con cantidad 0, nuevos o con otra cantidad tal cual
+    const auto better = [&path](Price a, Price b) { return path.isAsk ? a < b : a > b; };
+    const auto& old = path.levels;
+    size_t a = published;
+    size_t b = 0;
+    while (a < old.size() || b < levels.size()) {
+        if (b == levels.size() || (a < old.size() && better(old[a].first, levels[b].first))) {
+            delta.emplace_back(old[a].first, 0);
+            ++a;
+        }
+        else if (a == old.size() || better(levels[b].first, old[a].first)) {
+            delta.push_back(levels[b]);
+            ++b;
+        }
+        else {
+            if (old[a].second != levels[b].second) {
+                delta.push_back(levels[b]);
+            }
+            ++a;
+            ++b;
+        }
+    }
+    path.levels.resize(published);
+    path.levels.insert(path.levels.end(), levels.begin(), levels.end());
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "FixedPoint.h"
+#include "BookSide.h"
+#include "OrderBook.h"
+
+// Par de monedas de --cross; el símbolo de Binance es base+quote
+struct CurrencyPair {
+    std::string base;
+    std::string quote;
+
+    std::string symbol() const { return base + quote; }
+};
+
+// Libro implícito de target a través de dos legs que comparten una moneda
+// (ej: eth/usdt a través de eth/btc y btc/usdt)
+struct CrossSpec {
+    CurrencyPair target;
+    CurrencyPair legs[2];
+
+    // Nombre con el que se publica: "ethusdt:ethbtc:btcusdt"
+    std::string name() const;
+};
+
+// "eth/usdt:eth/btc:btc/usdt" -> CrossSpec. Lanza std::runtime_error si no
+// tiene ese formato o si las legs no unen las monedas del target a través
+// de una tercera.
+CrossSpec parseCrossSpec(const std::string& text);
+
+// -----------------------------------------------------------------------------
+// SyntheticBook
+// -----------------------------------------------------------------------------
+// Mantiene un libro implícito (top-N) a partir de dos libros reales, las legs
+// de un triángulo. El libro implícito es un OrderBook común: el Publisher lo
+// publica como a cualquier otro símbolo.
+//
+// Cada lado del implícito es la composición de dos saltos de conversión:
+//   bid  (vender base por quote): base -> moneda común -> quote
+//   ask  (comprar base con quote): quote -> moneda común -> base
+// Un salto usa los bids de la leg si vende su base y los asks (con tasa 1/p)
+// si la compra. Los dos saltos se recorren en orden de mejor tasa, como un
+// merge, consumiendo la cantidad disponible en la moneda común: cada paso
+// del recorrido es un nivel implícito (tasa1 x tasa2, cantidad).
+//
+// Incremental:
+// - refresh() solo trabaja si cambió la versión de alguna leg: lee solo esa
+//   leg y solo recalcula los lados del implícito que usan el lado que cambió.
+// - Las escaleras de tasas se corrigen desde el primer nivel modificado.
+// - Cada paso guarda el estado del recorrido antes de darlo; al cambiar una
+//   leg se retoma desde el primer paso que tocó un nivel modificado, no
+//   desde el principio. Los pasos guardan también su nivel ya convertido a
+//   la escala del target, así los niveles implícitos se rearman solo desde
+//   el que contiene ese paso.
+// - Al libro implícito se le aplica como delta solo lo que cambió, así su
+//   cache de top-N se corrige en el lugar y su versión no sube si el top
+//   quedó igual.
+//
+// Precios del implícito: bids redondeados hacia abajo y asks hacia arriba a
+// la escala del target (nunca mejores que lo ejecutable); cantidades hacia
+// abajo. Las dos legs se leen una después de la otra, no en el mismo instante.
+//
+// No es thread-safe: lo refresca un solo hilo (el del Publisher).
+// -----------------------------------------------------------------------------
+class SyntheticBook {
+public:
+    // legs en el orden de spec.legs; scale: la del target; levels: niveles
+    // por lado del implícito (y de cada leg que se lee)
+    SyntheticBook(const CrossSpec& spec,
+        std::shared_ptr<OrderBook> leg0,
+        std::shared_ptr<OrderBook> leg1,
+        SymbolScale scale,
+        int levels);
+
+    // Recalcula lo afectado por los cambios de las legs desde la última
+    // llamada. true si el libro implícito cambió.
+    bool refresh();
+
+    // El próximo refresh() recalcula todo, como el primero
+    void invalidate() { _first = true; }
+
+    // Alguna leg cambió desde el último refresh() (mismo hilo que refresh)
+    bool stale() const {
+        return _first || _legs[0]->version() != _legVersion[0] || _legs[1]->version() != _legVersion[1];
+    }
+
+    const std::string& name() const { return _name; }
+    const std::shared_ptr<OrderBook>& book() const { return _book; }
+
+private:
+    // Un salto: vender la moneda de entrada por la de salida en una leg
+    struct Hop {
+        int leg = 0;
+        bool inverted = false; // compra la base de la leg (asks, tasa 1/p)
+    };
+
+    // Estado del recorrido antes de un paso (o al terminar)
+    struct WalkState {
+        size_t i = 0;       // nivel del primer salto
+        size_t j = 0;       // nivel del segundo salto
+        double remA = -1.0; // sin consumir del nivel i, en moneda de entrada (< 0 = entero)
+        double remB = -1.0; // sin consumir del nivel j, en moneda común (< 0 = entero)
+    };
+
+    struct Step {
+        WalkState before;
+        double rate;   // moneda de salida por unidad de entrada
+        double input;  // cantidad en moneda de entrada
+        Price px = 0;  // en la escala del target
+        Qty qty = 0;
+        size_t level = SIZE_MAX; // en Path::raw (SIZE_MAX = no se publica)
+    };
+
+    // Pasos consecutivos que redondean al mismo precio
+    struct RawLevel {
+        Price px;
+        Qty qty;               // puede ser 0 (se cuenta en el tope pero no se publica)
+        size_t firstStep;
+        size_t publishedBefore; // niveles publicados antes de este
+    };
+
+    // Un lado del implícito
+    struct Path {
+        bool isAsk = false;
+        Hop first;
+        Hop second;
+        std::vector<double> rateA, capA, rateB, capB; // escaleras de los saltos (un escalón por nivel de la leg)
+        std::vector<Step> steps;
+        WalkState end;
+        std::vector<RawLevel> raw;                 // hasta _levels, del mejor al peor
+        std::vector<std::pair<Price, Qty>> levels; // lo publicado: raw sin cantidad 0
+    };
+
+    // Niveles de la leg que usa el salto (bids o asks)
+    const std::vector<Level>& hopLevels(const Hop& hop) const;
+    size_t hopChanged(const Hop& hop) const;
+
+    // Rehace los escalones desde el nivel from de la leg
+    void updateLadder(const Hop& hop, size_t from, std::vector<double>& rate, std::vector<double>& cap) const;
+    void walk(Path& path, size_t fromStep, size_t changedA, size_t changedB);
+    void convertStep(const Path& path, Step& step) const;
+    // Rearma los niveles desde el que contiene el paso fromStep - 1
+    void rebuildLevels(Path& path, size_t fromStep, std::vector<std::pair<Price, Qty>>& delta);
+
+    std::string _name;
+    std::shared_ptr<OrderBook> _legs[2];
+    std::shared_ptr<OrderBook> _book;
+    int _levels;
+
+    // Escala de cada leg y del target (10^decimales)
+    double _legPriceUnit[2];
+    double _legQtyUnit[2];
+    double _priceUnit;
+    double _qtyUnit;
+
+    // Niveles leídos de cada leg: los de esta pasada y los de la anterior
+    std::vector<Level> _bids[2], _asks[2];
+    std::vector<Level> _prevBids[2], _prevAsks[2];
+    uint64_t _legVersion[2] = { 0, 0 };
+    bool _legRead[2] = { false, false }; // leída en este refresh
+    bool _first = true;
+
+    Path _bidPath;
+    Path _askPath;
+    DepthUpdate _delta{};
+    std::vector<std::pair<Price, Qty>> _scratch; // niveles rearmados de un lado
+};
@@ -2,10 +2,29 @@
 #include <mutex>
 #include "Utils.h"
 #include <algorithm>
-#include <deque>
 
-void TradeStats::onTrade(double price, double qty, const std::string& sideFlag)
+TradeStats::TradeStats(SymbolScale scale, const TradeWindowConfig& windows)
+    : _scale(scale)
+    , _wheel(windows)
 {
+    // parseArgs agrega vwapWindowMs a los horizontes; si no est (config
+    // armada a mano) se publica el ms largo
+    const auto& horizons = _wheel.horizonsMs();
+    auto it = std::find(horizons.begin(), horizons.end(), windows.vwapWindowMs);
+    if (it == horizons.end()) {
+        it = std::max_element(horizons.begin(), horizons.end());
+    }
+    _vwapWindowIdx = it != horizons.end() ? static_cast<size_t>(it - horizons.begin()) : 0;
+}
+
+void TradeStats::onTrade(Price price, Qty qty, const std::string& sideFlag, uint64_t tradeTimeMs)
+{
+    // timestamp del exchange; sin T (fallback JSON viejo) usamos el reloj local
+    const int64_t tsMs = tradeTimeMs > 0
+        ? static_cast<int64_t>(tradeTimeMs)
+        : static_cast<int64_t>(nowUnixSeconds() * 1000.0);
+    const double pxQty = static_cast<double>(price) * static_cast<double>(qty);
+
     std::lock_guard<std::mutex> lock(_mtx);
 
     // ltimo trade
@@ -14,57 +33,52 @@ void TradeStats::onTrade(double price, double qty, const std::string& sideFlag)
     _last.side = sideFlag; // "buy" o "sell"
 
     // vwap sesin (acumulado desde el inicio)
-    _sumPxQty += price * qty;
-    _sumQty += qty;
-
-    // guardar en la ventana
-    double tsNow = nowUnixSeconds();
-    _recent.push_back(TimedTrade{ tsNow, price, qty });
-
-    // recortar trades viejos (ms de 300 segundos atrs)
-    const double WINDOW_SEC = 300.0;
-    double cutoff = tsNow - WINDOW_SEC;
-    while (!_recent.empty() && _recent.front().ts < cutoff) {
-        _recent.pop_front();
+    _sumPxQty += pxQty;
+    _sumQty += static_cast<double>(qty);
+
+    // ventanas por horizonte
+    _wheel.add(tsMs, price, qty, sideFlag == "buy");
+
+    _version.store(_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if (IdleWaiter* waiter = _changeWaiter.load(std::memory_order_acquire)) {
+        waiter->notify();
     }
 }
 
-TradeSnapshot TradeStats::snapshot() const
+TradeSnapshot TradeStats::snapshot(double nowSec)
+{
+    std::vector<HorizonStats> horizons;
+    TradeSnapshot out = snapshotTop(nowSec, horizons);
+    out.horizons.swap(horizons);
+    return out;
+}
+
+TradeSnapshot TradeStats::snapshotTop(double nowSec)
 {
     std::lock_guard<std::mutex> lock(_mtx);
 
     TradeSnapshot out;
     out.last = _last;
+    out.vwapSession = _sumQty > 0.0 ? _sumPxQty / _sumQty : 0.0;
+    out.vwapWindow = _wheel.vwap(static_cast<int64_t>(nowSec * 1000.0), _vwapWindowIdx);
+    return out;
+}
 
-    // VWAP de sesin completa
-    if (_sumQty > 0.0) {
-        out.vwapSession = _sumPxQty / _sumQty;
-    }
-    else {
-        out.vwapSession = 0.0;
-    }
+TradeSnapshot TradeStats::snapshotTop(double nowSec, std::vector<HorizonStats>& horizons)
+{
+    std::lock_guard<std::mutex> lock(_mtx);
 
-    // VWAP ventana mvil (ltimos 5 minutos)
-    const double WINDOW_SEC = 300.0;
-    double now = nowUnixSeconds();
-    double cutoff = now - WINDOW_SEC;
+    TradeSnapshot out;
+    out.last = _last;
 
-    double sumPxQtyWin = 0.0;
-    double sumQtyWin = 0.0;
+    // VWAP de sesin completa
+    out.vwapSession = _sumQty > 0.0 ? _sumPxQty / _sumQty : 0.0;
 
-    for (const auto& t : _recent)
-    {
-        if (t.ts >= cutoff) {
-            sumPxQtyWin += t.price * t.qty;
-            sumQtyWin += t.qty;
-        }
-    }
+    // Horizontes: sumas ya mantenidas por la rueda, O(1) por horizonte
+    _wheel.query(static_cast<int64_t>(nowSec * 1000.0), horizons);
 
-    if (sumQtyWin > 0.0) {
-        out.vwapWindow = sumPxQtyWin / sumQtyWin;
-    }
-    else {
-        out.vwapWindow = 0.0;
+    if (_vwapWindowIdx < horizons.size()) {
+        out.vwapWindow = horizons[_vwapWindowIdx].vwap;
     }
 
     return out;
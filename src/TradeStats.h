@@ -1,7 +1,13 @@
 ﻿#pragma once
+#include <atomic>
 #include <mutex>
 #include <string>
-#include <deque>
+#include <vector>
+#include <cstdint>
+
+#include "FixedPoint.h"
+#include "TradeWindow.h"
+#include "IdleStrategy.h"
 
 // -----------------------------------------------------------------------------
 // Estructuras auxiliares
@@ -9,23 +15,19 @@
 
 // Representa el último trade recibido para un símbolo.
 struct LastTrade {
-    double price = 0.0;       // Último precio ejecutado
-    double qty = 0.0;         // Cantidad del último trade
+    Price price = 0;          // Último precio ejecutado (punto fijo)
+    Qty qty = 0;              // Cantidad del último trade (punto fijo)
     std::string side;         // "buy", "sell", o "" si aún no hubo trades
 };
 
 // Snapshot de métricas de sesión del símbolo.
+// Los VWAP quedan en unidades de precio del símbolo (ticks, con fracción):
+// se convierten a decimal con SymbolScale::priceToDouble al publicar.
 struct TradeSnapshot {
     LastTrade last;           // Último trade conocido
     double vwapSession = 0.0; // VWAP acumulado (Σ p*q / Σ q)
-    double vwapWindow = 0.0;
-};
-
-//para calculo de vwap
-struct TimedTrade {
-    double ts;    // epoch seconds
-    double price;
-    double qty;
+    double vwapWindow = 0.0;  // VWAP del horizonte vwapWindowMs (5m por defecto)
+    std::vector<HorizonStats> horizons; // uno por horizonte configurado, en orden
 };
 
 // -----------------------------------------------------------------------------
@@ -38,27 +40,64 @@ struct TimedTrade {
 // Responsabilidad:
 //   - Guardar el último trade (precio, cantidad y lado agresor).
 //   - Calcular el VWAP de la sesión (ponderado por cantidad).
+//   - Calcular volumen, notional, count, VWAP, split comprador/vendedor y
+//     high/low para cada horizonte configurado (1s, 10s, 1m, 5m, 1h por
+//     defecto) con una rueda de buckets fijos (TradeBucketWheel): memoria
+//     constante sin importar el ritmo de trades.
 //   - Proveer snapshots inmutables de las métricas actuales.
 //
+// Los trades se ubican en el tiempo con el campo T del exchange (ms epoch),
+// no con el reloj local; así el replay de un journal da la misma ventana.
+//
 // Ejemplo:
-//   TradeStats stats;
-//   stats.onTrade("btcusdt", 25000.5, 0.1, false);
-//   auto snap = stats.snapshot();
+//   TradeStats stats(scale);
+//   stats.onTrade(2500050, 10000000, "buy", 1700000000000);   // 25000.50 x 0.1 con escala (2, 8)
+//   auto snap = stats.snapshot(nowUnixSeconds());
 // -----------------------------------------------------------------------------
 class TradeStats {
 public:
-    void onTrade(double price, double qty, const std::string& sideFlag);
-    TradeSnapshot snapshot() const; 
+    explicit TradeStats(SymbolScale scale = {}, const TradeWindowConfig& windows = {});
+
+    // tradeTimeMs: campo T del trade (ms epoch); 0 = usar el reloj local
+    void onTrade(Price price, Qty qty, const std::string& sideFlag, uint64_t tradeTimeMs = 0);
+
+    // nowSec: fin de la ventana (epoch seconds). Avanza la rueda hasta ahí
+    // antes de calcular, por eso no es const.
+    TradeSnapshot snapshot(double nowSec);
+
+    // Último trade y VWAPs, sin las métricas por horizonte (horizons queda
+    // vacío). O(1): se puede llamar en cada trade (memoria compartida).
+    TradeSnapshot snapshotTop(double nowSec);
+
+    // snapshotTop más las métricas por horizonte en horizons, bajo el mismo
+    // lock. Reutiliza la capacidad de horizons (no reserva memoria en
+    // régimen); high/low recorren los buckets del horizonte más largo.
+    TradeSnapshot snapshotTop(double nowSec, std::vector<HorizonStats>& horizons);
+
+    // Escala de precio/cantidad del símbolo (inmutable)
+    const SymbolScale& scale() const { return _scale; }
+
+    // Contador de trades aplicados (ver OrderBook::version)
+    uint64_t version() const { return _version.load(std::memory_order_acquire); }
+
+    // A quién despertar en cada trade (nullptr = nadie)
+    void setChangeWaiter(IdleWaiter* waiter) { _changeWaiter.store(waiter, std::memory_order_release); }
 
 private:
+    SymbolScale _scale;
+
     mutable std::mutex _mtx;
 
     LastTrade _last;
 
-    // sesión completa
+    // sesión completa (Σ p*q en double: el producto de dos int64 no entra en 64 bits)
     double _sumPxQty = 0.0;
     double _sumQty = 0.0;
 
-    // ventana móvil de 5m
-    std::deque<TimedTrade> _recent;
+    // ventanas por horizonte; _vwapWindowIdx apunta al publicado como vwapWindow
+    TradeBucketWheel _wheel;
+    size_t _vwapWindowIdx = 0;
+
+    std::atomic<uint64_t> _version{ 0 };
+    std::atomic<IdleWaiter*> _changeWaiter{ nullptr };
 };
\ No newline at end of file
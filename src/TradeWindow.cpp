@@ -0,0 +1,185 @@
+#include "TradeWindow.h"
+
+#include <algorithm>
+#include <numeric>
+
+TradeBucketWheel::TradeBucketWheel(const TradeWindowConfig& config)
+    : _bucketMs(config.bucketMs)
+    , _horizonsMs(config.horizonsMs)
+{
+    int64_t maxBuckets = 1;
+    _horizons.resize(_horizonsMs.size());
+    for (size_t i = 0; i < _horizonsMs.size(); ++i) {
+        _horizons[i].buckets = std::max<int64_t>(1, _horizonsMs[i] / _bucketMs);
+        maxBuckets = std::max(maxBuckets, _horizons[i].buckets);
+    }
+    _ring.resize(static_cast<size_t>(maxBuckets));
+
+    // Para el barrido de high/low: horizontes de menor a mayor
+    _byLength.resize(_horizons.size());
+    std::iota(_byLength.begin(), _byLength.end(), size_t{ 0 });
+    std::sort(_byLength.begin(), _byLength.end(), [this](size_t a, size_t b) {
+        return _horizons[a].buckets < _horizons[b].buckets;
+    });
+}
+
+void TradeBucketWheel::add(int64_t tradeTimeMs, Price price, Qty qty, bool isBuy)
+{
+    const int64_t id = tradeTimeMs / _bucketMs;
+    if (!_started || id > _endId) {
+        advanceTo(id);
+    }
+
+    // Más viejo que el horizonte más largo: no entra en ninguna ventana
+    if (id <= _endId - static_cast<int64_t>(_ring.size())) {
+        return;
+    }
+
+    const double pxQty = static_cast<double>(price) * static_cast<double>(qty);
+
+    Bucket& b = slot(id);
+    if (b.id != id) {
+        b = Bucket{};
+        b.id = id;
+    }
+    if (b.count == 0 || price > b.high) b.high = price;
+    if (b.count == 0 || price < b.low) b.low = price;
+    if (isBuy) b.buyVolume += qty; else b.sellVolume += qty;
+    b.notional += pxQty;
+    ++b.count;
+
+    for (auto& h : _horizons) {
+        if (id > _endId - h.buckets) {
+            if (isBuy) h.buyVolume += qty; else h.sellVolume += qty;
+            h.notional += pxQty;
+            ++h.count;
+        }
+    }
+}
+
+void TradeBucketWheel::query(int64_t nowMs, std::vector<HorizonStats>& out)
+{
+    advanceTo(nowMs / _bucketMs);
+
+    out.resize(_horizons.size());
+    for (size_t i = 0; i < _horizons.size(); ++i) {
+        const Horizon& h = _horizons[i];
+        HorizonStats& s = out[i];
+        s.horizonMs = _horizonsMs[i];
+        s.buyVolume = h.buyVolume;
+        s.sellVolume = h.sellVolume;
+        s.volume = h.buyVolume + h.sellVolume;
+        s.notional = h.notional;
+        s.count = h.count;
+        s.vwap = s.volume > 0 ? h.notional / static_cast<double>(s.volume) : 0.0;
+        s.high = 0;
+        s.low = 0;
+    }
+
+    // high/low: un solo barrido desde el bucket más nuevo hacia atrás; cada
+    // horizonte toma el extremo acumulado al llegar a su largo
+    Price high = 0;
+    Price low = 0;
+    bool any = false;
+    size_t next = 0;
+    for (int64_t back = 0; back < static_cast<int64_t>(_ring.size()) && next < _byLength.size(); ++back) {
+        const int64_t id = _endId - back;
+        const Bucket& b = slot(id);
+        if (b.id == id && b.count > 0) {
+            if (!any || b.high > high) high = b.high;
+            if (!any || b.low < low) low = b.low;
+            any = true;
+        }
+        while (next < _byLength.size() && _horizons[_byLength[next]].buckets == back + 1) {
+            if (any) {
+                out[_byLength[next]].high = high;
+                out[_byLength[next]].low = low;
+            }
+            ++next;
+        }
+    }
+}
+
+double TradeBucketWheel::vwap(int64_t nowMs, size_t horizonIdx)
+{
+    advanceTo(nowMs / _bucketMs);
+
+    if (horizonIdx >= _horizons.size()) {
+        return 0.0;
+    }
+    const Horizon& h = _horizons[horizonIdx];
+    const Qty volume = h.buyVolume + h.sellVolume;
+    return volume > 0 ? h.notional / static_cast<double>(volume) : 0.0;
+}
+
+void TradeBucketWheel::advanceTo(int64_t endId)
+{
+    if (!_started) {
+        _started = true;
+        _endId = endId;
+        return;
+    }
+    if (endId <= _endId) {
+        return;
+    }
+
+    const int64_t ringSize = static_cast<int64_t>(_ring.size());
+
+    // Salto mayor que la rueda: no sobrevive ningún bucket
+    if (endId - _endId >= ringSize) {
+        for (auto& b : _ring) b = Bucket{};
+        resetHorizons();
+        _endId = endId;
+        return;
+    }
+
+    while (_endId < endId) {
+        const int64_t id = _endId + 1;
+
+        // Restar de cada horizonte el bucket que queda afuera
+        for (auto& h : _horizons) {
+            const int64_t leaving = id - h.buckets;
+            const Bucket& b = slot(leaving);
+            if (b.id == leaving) {
+                h.buyVolume -= b.buyVolume;
+                h.sellVolume -= b.sellVolume;
+                h.notional -= b.notional;
+                h.count -= b.count;
+            }
+        }
+
+        // El slot del bucket nuevo es el que salió del horizonte más largo
+        slot(id) = Bucket{};
+        _endId = id;
+
+        // Acotar el error de redondeo de las restas: una vez por vuelta del
+        // horizonte (O(1) amortizado)
+        for (auto& h : _horizons) {
+            if (++h.evictionsSinceRecompute >= h.buckets) {
+                recomputeNotional(h);
+            }
+        }
+    }
+}
+
+void TradeBucketWheel::resetHorizons()
+{
+    for (auto& h : _horizons) {
+        h.buyVolume = 0;
+        h.sellVolume = 0;
+        h.notional = 0.0;
+        h.count = 0;
+        h.evictionsSinceRecompute = 0;
+    }
+}
+
+void TradeBucketWheel::recomputeNotional(Horizon& h)
+{
+    double notional = 0.0;
+    for (int64_t id = _endId - h.buckets + 1; id <= _endId; ++id) {
+        const Bucket& b = slot(id);
+        if (b.id == id) notional += b.notional;
+    }
+    h.notional = notional;
+    h.evictionsSinceRecompute = 0;
+}
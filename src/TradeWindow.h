@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "FixedPoint.h"
+
+// -----------------------------------------------------------------------------
+// Configuración de las ventanas de trades
+// -----------------------------------------------------------------------------
+struct TradeWindowConfig {
+    int64_t bucketMs = 1000; // resolución de la rueda (--bucket-ms=1000 o 100)
+    std::vector<int64_t> horizonsMs = { 1'000, 10'000, 60'000, 300'000, 3'600'000 }; // --horizons=1s,10s,1m,5m,1h
+    int64_t vwapWindowMs = 300'000; // horizonte publicado como vwapWindow (--vwap-window=5m)
+};
+
+// Métricas de un horizonte. Precios en ticks y cantidades en lotes del símbolo.
+struct HorizonStats {
+    int64_t horizonMs = 0;
+    double vwap = 0.0;       // notional / volume (ticks, con fracción)
+    Qty volume = 0;
+    Qty buyVolume = 0;       // agresor comprador
+    Qty sellVolume = 0;      // agresor vendedor
+    double notional = 0.0;   // suma de p*q (ticks * lotes)
+    uint64_t count = 0;
+    Price high = 0;          // 0 si no hubo trades en el horizonte
+    Price low = 0;
+};
+
+// -----------------------------------------------------------------------------
+// TradeBucketWheel
+// -----------------------------------------------------------------------------
+// Rueda de tiempo con buckets fijos de bucketMs (por defecto 1 s). Cada bucket
+// guarda volumen comprador/vendedor, notional, cantidad de trades, máximo y
+// mínimo. La rueda cubre el horizonte más largo; los más cortos son sufijos
+// de la misma rueda.
+//
+// Por horizonte se mantienen sumas corridas (volumen, notional, count): al
+// entrar un trade se suma a los horizontes que lo contienen y, cuando el fin
+// de la ventana avanza, se restan los buckets que salen de cada uno. VWAP,
+// volumen y count se responden en O(1); high/low recorren los buckets del
+// horizonte más largo una vez por query (acotado por la configuración, no
+// por la actividad del mercado).
+//
+// La memoria es fija (un bucket por slot) sin importar cuántos trades
+// lleguen: reemplaza al deque de trades crudos, que crecía con la actividad.
+//
+// El fin de la ventana es el bucket más nuevo visto, sea por un trade (T del
+// exchange) o por una query (reloj local); nunca retrocede. Un trade atrasado
+// que todavía cae dentro de la rueda se suma a su bucket y a los horizontes
+// que lo cubren; si ya salió de todos, se ignora.
+//
+// No es thread-safe: TradeStats lo protege con su mutex.
+// -----------------------------------------------------------------------------
+class TradeBucketWheel {
+public:
+    // config ya validada (ver parseArgs): horizontes > 0, múltiplos de bucketMs
+    explicit TradeBucketWheel(const TradeWindowConfig& config);
+
+    void add(int64_t tradeTimeMs, Price price, Qty qty, bool isBuy);
+
+    // Avanza la ventana hasta nowMs y devuelve un HorizonStats por horizonte,
+    // en el orden de la configuración
+    void query(int64_t nowMs, std::vector<HorizonStats>& out);
+
+    // Solo el VWAP de un horizonte (sin high/low): O(1) amortizado
+    double vwap(int64_t nowMs, size_t horizonIdx);
+
+    const std::vector<int64_t>& horizonsMs() const { return _horizonsMs; }
+
+private:
+    struct Bucket {
+        int64_t id = -1;     // número absoluto de bucket (tMs / bucketMs); -1 = vacío
+        Qty buyVolume = 0;
+        Qty sellVolume = 0;
+        double notional = 0.0;
+        uint64_t count = 0;
+        Price high = 0;
+        Price low = 0;
+    };
+
+    struct Horizon {
+        int64_t buckets = 0; // largo en buckets
+        Qty buyVolume = 0;
+        Qty sellVolume = 0;
+        double notional = 0.0;
+        uint64_t count = 0;
+        int64_t evictionsSinceRecompute = 0;
+    };
+
+    void advanceTo(int64_t endId);
+    void resetHorizons();
+    void recomputeNotional(Horizon& h);
+    Bucket& slot(int64_t id) {
+        const int64_t n = static_cast<int64_t>(_ring.size());
+        return _ring[static_cast<size_t>(((id % n) + n) % n)];
+    }
+
+    int64_t _bucketMs;
+    std::vector<int64_t> _horizonsMs;
+    std::vector<Horizon> _horizons;
+    std::vector<size_t> _byLength; // índices de _horizons ordenados por largo
+    std::vector<Bucket> _ring;  // un slot por bucket del horizonte más largo
+
+    bool _started = false;
+    int64_t _endId = 0;          // bucket más nuevo de la ventana
+};
@@ -7,6 +7,7 @@
 #include <thread>
 #include <chrono>
 #include <cctype>
+#include <algorithm>
 
 #include "Args.h"
 #include "OrderBook.h"
@@ -15,15 +16,62 @@
 #include "BinanceRestClient.h"
 #include "BinanceTradeStream.h"
 #include "BookSyncWorker.h"
+#include "BookSyncPool.h"
+#include "SymbolScales.h"
+#include "BinanceStreamMux.h"
+#include "Journal.h"
+#include "JournalReplay.h"
+#include "ShmBookWriter.h"
+#include "LatencyStats.h"
+#include "SyntheticBook.h"
 
 static std::atomic<bool> g_running(true);
 
 void signalHandler(int) {
     g_running = false;
+}
+
+// SIGUSR1: volcar los histogramas de latencia en el próximo ciclo del loop
+static std::atomic<bool> g_dumpLatency(false);
+
+void latencyDumpHandler(int) {
+    g_dumpLatency = true;
 }int main(int argc, char** argv) {
     try {
         // Parsear argumentos de línea de comando
         ProgramArgs programArgs = parseArgs(argc, argv);
+        std::cerr << "[Main] Motor de libro: " << bookEngineName(programArgs.bookEngine) << "\n";
+
+        // Journal de captura (--record): se declara antes que los streams
+        // para que se destruya (y vacíe a disco) después de ellos
+        std::unique_ptr<JournalWriter> journal;
+        if (!programArgs.recordPath.empty()) {
+            journal = std::make_unique<JournalWriter>(programArgs.recordPath);
+            std::cerr << "[Main] Grabando journal en " << programArgs.recordPath << "\n";
+        }
+
+        // Memoria compartida (--shm): también antes que los streams, que
+        // escriben en ella hasta que se detienen
+        std::unique_ptr<ShmBookWriter> shmBooks;
+        if (!programArgs.shmName.empty()) {
+            shmBooks = std::make_unique<ShmBookWriter>(programArgs.shmName,
+                static_cast<uint32_t>(programArgs.symbols.size()), programArgs.topN);
+            std::cerr << "[Main] Publicando libros en memoria compartida " << programArgs.shmName << "\n";
+        }
+
+        // Histogramas de latencia (--latency): antes que los streams, que
+        // registran en ellos hasta que se detienen
+        std::unique_ptr<LatencyMonitor> latency;
+        if (programArgs.latency) {
+            latency = std::make_unique<LatencyMonitor>();
+        }
+
+        // Replay (--replay): los frames y snapshots salen del journal, sin red
+        std::unique_ptr<JournalReplay> replay;
+        if (!programArgs.replayPath.empty()) {
+            replay = std::make_unique<JournalReplay>(programArgs.replayPath, programArgs.replaySpeed);
+            std::cerr << "[Main] Reproduciendo journal " << programArgs.replayPath << "\n";
+        }
 
         // Diccionarios principales: libros y estadísticas por símbolo
         std::unordered_map<std::string, std::shared_ptr<OrderBook>> orderBooks;
@@ -33,8 +81,35 @@ void signalHandler(int) {
         std::vector<std::unique_ptr<BookSyncWorker>> orderBookWorkers;
         std::vector<std::unique_ptr<BinanceTradeStream>> tradeStreamWorkers;
 
-        // Cliente REST de Binance (para snapshots y resync)
-        BinanceRestClient binanceRestClient;
+        // Cliente REST de Binance (para snapshots y resync), con una sesión
+        // keep-alive por cada símbolo que arranca en paralelo
+        BinanceRestClient binanceRestClient(programArgs.restBaseUrl, programArgs.startupParallel);
+        binanceRestClient.recordTo(journal.get());
+
+        // En replay los snapshots también salen del journal
+        SnapshotSource* snapshotSource = replay
+            ? static_cast<SnapshotSource*>(replay.get())
+            : &binanceRestClient;
+
+        // Multiplexor de combined streams (--mux=N): pocas conexiones para
+        // todos los streams en lugar de dos WebSockets por símbolo
+        std::unique_ptr<BinanceStreamMux> streamMux;
+        if (programArgs.streamsPerSocket > 0 && !replay) {
+            streamMux = std::make_unique<BinanceStreamMux>(
+                static_cast<size_t>(programArgs.streamsPerSocket),
+                programArgs.wsBaseUrl);
+        }
+
+        // Escalas de precio/cantidad por símbolo (tickSize / stepSize)
+        std::unordered_map<std::string, SymbolScale> symbolScales;
+        if (!programArgs.scalesPath.empty()) {
+            symbolScales = loadSymbolScales(programArgs.scalesPath);
+        }
+
+        // Niveles por lado que lee el Publisher: topN, o los de --analytics
+        const int publishedLevels = programArgs.analytics.bandsBps.empty()
+            ? programArgs.topN
+            : std::max(programArgs.topN, programArgs.analytics.levels);
 
         // Inicializar infraestructura por cada símbolo solicitado
         for (auto& symbol : programArgs.symbols) {
@@ -44,9 +119,18 @@ void signalHandler(int) {
             for (char c : symbol)
                 normalizedSymbol.push_back(std::tolower(static_cast<unsigned char>(c)));
 
+            // Escala del símbolo: la del archivo si existe, si no 8 decimales
+            SymbolScale scale;
+            auto scaleIt = symbolScales.find(normalizedSymbol);
+            if (scaleIt != symbolScales.end()) {
+                scale = scaleIt->second;
+            }
+
             // Crear estructuras compartidas
-            auto orderBookPtr = std::make_shared<OrderBook>(normalizedSymbol);
-            auto tradeStatsPtr = std::make_shared<TradeStats>();
+            auto orderBookPtr = std::make_shared<OrderBook>(normalizedSymbol, scale, programArgs.bookEngine);
+            orderBookPtr->setTopN(publishedLevels); // lo que leen Publisher y memoria compartida
+            orderBookPtr->setSweepDepth(programArgs.sweepDepth); // aparte del top-N publicado
+            auto tradeStatsPtr = std::make_shared<TradeStats>(scale, programArgs.tradeWindows);
 
             orderBooks[normalizedSymbol] = orderBookPtr;
             tradeStatsBySymbol[normalizedSymbol] = tradeStatsPtr;
@@ -55,42 +139,200 @@ void signalHandler(int) {
             auto orderBookWorker = std::make_unique<BookSyncWorker>(
                 normalizedSymbol,
                 orderBookPtr,
-                &binanceRestClient
+                snapshotSource,
+                programArgs.idleStrategy,
+                streamMux.get(),
+                programArgs.wsBaseUrl
             );
-            orderBookWorker->start();
-            orderBookWorkers.push_back(std::move(orderBookWorker));
 
             // Escuchar el stream de trades en tiempo real (para VWAP, último trade, etc.)
             auto tradeStreamWorker = std::make_unique<BinanceTradeStream>(
                 normalizedSymbol,
-                tradeStatsPtr
+                tradeStatsPtr,
+                programArgs.wsBaseUrl
             );
-            tradeStreamWorker->start();
+            if (streamMux) {
+                tradeStreamWorker->attach(*streamMux);
+            }
+
+            orderBookWorker->setDepth(programArgs.depth);
+            if (!programArgs.checkpointDir.empty()) {
+                orderBookWorker->checkpointTo(programArgs.checkpointDir, programArgs.checkpointIntervalMs);
+            }
+
+            if (journal) {
+                orderBookWorker->recordTo(journal.get());
+                tradeStreamWorker->recordTo(journal.get());
+            }
+            if (shmBooks) {
+                const uint32_t slot = shmBooks->addSymbol(normalizedSymbol, scale);
+                orderBookWorker->publishTo(shmBooks.get(), slot);
+                tradeStreamWorker->publishTo(shmBooks.get(), slot);
+            }
+            if (latency) {
+                orderBookWorker->measureTo(latency->addSymbol(normalizedSymbol));
+            }
+            if (replay) {
+                replay->addSymbol(normalizedSymbol, orderBookWorker.get(), tradeStreamWorker.get());
+            }
+
+            orderBookWorkers.push_back(std::move(orderBookWorker));
             tradeStreamWorkers.push_back(std::move(tradeStreamWorker));
         }
 
+        // Libros implícitos (--cross): se arman sobre los libros reales de sus
+        // legs y se publican junto a ellos
+        std::vector<std::shared_ptr<SyntheticBook>> crossBooks;
+        for (const auto& spec : programArgs.crossBooks) {
+            std::shared_ptr<OrderBook> legs[2];
+            for (int l = 0; l < 2; ++l) {
+                auto legIt = orderBooks.find(spec.legs[l].symbol());
+                if (legIt == orderBooks.end()) {
+                    throw std::runtime_error("--cross " + spec.name() + ": falta "
+                        + spec.legs[l].symbol() + " en --symbols");
+                }
+                legs[l] = legIt->second;
+            }
+            for (const auto& other : crossBooks) {
+                if (other->name() == spec.name()) {
+                    throw std::runtime_error("--cross repetido: " + spec.name());
+                }
+            }
+
+            SymbolScale scale;
+            auto scaleIt = symbolScales.find(spec.target.symbol());
+            if (scaleIt != symbolScales.end()) {
+                scale = scaleIt->second;
+            }
+            crossBooks.push_back(std::make_shared<SyntheticBook>(spec, legs[0], legs[1], scale, publishedLevels));
+        }
+
+        // Replay: todo corre en este hilo y el Publisher sigue el reloj grabado
+        if (replay) {
+            for (auto& worker : orderBookWorkers)
+                worker->startReplay();
+
+            Publisher publisher(orderBooks, tradeStatsBySymbol, programArgs.topN, programArgs.logPath,
+                programArgs.outputFormat, programArgs.logWriter, programArgs.publish, crossBooks);
+            publisher.measureTo(latency.get());
+            publisher.analyzeDepth(programArgs.analytics);
+            if (programArgs.horizonStats) publisher.publishHorizons(programArgs.tradeWindows.horizonsMs);
+            publisher.start(/*periodic*/ false);
+
+            std::signal(SIGINT, signalHandler);
+            std::signal(SIGTERM, signalHandler);
+#ifdef SIGUSR1
+            std::signal(SIGUSR1, latencyDumpHandler);
+#endif
+
+            replay->run(g_running, [&](double ts) {
+                publisher.publishTick(ts);
+                if (latency && g_dumpLatency.exchange(false)) {
+                    latency->report(std::cerr);
+                }
+            });
+
+            publisher.stop();
+            for (auto& worker : orderBookWorkers)
+                worker->stop();
+
+            if (latency) {
+                latency->report(std::cerr, /*cumulative*/ true);
+            }
+
+            std::cerr << "Replay terminado.\n";
+            return 0;
+        }
+
+        // Con multiplexor, abrimos las conexiones compartidas antes de pedir
+        // los snapshots para que los depth updates ya se estén bufferizando
+        if (streamMux) {
+            streamMux->start();
+            std::cerr << "[Main] " << orderBookWorkers.size() * 2 << " streams en "
+                << streamMux->connectionCount() << " conexiones\n";
+        }
+
+        // Arrancar workers (WS depth + snapshot REST) y streams de trades.
+        // Los libros los mantienen los shards del pool, no un hilo por símbolo:
+        // cada símbolo entra al pool apenas tiene su snapshot. Los snapshots
+        // se piden de a --startup-parallel a la vez.
+        const auto startupBegin = std::chrono::steady_clock::now();
+        BookSyncPool syncPool(programArgs.syncPool, orderBookWorkers.size());
+        syncPool.start();
+        std::cerr << "[Main] " << orderBookWorkers.size() << " libros en "
+            << syncPool.shardCount() << " hilos de sync\n";
+
+        syncPool.addAll(orderBookWorkers, programArgs.startupParallel);
+        auto msSince = [](std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - t).count();
+        };
+        std::cerr << "[Main] Snapshots iniciales en " << msSince(startupBegin) << " ms ("
+            << programArgs.startupParallel << " en paralelo)\n";
+
+        for (auto& tradeStream : tradeStreamWorkers)
+            tradeStream->start();
+
         // Publisher: genera el CSV o salida de datos
-        Publisher publisher(orderBooks, tradeStatsBySymbol, programArgs.topN, programArgs.logPath);
+        Publisher publisher(orderBooks, tradeStatsBySymbol, programArgs.topN, programArgs.logPath,
+            programArgs.outputFormat, programArgs.logWriter, programArgs.publish, crossBooks);
+        publisher.measureTo(latency.get());
+        publisher.analyzeDepth(programArgs.analytics);
+        if (programArgs.horizonStats) publisher.publishHorizons(programArgs.tradeWindows.horizonsMs);
         publisher.start();
 
         // Manejar señales de cierre (Ctrl+C o kill)
         std::signal(SIGINT, signalHandler);
         std::signal(SIGTERM, signalHandler);
+#ifdef SIGUSR1
+        std::signal(SIGUSR1, latencyDumpHandler);
+#endif
 
         // Loop principal: mantener el proceso vivo hasta señal de salida
+        // (y volcar la latencia cada --latency=<intervalo> o con SIGUSR1)
+        auto lastLatencyReport = std::chrono::steady_clock::now();
+        bool allSynchronized = false;
         while (g_running) {
             std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            // Punto "listo": todos los libros enganchados por primera vez
+            if (!allSynchronized) {
+                allSynchronized = std::all_of(orderBookWorkers.begin(), orderBookWorkers.end(),
+                    [](const auto& worker) { return worker->isSynchronized(); });
+                if (allSynchronized) {
+                    std::cerr << "[Main] Listo: " << orderBookWorkers.size()
+                        << " libros sincronizados en " << msSince(startupBegin) << " ms\n";
+                }
+            }
+
+            if (latency) {
+                const auto now = std::chrono::steady_clock::now();
+                const bool due = programArgs.latencyReportMs > 0 &&
+                    now - lastLatencyReport >= std::chrono::milliseconds(programArgs.latencyReportMs);
+                if (g_dumpLatency.exchange(false) || due) {
+                    latency->report(std::cerr);
+                    lastLatencyReport = now;
+                }
+            }
         }
 
         // Detener hilos y liberar recursos ordenadamente
         publisher.stop();
 
+        if (streamMux)
+            streamMux->stop();
+
         for (auto& tradeStream : tradeStreamWorkers)
             tradeStream->stop();
 
+        syncPool.stop();
         for (auto& worker : orderBookWorkers)
             worker->stop();
 
+        if (latency) {
+            latency->report(std::cerr, /*cumulative*/ true);
+        }
+
         std::cerr << "Apagado limpio.\n";
         return 0;
     }
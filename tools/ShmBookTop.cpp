@@ -0,0 +1,92 @@
+// -----------------------------------------------------------------------------
+// ShmBookTop
+// -----------------------------------------------------------------------------
+// Ejemplo de consumidor del segmento compartido (BinanceOrderBook --shm=...):
+// imprime best bid/ask, último trade y VWAPs de cada símbolo, sin syscalls
+// por lectura (solo ShmBook.h).
+//
+// Uso:
+//   ShmBookTop /binance_ob              -> una vez
+//   ShmBookTop /binance_ob 500          -> cada 500 ms hasta Ctrl+C
+// -----------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "ShmBook.h"
+
+namespace {
+
+std::atomic<bool> g_running(true);
+
+void signalHandler(int) {
+    g_running = false;
+}
+
+double pow10d(int exp) {
+    double v = 1.0;
+    for (int i = 0; i < exp; ++i) v *= 10.0;
+    return v;
+}
+
+void printOnce(const shmbook::ShmBookReader& reader) {
+    shmbook::BookView book;
+    shmbook::Trade trade{};
+
+    for (uint32_t i = 0; i < reader.slotCount(); ++i) {
+        const shmbook::SlotHead* slot = reader.slot(i);
+        if (slot->symbol[0] == '\0') continue;
+
+        const double pxDiv = pow10d(slot->priceDecimals);
+        const double qtyDiv = pow10d(slot->qtyDecimals);
+
+        std::cout << std::left << std::setw(12) << slot->symbol << std::right;
+        if (reader.readBook(i, book)) {
+            std::cout << " bid " << book.top.bestBidPx / pxDiv << " x " << book.top.bestBidQty / qtyDiv
+                << "  ask " << book.top.bestAskPx / pxDiv << " x " << book.top.bestAskQty / qtyDiv
+                << "  u=" << book.top.lastUpdateId << (book.top.synced ? "" : " (sin sync)");
+        }
+        if (reader.readTrade(i, trade) && trade.lastSide != 0) {
+            std::cout << "  last " << trade.lastPx / pxDiv << " " << (trade.lastSide == 1 ? "buy" : "sell")
+                << "  vwap " << trade.vwapWindow / pxDiv << " / " << trade.vwapSession / pxDiv;
+        }
+        std::cout << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: ShmBookTop /nombre [intervalo_ms]\n";
+        return 2;
+    }
+
+    try {
+        shmbook::ShmBookReader reader(argv[1]);
+        const int intervalMs = argc > 2 ? std::atoi(argv[2]) : 0;
+
+        std::cout << std::fixed << std::setprecision(6);
+        if (intervalMs <= 0) {
+            printOnce(reader);
+            return 0;
+        }
+
+        std::signal(SIGINT, signalHandler);
+        std::signal(SIGTERM, signalHandler);
+        while (g_running) {
+            printOnce(reader);
+            std::cout << "\n";
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+        return 0;
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "FATAL: " << ex.what() << "\n";
+        return 1;
+    }
+}
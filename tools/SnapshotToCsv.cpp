@@ -0,0 +1,103 @@
+// -----------------------------------------------------------------------------
+// SnapshotToCsv
+// -----------------------------------------------------------------------------
+// Convierte un archivo de snapshots binario (BinanceOrderBook --format=binary)
+// al CSV que publica el modo texto, línea por línea.
+//
+// Uso:
+//   SnapshotToCsv snapshots.bin              -> CSV por stdout
+//   SnapshotToCsv snapshots.bin salida.csv
+//   SnapshotToCsv --info snapshots.bin       -> cabecera (topN, símbolos, escalas, bandas)
+//
+// Formato del archivo en src/SnapshotRecord.h.
+// -----------------------------------------------------------------------------
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "SnapshotRecord.h"
+
+namespace {
+
+void printInfo(const SnapshotRecordReader& reader) {
+    std::cout << "topN=" << reader.topN() << " recordSize=" << reader.recordSize()
+        << " symbols=" << reader.symbols().size() << "\n";
+    if (!reader.bands().empty()) {
+        std::cout << "analytics bands(bps)=";
+        for (size_t i = 0; i < reader.bands().size(); ++i) {
+            std::cout << (i ? "," : "") << reader.bands()[i];
+        }
+        std::cout << "\n";
+    }
+    if (!reader.horizonsMs().empty()) {
+        std::cout << "trade horizons(ms)=";
+        for (size_t i = 0; i < reader.horizonsMs().size(); ++i) {
+            std::cout << (i ? "," : "") << reader.horizonsMs()[i];
+        }
+        std::cout << "\n";
+    }
+    for (size_t i = 0; i < reader.symbols().size(); ++i) {
+        const SnapshotSymbol& s = reader.symbols()[i];
+        std::cout << "  " << i << " " << s.name
+            << " priceDecimals=" << s.scale.priceDecimals
+            << " qtyDecimals=" << s.scale.qtyDecimals
+            << " tickSize=" << s.scale.tickSize << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        bool info = false;
+        int first = 1;
+        if (argc > 1 && std::strcmp(argv[1], "--info") == 0) {
+            info = true;
+            first = 2;
+        }
+        if (argc - first < 1 || argc - first > 2) {
+            std::cerr << "Uso: SnapshotToCsv [--info] snapshots.bin [salida.csv]\n";
+            return 2;
+        }
+
+        SnapshotRecordReader reader(argv[first]);
+        if (info) {
+            printInfo(reader);
+            return 0;
+        }
+
+        std::ofstream file;
+        if (argc - first == 2) {
+            file.open(argv[first + 1], std::ios::out | std::ios::trunc);
+            if (!file) {
+                std::cerr << "No se pudo crear " << argv[first + 1] << "\n";
+                return 1;
+            }
+        }
+        std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+        const auto& symbols = reader.symbols();
+        SnapshotRow row;
+        std::string line;
+        uint64_t count = 0;
+        while (reader.next(row)) {
+            if (row.symbolId >= symbols.size()) {
+                std::cerr << "[WARN] symbolId fuera de la tabla: " << row.symbolId << "\n";
+                continue;
+            }
+            line.clear();
+            appendCsvLine(line, symbols[row.symbolId], row);
+            line.push_back('\n');
+            out.write(line.data(), static_cast<std::streamsize>(line.size()));
+            ++count;
+        }
+
+        std::cerr << count << " registros convertidos\n";
+        return 0;
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "FATAL: " << ex.what() << "\n";
+        return 1;
+    }
+}